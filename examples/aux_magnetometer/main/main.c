@@ -0,0 +1,247 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file main.c
+ * @brief BMI270 AUX Magnetometer (BMM150) Example
+ *
+ * This example demonstrates:
+ * - BMM150 on the BMI270 AUX I2C pins, read by the BMI270 itself (100Hz)
+ * - Magnetometer frames interleaved with ACC+GYR (1600Hz) in the FIFO
+ * - One FIFO drain delivering all three sensors on a shared time base
+ *
+ * Requires a board with the BMM150 wired to the BMI270 AUX pins
+ * (M5StampFly connects its BMM150 to the host I2C bus instead).
+ */
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_interrupt.h"
+#include "bmi270_fifo_stream.h"
+#include "bmi270_aux.h"
+
+static const char *TAG = "BMI270_AUX_MAG";
+
+// BMI270 pin configuration (M5StampFly layout)
+#define BMI270_MOSI_PIN     14
+#define BMI270_MISO_PIN     43
+#define BMI270_SCLK_PIN     44
+#define BMI270_CS_PIN       46
+#define BMI270_INT1_PIN     11        // INT1 interrupt pin
+#define BMI270_SPI_CLOCK_HZ 10000000  // 10 MHz
+#define PMW3901_CS_PIN      12        // Other device on shared SPI bus
+
+// Watermark: 32 ACC+GYR frames (20ms @ 1600Hz); ~2 of them also carry a mag sample
+#define FIFO_WATERMARK_BYTES 416
+
+// Global device handle, FIFO stream and BMM150 trim
+static bmi270_dev_t g_dev = {0};
+static bmi270_fifo_stream_t g_stream;
+static bmi270_bmm150_trim_t g_trim;
+
+static SemaphoreHandle_t fifo_semaphore = NULL;
+
+/**
+ * @brief INT1 interrupt handler
+ */
+static void IRAM_ATTR bmi270_int1_isr_handler(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    bmi270_fifo_stream_notify_from_isr(&g_stream);
+    xSemaphoreGiveFromISR(fifo_semaphore, &xHigherPriorityTaskWoken);
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief Configure GPIO for INT1 interrupt
+ */
+static esp_err_t configure_int1_gpio(void)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << BMI270_INT1_PIN),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_POSEDGE  // Rising edge (INT1 is active high)
+    };
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+
+    return gpio_isr_handler_add(BMI270_INT1_PIN, bmi270_int1_isr_handler, NULL);
+}
+
+/**
+ * @brief FIFO batch callback: print each mag sample with the ACC+GYR sample of the same frame
+ */
+static void on_fifo_batch(const bmi270_fifo_batch_t *batch, void *user_ctx)
+{
+    for (int i = 0; i < batch->aux_count; i++) {
+        const bmi270_fifo_aux_sample_t *aux = &batch->aux_samples[i];
+
+        bmi270_mag_t mag;
+        bmi270_bmm150_compensate(&g_trim, aux->data, &mag);
+
+        printf(">mag_x:%.2f\n", mag.x);
+        printf(">mag_y:%.2f\n", mag.y);
+        printf(">mag_z:%.2f\n", mag.z);
+
+        if (aux->sample_index < batch->sample_count) {
+            bmi270_gyro_t gyro;
+            bmi270_convert_gyro_raw(&g_dev, &batch->samples[aux->sample_index].gyr, &gyro);
+            printf(">gyr_z:%.3f\n", gyro.z);
+        }
+    }
+}
+
+/**
+ * @brief FIFO read task (triggered by interrupt)
+ */
+static void fifo_read_task(void *arg)
+{
+    while (1) {
+        if (xSemaphoreTake(fifo_semaphore, portMAX_DELAY) == pdTRUE) {
+            if (bmi270_fifo_stream_drain(&g_stream) != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to drain FIFO");
+            }
+        }
+    }
+}
+
+void app_main(void)
+{
+    esp_err_t ret;
+
+    ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, " BMI270 AUX Magnetometer (BMM150)");
+    ESP_LOGI(TAG, "========================================");
+
+    // Step 1: Initialize SPI bus and BMI270
+    ESP_LOGI(TAG, "Step 1: Initializing BMI270...");
+    bmi270_config_t config = {
+        .gpio_mosi = BMI270_MOSI_PIN,
+        .gpio_miso = BMI270_MISO_PIN,
+        .gpio_sclk = BMI270_SCLK_PIN,
+        .gpio_cs = BMI270_CS_PIN,
+        .spi_clock_hz = BMI270_SPI_CLOCK_HZ,
+        .spi_host = SPI2_HOST,
+        .gpio_other_cs = PMW3901_CS_PIN
+    };
+
+    ret = bmi270_spi_init(&g_dev, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SPI");
+        return;
+    }
+
+    ret = bmi270_init(&g_dev);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize BMI270");
+        return;
+    }
+
+    bmi270_set_accel_config(&g_dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    bmi270_set_gyro_config(&g_dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+
+    // Step 2: BMM150 on AUX (manual setup, then BMI270 reads it at 100Hz)
+    ESP_LOGI(TAG, "Step 2: Initializing BMM150 on AUX...");
+    ret = bmi270_bmm150_init(&g_dev, BMI270_ACC_ODR_100HZ, &g_trim);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        ESP_LOGE(TAG, "No BMM150 on the AUX pins (check board wiring)");
+        return;
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize BMM150");
+        return;
+    }
+
+    // Step 3: INT1 pin and GPIO interrupt
+    ESP_LOGI(TAG, "Step 3: Configuring INT1...");
+    bmi270_int_pin_config_t int_config = {
+        .output_enable = true,
+        .active_high = true,
+        .open_drain = false,
+    };
+    ret = bmi270_configure_int_pin(&g_dev, BMI270_INT_PIN_1, &int_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure INT1 pin");
+        return;
+    }
+
+    fifo_semaphore = xSemaphoreCreateBinary();
+    if (fifo_semaphore == NULL) {
+        ESP_LOGE(TAG, "Failed to create semaphore");
+        return;
+    }
+
+    ret = configure_int1_gpio();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure INT1 GPIO");
+        return;
+    }
+
+    // Step 4: FIFO stream with ACC+GYR+AUX
+    ESP_LOGI(TAG, "Step 4: Starting FIFO stream (ACC+GYR+AUX)...");
+    bmi270_fifo_stream_config_t stream_config = {
+        .watermark = FIFO_WATERMARK_BYTES,
+        .int_pin = BMI270_INT_PIN_1,
+        .aux_enable = true,
+        .callback = on_fifo_batch,
+        .user_ctx = NULL,
+    };
+    ret = bmi270_fifo_stream_init(&g_stream, &g_dev, &stream_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start FIFO stream");
+        return;
+    }
+
+    xTaskCreate(fifo_read_task, "fifo_read", 4096, NULL, 5, NULL);
+
+    // Periodic statistics
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(10000));
+
+        bmi270_fifo_stats_t stats;
+        if (bmi270_fifo_stream_get_stats(&g_stream, &stats) == ESP_OK) {
+            ESP_LOGI(TAG, "Frames=%lu, AUX frames=%lu, Lost=%lu",
+                     stats.sensor_frames, stats.aux_frames, stats.lost_frames);
+        }
+    }
+}
@@ -30,7 +30,9 @@
  * - FIFO watermark configuration (416 bytes = 32 frames for 50Hz output)
  * - Interrupt-driven FIFO read using INT1 (GPIO11)
  * - Efficient data acquisition without polling (1600Hz ODR)
- * - Averaged sensor data output
+ * - Integer boxcar decimation to 50Hz output (bmi270_decimator)
+ * - Per-window min/max envelope so spikes stay visible in Teleplot (bmi270_envelope)
+ * - FIFO stream statistics (frame counts, drain latency histogram)
  */
 
 #include <stdio.h>
@@ -43,6 +45,10 @@
 #include "bmi270_spi.h"
 #include "bmi270_init.h"
 #include "bmi270_data.h"
+#include "bmi270_interrupt.h"
+#include "bmi270_fifo_stream.h"
+#include "bmi270_decimator.h"
+#include "bmi270_envelope.h"
 
 static const char *TAG = "BMI270_BASIC_FIFO";
 
@@ -55,38 +61,26 @@ static const char *TAG = "BMI270_BASIC_FIFO";
 #define BMI270_SPI_CLOCK_HZ 10000000  // 10 MHz
 #define PMW3901_CS_PIN      12        // Other device on shared SPI bus
 
-// FIFO registers
-#define BMI270_REG_FIFO_LENGTH_0    0x24    // FIFO length LSB
-#define BMI270_REG_FIFO_LENGTH_1    0x25    // FIFO length MSB
-#define BMI270_REG_FIFO_DATA        0x26    // FIFO data read
-#define BMI270_REG_FIFO_WTM_0       0x46    // FIFO watermark LSB
-#define BMI270_REG_FIFO_WTM_1       0x47    // FIFO watermark MSB
-#define BMI270_REG_FIFO_CONFIG_0    0x48    // FIFO mode config
-#define BMI270_REG_FIFO_CONFIG_1    0x49    // FIFO sensor enable
-#define BMI270_REG_INT1_IO_CTRL     0x53    // INT1 pin config
-#define BMI270_REG_INT_MAP_DATA     0x58    // Interrupt mapping
-#define BMI270_REG_CMD              0x7E    // Command register
-
 // FIFO constants
-#define FIFO_FRAME_SIZE_HEADER      13      // Header(1) + GYR(6) + ACC(6)
-#define FIFO_HEADER_ACC_GYR         0x8C    // Expected header for ACC+GYR frame
-#define FIFO_HEADER_SKIP            0x40    // Skip frame (data loss)
-#define FIFO_HEADER_CONFIG          0x48    // Config change frame
-#define FIFO_MAX_SIZE               2048    // Maximum FIFO size
 #define FIFO_WATERMARK_BYTES        416     // Watermark: 32 frames = 416 bytes (50Hz output @ 1600Hz ODR)
 
-// FIFO commands
-#define BMI270_CMD_FIFO_FLUSH       0xB0    // FIFO flush command
+// Decimation (1600Hz -> 50Hz boxcar average; order 2-3 = CIC with optional droop compensation)
+#define DECIMATOR_INPUT_HZ          1600
+#define DECIMATOR_OUTPUT_HZ         50
+#define DECIMATOR_ORDER             1
+#define DECIMATOR_COMPENSATE        false
+#define DECIMATOR_MAX_OUTPUTS       (BMI270_FIFO_MAX_SAMPLES / (DECIMATOR_INPUT_HZ / DECIMATOR_OUTPUT_HZ) + 1)
 
-// Global device handle
-static bmi270_dev_t g_dev = {0};
+// Teleplot envelope: min/max over the same 32-sample windows (false = decimated mean only)
+#define TELEPLOT_ENVELOPE           true
 
-// Statistics
-static uint32_t g_total_frames = 0;
-static uint32_t g_valid_frames = 0;
-static uint32_t g_skip_frames = 0;
-static uint32_t g_config_frames = 0;
-static uint32_t g_interrupt_count = 0;
+// Global device handle and FIFO stream (stream holds ~5KB of buffers)
+static bmi270_dev_t g_dev = {0};
+static bmi270_fifo_stream_t g_stream;
+static bmi270_decimator_t g_decimator;
+static bmi270_decimator_output_t g_decimated[DECIMATOR_MAX_OUTPUTS];
+static bmi270_envelope_t g_envelope;
+static bmi270_envelope_output_t g_envelopes[DECIMATOR_MAX_OUTPUTS];
 
 // Output decimation (reduce printf frequency)
 #define OUTPUT_DECIMATION 1  // Output every Nth interrupt (1 = every interrupt = 50Hz)
@@ -105,6 +99,7 @@ static SemaphoreHandle_t fifo_semaphore = NULL;
 static void IRAM_ATTR bmi270_int1_isr_handler(void* arg)
 {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    bmi270_fifo_stream_notify_from_isr(&g_stream);  // Timestamp for latency statistics
     xSemaphoreGiveFromISR(fifo_semaphore, &xHigherPriorityTaskWoken);
     if (xHigherPriorityTaskWoken) {
         portYIELD_FROM_ISR();
@@ -140,155 +135,78 @@ static esp_err_t configure_int1_gpio(void)
     return gpio_isr_handler_add(BMI270_INT1_PIN, bmi270_int1_isr_handler, NULL);
 }
 
-
 /**
- * @brief Flush FIFO (clear all data)
+ * @brief Decimate a FIFO batch and output the result
+ * @param batch Parsed FIFO batch
+ * @param output_enabled If true, output Teleplot data; if false, skip output
  */
-static esp_err_t fifo_flush(void)
+static void parse_fifo_buffer(const bmi270_fifo_batch_t *batch, bool output_enabled)
 {
-    esp_err_t ret = bmi270_write_register(&g_dev, BMI270_REG_CMD, BMI270_CMD_FIFO_FLUSH);
-    if (ret == ESP_OK) {
-        ESP_LOGW(TAG, "FIFO flushed");
-        vTaskDelay(pdMS_TO_TICKS(10));
-    }
-    return ret;
-}
+    ESP_LOGD(TAG, "Batch #%lu: %u samples (%u bytes)", batch->sequence, batch->sample_count, batch->fifo_length);
 
-/**
- * @brief Read FIFO length
- */
-static esp_err_t read_fifo_length(uint16_t *length)
-{
-    uint8_t length_data[2];
-    esp_err_t ret = bmi270_read_burst(&g_dev, BMI270_REG_FIFO_LENGTH_0, length_data, 2);
-    if (ret != ESP_OK) {
-        return ret;
+    // Overflow: frames were lost before this batch, so its samples do not continue the last window
+    if (batch->lost_frames > 0) {
+        bmi270_decimator_reset(&g_decimator);
+        bmi270_envelope_reset(&g_envelope);
     }
 
-    // FIFO length is 11-bit value (0-2047 bytes)
-    *length = (uint16_t)((length_data[1] << 8) | length_data[0]) & 0x07FF;
-    return ESP_OK;
-}
-
-/**
- * @brief Read multiple frames from FIFO
- */
-static esp_err_t read_fifo_data(uint8_t *buffer, uint16_t length)
-{
-    return bmi270_read_burst(&g_dev, BMI270_REG_FIFO_DATA, buffer, length);
-}
-
-/**
- * @brief Parse one FIFO frame and accumulate data
- */
-static esp_err_t parse_frame(const uint8_t *frame_data, bmi270_gyro_t *gyro, bmi270_accel_t *accel)
-{
-    uint8_t header = frame_data[0];
+    // Integer accumulation; one conversion per output sample with the cached scale
+    uint16_t count = 0;
+    bmi270_decimator_process(&g_decimator, batch->samples, batch->sample_count,
+                             g_decimated, DECIMATOR_MAX_OUTPUTS, &count);
 
-    // Handle special headers
-    if (header == FIFO_HEADER_CONFIG) {
-        ESP_LOGD(TAG, "Config change frame (0x48)");
-        g_config_frames++;
-        return ESP_FAIL;
+    // Min/max of the full-rate samples in each window (a one-sample spike survives)
+    uint16_t envelope_count = 0;
+    if (TELEPLOT_ENVELOPE) {
+        bmi270_envelope_process(&g_envelope, batch->samples, batch->sample_count,
+                                g_envelopes, DECIMATOR_MAX_OUTPUTS, &envelope_count);
     }
 
-    if (header == FIFO_HEADER_SKIP) {
-        g_skip_frames++;
-        return ESP_FAIL;
+    // Sync loss: the samples parsed before it are contiguous, the FIFO was flushed after them
+    if (batch->sync_lost) {
+        bmi270_decimator_reset(&g_decimator);
+        bmi270_envelope_reset(&g_envelope);
     }
 
-    if (header != FIFO_HEADER_ACC_GYR) {
-        // Unknown header - frame sync error, will be recovered by FIFO flush
-        return ESP_FAIL;
+    if (!output_enabled) {
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        // Teleplot output format (decimated data)
+        printf(">gyr_x:%.3f\n", g_decimated[i].gyr.x);
+        printf(">gyr_y:%.3f\n", g_decimated[i].gyr.y);
+        printf(">gyr_z:%.3f\n", g_decimated[i].gyr.z);
+        printf(">acc_x:%.3f\n", g_decimated[i].acc.x);
+        printf(">acc_y:%.3f\n", g_decimated[i].acc.y);
+        printf(">acc_z:%.3f\n", g_decimated[i].acc.z);
     }
 
-    // Parse gyroscope data FIRST (bytes 1-6)
-    int16_t gyr_x = (int16_t)((frame_data[2] << 8) | frame_data[1]);
-    int16_t gyr_y = (int16_t)((frame_data[4] << 8) | frame_data[3]);
-    int16_t gyr_z = (int16_t)((frame_data[6] << 8) | frame_data[5]);
-
-    // Parse accelerometer data SECOND (bytes 7-12)
-    int16_t acc_x = (int16_t)((frame_data[8] << 8) | frame_data[7]);
-    int16_t acc_y = (int16_t)((frame_data[10] << 8) | frame_data[9]);
-    int16_t acc_z = (int16_t)((frame_data[12] << 8) | frame_data[11]);
-
-    // Convert to physical values
-    bmi270_raw_data_t gyr_raw = {gyr_x, gyr_y, gyr_z};
-    bmi270_raw_data_t acc_raw = {acc_x, acc_y, acc_z};
-
-    bmi270_convert_gyro_raw(&g_dev, &gyr_raw, gyro);
-    bmi270_convert_accel_raw(&g_dev, &acc_raw, accel);
-
-    g_valid_frames++;
-    return ESP_OK;
+    // Teleplot envelope channels (GYR X/Y/Z, ACC X/Y/Z)
+    static const char *const names[BMI270_ENVELOPE_CHANNELS] = {
+        "gyr_x", "gyr_y", "gyr_z", "acc_x", "acc_y", "acc_z",
+    };
+    for (uint16_t i = 0; i < envelope_count; i++) {
+        for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+            printf(">%s_min:%.3f\n", names[ch], g_envelopes[i].ch[ch].min);
+            printf(">%s_max:%.3f\n", names[ch], g_envelopes[i].ch[ch].max);
+        }
+    }
 }
 
 /**
- * @brief Parse all frames in FIFO buffer and output averaged data
- * @param buffer FIFO data buffer
- * @param length Length of buffer in bytes
- * @param output_enabled If true, output Teleplot data; if false, skip output
- * @return true if skip frame detected, false otherwise
+ * @brief FIFO batch callback (called from bmi270_fifo_stream_drain())
  */
-static bool parse_fifo_buffer(const uint8_t *buffer, uint16_t length, bool output_enabled)
+static void on_fifo_batch(const bmi270_fifo_batch_t *batch, void *user_ctx)
 {
-    int num_frames = length / FIFO_FRAME_SIZE_HEADER;
-    int valid_count = 0;
-    bool skip_detected = false;
-
-    ESP_LOGD(TAG, "Parsing %d frames (%u bytes)", num_frames, length);
-
-    // Accumulators for averaging
-    double sum_gyr_x = 0.0, sum_gyr_y = 0.0, sum_gyr_z = 0.0;
-    double sum_acc_x = 0.0, sum_acc_y = 0.0, sum_acc_z = 0.0;
-
-    // Parse all frames and accumulate values
-    for (int i = 0; i < num_frames; i++) {
-        const uint8_t *frame = &buffer[i * FIFO_FRAME_SIZE_HEADER];
-        g_total_frames++;
-
-        // Check for skip frame
-        if (frame[0] == FIFO_HEADER_SKIP) {
-            skip_detected = true;
-            g_skip_frames++;
-            continue;
-        }
+    // Determine if we should output Teleplot data this time (decimation + enable flag)
+    g_output_counter++;
+    bool output_enabled = g_teleplot_enabled && (g_output_counter % OUTPUT_DECIMATION == 0);
 
-        bmi270_gyro_t gyro;
-        bmi270_accel_t accel;
-
-        if (parse_frame(frame, &gyro, &accel) == ESP_OK) {
-            sum_gyr_x += gyro.x;
-            sum_gyr_y += gyro.y;
-            sum_gyr_z += gyro.z;
-            sum_acc_x += accel.x;
-            sum_acc_y += accel.y;
-            sum_acc_z += accel.z;
-            valid_count++;
-        }
-    }
+    parse_fifo_buffer(batch, output_enabled);
 
-    ESP_LOGD(TAG, "Valid frames: %d/%d", valid_count, num_frames);
-
-    // Calculate average and output (only if we have valid data AND output is enabled)
-    if (valid_count > 0 && output_enabled) {
-        double avg_gyr_x = sum_gyr_x / valid_count;
-        double avg_gyr_y = sum_gyr_y / valid_count;
-        double avg_gyr_z = sum_gyr_z / valid_count;
-        double avg_acc_x = sum_acc_x / valid_count;
-        double avg_acc_y = sum_acc_y / valid_count;
-        double avg_acc_z = sum_acc_z / valid_count;
-
-        // Teleplot output format (averaged data)
-        printf(">gyr_x:%.3f\n", avg_gyr_x);
-        printf(">gyr_y:%.3f\n", avg_gyr_y);
-        printf(">gyr_z:%.3f\n", avg_gyr_z);
-        printf(">acc_x:%.3f\n", avg_acc_x);
-        printf(">acc_y:%.3f\n", avg_acc_y);
-        printf(">acc_z:%.3f\n", avg_acc_z);
+    if (batch->lost_frames > 0) {
+        ESP_LOGW(TAG, "FIFO overflow: %u frames lost", batch->lost_frames);
     }
-
-    return skip_detected;
 }
 
 /**
@@ -296,51 +214,39 @@ static bool parse_fifo_buffer(const uint8_t *buffer, uint16_t length, bool outpu
  */
 static void fifo_read_task(void *arg)
 {
-    static uint8_t fifo_buffer[FIFO_MAX_SIZE];  // Static to avoid stack overflow
-
     ESP_LOGD(TAG, "FIFO read task started (waiting for interrupts)");
 
     while (1) {
         // Wait for interrupt notification
         if (xSemaphoreTake(fifo_semaphore, portMAX_DELAY) == pdTRUE) {
-            g_interrupt_count++;
-
-            // Read FIFO length
-            uint16_t fifo_length;
-            esp_err_t ret = read_fifo_length(&fifo_length);
+            // Read status + FIFO length + data, parse, update statistics
+            esp_err_t ret = bmi270_fifo_stream_drain(&g_stream);
             if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to read FIFO length");
-                continue;
+                ESP_LOGE(TAG, "Failed to drain FIFO");
             }
+        }
+    }
+}
 
-            // Check if we have at least one frame
-            if (fifo_length >= FIFO_FRAME_SIZE_HEADER) {
-                // Read all FIFO data
-                ret = read_fifo_data(fifo_buffer, fifo_length);
-                if (ret != ESP_OK) {
-                    ESP_LOGE(TAG, "Failed to read FIFO data");
-                    continue;
-                }
-
-                // Determine if we should output Teleplot data this time (decimation + enable flag)
-                g_output_counter++;
-                bool output_enabled = g_teleplot_enabled && (g_output_counter % OUTPUT_DECIMATION == 0);
-
-                // Parse all frames in buffer
-                bool skip_detected = parse_fifo_buffer(fifo_buffer, fifo_length, output_enabled);
-
-                // If skip frame detected, flush FIFO to recover
-                if (skip_detected) {
-                    ret = fifo_flush();
-                    if (ret != ESP_OK) {
-                        ESP_LOGE(TAG, "Failed to flush FIFO");
-                    }
-                }
-            }
+/**
+ * @brief Print FIFO stream statistics snapshot
+ */
+static void print_fifo_stats(void)
+{
+    bmi270_fifo_stats_t stats;
+    if (bmi270_fifo_stream_get_stats(&g_stream, &stats) != ESP_OK) {
+        return;
+    }
+
+    ESP_LOGD(TAG, "Status: INT=%lu, Drains=%lu, Frames=%lu, Skip=%lu, Config=%lu, Lost=%lu, Latency max=%lu us, Output=%s",
+             stats.watermark_events, stats.drains, stats.sensor_frames, stats.skip_frames,
+             stats.config_frames, stats.lost_frames, stats.latency_max_us,
+             g_teleplot_enabled ? "ON" : "OFF");
 
-            // Clear latched interrupt by reading INT_STATUS_1 register (0x1D)
-            uint8_t int_status;
-            bmi270_read_register(&g_dev, 0x1D, &int_status);
+    for (int i = 0; i < BMI270_FIFO_STATS_LATENCY_BINS; i++) {
+        if (stats.latency_hist[i] > 0) {
+            ESP_LOGD(TAG, "  latency [%lu, %lu) us: %lu",
+                     1UL << i, 1UL << (i + 1), stats.latency_hist[i]);
         }
     }
 }
@@ -402,107 +308,82 @@ void app_main(void)
     // Wait for sensors to stabilize
     vTaskDelay(pdMS_TO_TICKS(100));
 
-    // Step 5: Configure FIFO (ACC+GYR, Header mode, Stream mode)
-    ESP_LOGI(TAG, "Step 5: Configuring FIFO...");
-
-    // FIFO_CONFIG_0: Stream mode (stop_on_full = 0, default 0x00)
-    uint8_t fifo_config_0 = 0x00;
-    ret = bmi270_write_register(&g_dev, BMI270_REG_FIFO_CONFIG_0, fifo_config_0);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write FIFO_CONFIG_0");
-        return;
-    }
-
-    // FIFO_CONFIG_1: Enable ACC+GYR, Header mode
-    uint8_t fifo_config_1 = (1 << 7) | (1 << 6) | (1 << 4);  // 0xD0
-    ret = bmi270_write_register(&g_dev, BMI270_REG_FIFO_CONFIG_1, fifo_config_1);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write FIFO_CONFIG_1");
-        return;
-    }
-
-    ESP_LOGI(TAG, "FIFO configured: ACC+GYR enabled, Header mode, Stream mode");
-
-    // Verify configuration
-    uint8_t fifo_config_1_readback;
-    bmi270_read_register(&g_dev, BMI270_REG_FIFO_CONFIG_1, &fifo_config_1_readback);
-    ESP_LOGD(TAG, "FIFO_CONFIG_1 readback: 0x%02X (expected 0xD0)", fifo_config_1_readback);
-
-    // Step 6: Configure FIFO watermark (but NOT interrupt mapping yet)
-    ESP_LOGI(TAG, "Step 6: Configuring FIFO watermark...");
-
-    // Set FIFO watermark only
-    uint16_t watermark = FIFO_WATERMARK_BYTES;
-    uint8_t wtm_lsb = watermark & 0xFF;
-    uint8_t wtm_msb = (watermark >> 8) & 0x07;
-
-    ret = bmi270_write_register(&g_dev, BMI270_REG_FIFO_WTM_0, wtm_lsb);
+    // Step 5: Configure INT1 pin (active high, push-pull); not mapped yet, so no interrupt will fire
+    ESP_LOGI(TAG, "Step 5: Configuring INT1 pin...");
+    bmi270_int_pin_config_t int_config = {
+        .output_enable = true,
+        .active_high = true,
+        .open_drain = false,
+    };
+    ret = bmi270_configure_int_pin(&g_dev, BMI270_INT_PIN_1, &int_config);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write FIFO_WTM_0");
+        ESP_LOGE(TAG, "Failed to configure INT1 pin");
         return;
     }
 
-    ret = bmi270_write_register(&g_dev, BMI270_REG_FIFO_WTM_1, wtm_msb);
+    // Step 6: Configure GPIO INT1
+    ESP_LOGI(TAG, "Step 6: Configuring GPIO INT1 (GPIO%d)...", BMI270_INT1_PIN);
+    ret = configure_int1_gpio();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write FIFO_WTM_1");
+        ESP_LOGE(TAG, "Failed to configure INT1 GPIO");
         return;
     }
+    ESP_LOGI(TAG, "GPIO INT1 configured successfully");
 
-    ESP_LOGD(TAG, "FIFO watermark set to %u bytes (%u frames)", watermark, watermark / FIFO_FRAME_SIZE_HEADER);
-
-    // Configure INT1 pin (but interrupt not mapped yet, so no interrupt will fire)
-    uint8_t int1_io_ctrl = (1 << 0) | (1 << 1) | (1 << 3);  // bit 0: latch, bit 1: output_en, bit 3: active high
-    ret = bmi270_write_register(&g_dev, BMI270_REG_INT1_IO_CTRL, int1_io_ctrl);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write INT1_IO_CTRL");
+    // Step 7: Create semaphore for interrupt notification (BEFORE mapping interrupt)
+    ESP_LOGI(TAG, "Step 7: Creating semaphore for interrupt notification...");
+    fifo_semaphore = xSemaphoreCreateBinary();
+    if (fifo_semaphore == NULL) {
+        ESP_LOGE(TAG, "Failed to create semaphore");
         return;
     }
-    ESP_LOGD(TAG, "INT1 pin configured (not mapped yet)");
 
-    // Step 7: Configure GPIO INT1
-    ESP_LOGI(TAG, "Step 7: Configuring GPIO INT1 (GPIO%d)...", BMI270_INT1_PIN);
-    ret = configure_int1_gpio();
+    // Step 8: Configure decimator (reads the current ranges on every output)
+    ESP_LOGI(TAG, "Step 8: Configuring decimator (%d Hz -> %d Hz)...", DECIMATOR_INPUT_HZ, DECIMATOR_OUTPUT_HZ);
+    bmi270_decimator_config_t decimator_config = {
+        .input_rate_hz = DECIMATOR_INPUT_HZ,
+        .output_rate_hz = DECIMATOR_OUTPUT_HZ,
+        .order = DECIMATOR_ORDER,
+        .compensate = DECIMATOR_COMPENSATE,
+    };
+    ret = bmi270_decimator_init(&g_decimator, &g_dev, &decimator_config);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure INT1 GPIO");
+        ESP_LOGE(TAG, "Failed to initialize decimator");
         return;
     }
-    ESP_LOGI(TAG, "GPIO INT1 configured successfully");
-
-    // Step 8: Flush FIFO before enabling interrupt
-    ESP_LOGI(TAG, "Step 8: Flushing FIFO before enabling interrupt...");
-    ret = fifo_flush();
+    bmi270_envelope_config_t envelope_config = {
+        .mode = BMI270_ENVELOPE_MINMAX,
+        .input_rate_hz = DECIMATOR_INPUT_HZ,
+        .output_rate_hz = DECIMATOR_OUTPUT_HZ,
+    };
+    ret = bmi270_envelope_init(&g_envelope, &g_dev, &envelope_config);
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to flush FIFO");
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(10));
-
-
-    // Step 9: Create semaphore for interrupt notification (BEFORE mapping interrupt)
-    ESP_LOGI(TAG, "Step 9: Creating semaphore for interrupt notification...");
-    fifo_semaphore = xSemaphoreCreateBinary();
-    if (fifo_semaphore == NULL) {
-        ESP_LOGE(TAG, "Failed to create semaphore");
+        ESP_LOGE(TAG, "Failed to initialize envelope");
         return;
     }
 
-    // Step 10: NOW map FIFO watermark interrupt to INT1
-    ESP_LOGI(TAG, "Step 10: Mapping FIFO watermark interrupt to INT1...");
-    uint8_t int_map_data = (1 << 1);  // bit 1: fwm_int -> INT1
-    ret = bmi270_write_register(&g_dev, BMI270_REG_INT_MAP_DATA, int_map_data);
+    // Step 9: Configure FIFO stream (ACC+GYR, header mode, stream mode, watermark),
+    //         flush FIFO and map the watermark interrupt to INT1
+    ESP_LOGI(TAG, "Step 9: Starting FIFO stream...");
+    bmi270_fifo_stream_config_t stream_config = {
+        .watermark = FIFO_WATERMARK_BYTES,
+        .int_pin = BMI270_INT_PIN_1,
+        .callback = on_fifo_batch,
+        .user_ctx = NULL,
+    };
+    ret = bmi270_fifo_stream_init(&g_stream, &g_dev, &stream_config);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write INT_MAP_DATA");
+        ESP_LOGE(TAG, "Failed to start FIFO stream");
         return;
     }
-    ESP_LOGD(TAG, "FIFO watermark interrupt mapped to INT1");
 
-    // Step 11: Create FIFO read task
-    ESP_LOGI(TAG, "Step 11: Creating FIFO read task...");
+    // Step 10: Create FIFO read task
+    ESP_LOGI(TAG, "Step 10: Creating FIFO read task...");
     xTaskCreate(fifo_read_task, "fifo_read", 4096, NULL, 5, NULL);
 
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, " Interrupt-driven FIFO read active");
-    ESP_LOGI(TAG, " Watermark: %u bytes (%u frames)", FIFO_WATERMARK_BYTES, FIFO_WATERMARK_BYTES / FIFO_FRAME_SIZE_HEADER);
+    ESP_LOGI(TAG, " Watermark: %u bytes (%u frames)", FIFO_WATERMARK_BYTES, FIFO_WATERMARK_BYTES / BMI270_FIFO_FRAME_ACC_GYR_SIZE);
     ESP_LOGI(TAG, "========================================");
     ESP_LOGI(TAG, "Press 't' or 'o' to toggle Teleplot output ON/OFF");
     ESP_LOGI(TAG, "Teleplot output: %s", g_teleplot_enabled ? "ENABLED" : "DISABLED");
@@ -520,13 +401,11 @@ void app_main(void)
             }
         }
 
-        // Periodic status update (every 10 seconds)
+        // Periodic status update (every 10 seconds, lock-free snapshot)
         uint32_t current_time = esp_timer_get_time() / 1000000;  // Convert to seconds
         if (current_time - last_status_time >= 10) {
             last_status_time = current_time;
-            ESP_LOGD(TAG, "Status: INT=%lu, Total=%lu, Valid=%lu, Skip=%lu, Output=%s",
-                     g_interrupt_count, g_total_frames, g_valid_frames, g_skip_frames,
-                     g_teleplot_enabled ? "ON" : "OFF");
+            print_fifo_stats();
         }
 
         vTaskDelay(pdMS_TO_TICKS(100));  // Check every 100ms
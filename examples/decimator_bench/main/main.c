@@ -0,0 +1,215 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file main.c
+ * @brief BMI270 Decimator Cycle Benchmark
+ *
+ * This example demonstrates:
+ * - CPU cycles of the double-precision batch average (previous basic_fifo path)
+ * - CPU cycles of bmi270_decimator_process() (boxcar, CIC, fractional ratio)
+ * - Output agreement between the two paths
+ *
+ * No sensor is needed: a synthetic 32-sample batch (one 416-byte watermark
+ * at 1600Hz) is processed repeatedly and timed with the CPU cycle counter.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "bmi270_data.h"
+#include "bmi270_decimator.h"
+
+static const char *TAG = "BMI270_DECIMATOR_BENCH";
+
+#define BENCH_BATCH_SAMPLES     32      // 416-byte watermark at 1600Hz
+#define BENCH_ITERATIONS        2000
+#define BENCH_MAX_OUTPUTS       (BENCH_BATCH_SAMPLES + 1)
+
+static bmi270_dev_t g_dev = {
+    .acc_range = BMI270_ACC_RANGE_4G,
+    .gyr_range = BMI270_GYR_RANGE_1000DPS,
+};
+static bmi270_fifo_sample_t g_samples[BENCH_BATCH_SAMPLES];
+static bmi270_decimator_output_t g_outputs[BENCH_MAX_OUTPUTS];
+
+// Keeps results alive so the compiler cannot drop the measured work
+static volatile float g_sink;
+
+/**
+ * @brief Cycle statistics of one benchmark case
+ */
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} cycle_stats_t;
+
+static void cycle_stats_add(cycle_stats_t *stats, uint32_t cycles)
+{
+    if (stats->total == 0 || cycles < stats->min) {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+    stats->total += cycles;
+}
+
+/**
+ * @brief Fill the batch with a deterministic motion pattern
+ */
+static void fill_samples(void)
+{
+    for (int i = 0; i < BENCH_BATCH_SAMPLES; i++) {
+        float t = (float)i / BENCH_BATCH_SAMPLES;
+        g_samples[i].gyr.x = (int16_t)(3000.0f * sinf(6.2832f * t));
+        g_samples[i].gyr.y = (int16_t)(-1500.0f * cosf(6.2832f * t));
+        g_samples[i].gyr.z = (int16_t)(i * 37 - 600);
+        g_samples[i].acc.x = (int16_t)(120 + (i & 7));
+        g_samples[i].acc.y = (int16_t)(-80 - (i & 3));
+        g_samples[i].acc.z = (int16_t)(8192 + ((i * 13) & 31) - 16);
+    }
+}
+
+/**
+ * @brief Previous basic_fifo path: convert every sample, accumulate in double, divide
+ */
+static void average_double(const bmi270_fifo_sample_t *samples, int count, bmi270_gyro_t *avg_gyr,
+                           bmi270_accel_t *avg_acc)
+{
+    double sum_gyr_x = 0.0, sum_gyr_y = 0.0, sum_gyr_z = 0.0;
+    double sum_acc_x = 0.0, sum_acc_y = 0.0, sum_acc_z = 0.0;
+
+    for (int i = 0; i < count; i++) {
+        bmi270_gyro_t gyro;
+        bmi270_accel_t accel;
+
+        bmi270_convert_gyro_raw(&g_dev, &samples[i].gyr, &gyro);
+        bmi270_convert_accel_raw(&g_dev, &samples[i].acc, &accel);
+
+        sum_gyr_x += gyro.x;
+        sum_gyr_y += gyro.y;
+        sum_gyr_z += gyro.z;
+        sum_acc_x += accel.x;
+        sum_acc_y += accel.y;
+        sum_acc_z += accel.z;
+    }
+
+    avg_gyr->x = sum_gyr_x / count;
+    avg_gyr->y = sum_gyr_y / count;
+    avg_gyr->z = sum_gyr_z / count;
+    avg_acc->x = sum_acc_x / count;
+    avg_acc->y = sum_acc_y / count;
+    avg_acc->z = sum_acc_z / count;
+}
+
+static void print_stats(const char *name, const cycle_stats_t *stats, uint32_t outputs)
+{
+    uint32_t avg = (uint32_t)(stats->total / BENCH_ITERATIONS);
+    printf("%-34s %8lu %8lu %8lu %10.1f %8lu\n", name, (unsigned long)stats->min, (unsigned long)avg,
+           (unsigned long)stats->max, (double)avg / BENCH_BATCH_SAMPLES, (unsigned long)outputs);
+}
+
+/**
+ * @brief Time the decimator on the same batch
+ */
+static void bench_decimator(const char *name, uint32_t output_rate_hz, uint8_t order, bool compensate,
+                            const bmi270_gyro_t *ref_gyr, const bmi270_accel_t *ref_acc)
+{
+    bmi270_decimator_t dec;
+    bmi270_decimator_config_t config = {
+        .input_rate_hz = 1600,
+        .output_rate_hz = output_rate_hz,
+        .order = order,
+        .compensate = compensate,
+    };
+    if (bmi270_decimator_init(&dec, &g_dev, &config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize decimator for %s", name);
+        return;
+    }
+
+    cycle_stats_t stats = {0};
+    uint16_t count = 0;
+    for (int iter = 0; iter < BENCH_ITERATIONS; iter++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        bmi270_decimator_process(&dec, g_samples, BENCH_BATCH_SAMPLES, g_outputs, BENCH_MAX_OUTPUTS, &count);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        cycle_stats_add(&stats, cycles);
+        if (count > 0) {
+            g_sink = g_outputs[count - 1].gyr.x;
+        }
+    }
+    print_stats(name, &stats, count);
+
+    // The boxcar over exactly one batch must match the double average
+    if (ref_gyr != NULL && count == 1) {
+        float err = fabsf(g_outputs[0].gyr.x - ref_gyr->x) + fabsf(g_outputs[0].gyr.y - ref_gyr->y) +
+                    fabsf(g_outputs[0].gyr.z - ref_gyr->z) + fabsf(g_outputs[0].acc.x - ref_acc->x) +
+                    fabsf(g_outputs[0].acc.y - ref_acc->y) + fabsf(g_outputs[0].acc.z - ref_acc->z);
+        printf("  boxcar vs double average: total abs error %.3g\n", err);
+    }
+}
+
+static void bench_task(void *arg)
+{
+    fill_samples();
+
+    printf("\nCycles per %d-sample batch (%d iterations, CPU %d MHz)\n", BENCH_BATCH_SAMPLES,
+           BENCH_ITERATIONS, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    printf("%-34s %8s %8s %8s %10s %8s\n", "path", "min", "avg", "max", "per sample", "outputs");
+
+    // Reference: double-precision average (previous parse_fifo_buffer())
+    bmi270_gyro_t ref_gyr;
+    bmi270_accel_t ref_acc;
+    cycle_stats_t stats = {0};
+    for (int iter = 0; iter < BENCH_ITERATIONS; iter++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        average_double(g_samples, BENCH_BATCH_SAMPLES, &ref_gyr, &ref_acc);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        cycle_stats_add(&stats, cycles);
+        g_sink = ref_gyr.x;
+    }
+    print_stats("double average (previous path)", &stats, 1);
+
+    bench_decimator("boxcar 1600->50Hz", 50, 1, false, &ref_gyr, &ref_acc);
+    bench_decimator("boxcar 1600->60Hz (fractional)", 60, 1, false, NULL, NULL);
+    bench_decimator("CIC3 1600->50Hz", 50, 3, false, NULL, NULL);
+    bench_decimator("CIC3 1600->50Hz + compensation", 50, 3, true, NULL, NULL);
+    bench_decimator("CIC2 1600->200Hz + compensation", 200, 2, true, NULL, NULL);
+
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    // Pin to one core so the cycle counter is not affected by migration
+    xTaskCreatePinnedToCore(bench_task, "decimator_bench", 4096, NULL, 5, NULL, 1);
+}
@@ -0,0 +1,265 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file main.c
+ * @brief BMI270 Triggered FIFO Capture Example
+ *
+ * This example demonstrates:
+ * - FIFO stop-on-full capture windows (2 KB = 157 frames @ 1600Hz = ~98ms)
+ * - Triggering by any-motion (sensor side) or by the host ('c' key)
+ * - Draining the frozen FIFO in one burst and automatic re-arm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_interrupt.h"
+#include "bmi270_capture.h"
+
+static const char *TAG = "BMI270_FIFO_CAPTURE";
+
+// M5StampFly BMI270 pin configuration
+#define BMI270_MOSI_PIN     14
+#define BMI270_MISO_PIN     43
+#define BMI270_SCLK_PIN     44
+#define BMI270_CS_PIN       46
+#define BMI270_INT1_PIN     11        // INT1 interrupt pin
+#define BMI270_SPI_CLOCK_HZ 10000000  // 10 MHz
+#define PMW3901_CS_PIN      12        // Other device on shared SPI bus
+
+// Global device handle and capture context
+static bmi270_dev_t g_dev = {0};
+static bmi270_capture_t g_capture;  // Holds the 2 KB drain buffer
+
+// Semaphore for interrupt notification
+static SemaphoreHandle_t int_semaphore = NULL;
+
+// Host trigger request (capture API is used from capture_task only)
+static volatile bool g_host_trigger = false;
+
+/**
+ * @brief INT1 interrupt handler (FIFO full or any-motion)
+ */
+static void IRAM_ATTR bmi270_int1_isr_handler(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(int_semaphore, &xHigherPriorityTaskWoken);
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief Configure GPIO for INT1 interrupt
+ */
+static esp_err_t configure_int1_gpio(void)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << BMI270_INT1_PIN),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_POSEDGE  // Rising edge (INT1 is active high)
+    };
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Install GPIO ISR service
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        // ESP_ERR_INVALID_STATE means already installed
+        return ret;
+    }
+
+    return gpio_isr_handler_add(BMI270_INT1_PIN, bmi270_int1_isr_handler, NULL);
+}
+
+/**
+ * @brief Capture completion callback: report peak values of the window
+ */
+static void on_capture(const bmi270_capture_event_t *event, void *user_ctx)
+{
+    static const char *trigger_names[] = {"host", "external", "any-motion"};
+
+    bmi270_fifo_parser_t parser;
+    bmi270_fifo_frame_t frame;
+    int16_t peak_gyr = 0;
+    int16_t peak_acc = 0;
+
+    bmi270_fifo_parser_init(&parser, event->data, event->length);
+    while (bmi270_fifo_parser_next(&parser, &frame) == ESP_OK) {
+        if (frame.type != BMI270_FIFO_FRAME_SENSOR) {
+            continue;
+        }
+        const int16_t gyr[3] = {frame.gyr.x, frame.gyr.y, frame.gyr.z};
+        const int16_t acc[3] = {frame.acc.x, frame.acc.y, frame.acc.z};
+        for (int i = 0; i < 3; i++) {
+            if (abs(gyr[i]) > abs(peak_gyr)) {
+                peak_gyr = gyr[i];
+            }
+            if (abs(acc[i]) > abs(peak_acc)) {
+                peak_acc = acc[i];
+            }
+        }
+    }
+
+    bmi270_raw_data_t gyr_raw = {peak_gyr, 0, 0};
+    bmi270_raw_data_t acc_raw = {peak_acc, 0, 0};
+    bmi270_gyro_t gyro;
+    bmi270_accel_t accel;
+    bmi270_convert_gyro_raw_dps(&g_dev, &gyr_raw, &gyro);
+    bmi270_convert_accel_raw(&g_dev, &acc_raw, &accel);
+
+    ESP_LOGI(TAG, "Capture #%lu (%s): %u frames, %u bytes, trigger->drain %lld us, peak gyr %.1f dps, peak acc %.3f g",
+             event->sequence, trigger_names[event->trigger], event->frame_count, event->length,
+             event->drain_time_us - event->trigger_time_us, gyro.x, accel.x);
+}
+
+/**
+ * @brief Capture service task (triggered by interrupt)
+ */
+static void capture_task(void *arg)
+{
+    while (1) {
+        if (xSemaphoreTake(int_semaphore, portMAX_DELAY) == pdTRUE) {
+            if (g_host_trigger) {
+                g_host_trigger = false;
+                if (bmi270_capture_trigger(&g_capture, BMI270_CAPTURE_TRIGGER_HOST) == ESP_ERR_INVALID_STATE) {
+                    ESP_LOGW(TAG, "Capture busy, trigger ignored");
+                }
+            }
+
+            esp_err_t ret = bmi270_capture_service(&g_capture);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Capture service failed: %s", esp_err_to_name(ret));
+            }
+        }
+    }
+}
+
+void app_main(void)
+{
+    esp_err_t ret;
+
+    ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, " BMI270 Triggered FIFO Capture");
+    ESP_LOGI(TAG, "========================================");
+
+    // Step 1: Initialize SPI bus
+    bmi270_config_t config = {
+        .gpio_mosi = BMI270_MOSI_PIN,
+        .gpio_miso = BMI270_MISO_PIN,
+        .gpio_sclk = BMI270_SCLK_PIN,
+        .gpio_cs = BMI270_CS_PIN,
+        .spi_clock_hz = BMI270_SPI_CLOCK_HZ,
+        .spi_host = SPI2_HOST,
+        .gpio_other_cs = PMW3901_CS_PIN
+    };
+
+    ret = bmi270_spi_init(&g_dev, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SPI");
+        return;
+    }
+
+    // Step 2: Initialize BMI270
+    ret = bmi270_init(&g_dev);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize BMI270");
+        return;
+    }
+
+    // Step 3: Full-rate sensors (1600Hz)
+    bmi270_set_accel_config(&g_dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    bmi270_set_gyro_config(&g_dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    bmi270_set_accel_range(&g_dev, BMI270_ACC_RANGE_16G);
+    bmi270_set_gyro_range(&g_dev, BMI270_GYR_RANGE_2000DPS);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    // Step 4: INT1 pin (latched, active high, push-pull)
+    bmi270_int_pin_config_t int_config = {
+        .output_enable = true,
+        .active_high = true,
+        .open_drain = false,
+    };
+    bmi270_configure_int_pin(&g_dev, BMI270_INT_PIN_1, &int_config);
+    bmi270_set_int_latch_mode(&g_dev, true);
+
+    int_semaphore = xSemaphoreCreateBinary();
+    if (int_semaphore == NULL) {
+        ESP_LOGE(TAG, "Failed to create semaphore");
+        return;
+    }
+    ret = configure_int1_gpio();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure INT1 GPIO");
+        return;
+    }
+
+    // Step 5: Capture mode (any-motion trigger, ~80mg for 1 sample, auto re-arm)
+    bmi270_capture_config_t capture_config = {
+        .int_pin = BMI270_INT_PIN_1,
+        .any_motion_trigger = true,
+        .any_motion = {
+            .threshold = 170,   // 170 x 0.48mg = ~80mg
+            .duration = 1,      // 20ms
+            .axis_x = true,
+            .axis_y = true,
+            .axis_z = true,
+        },
+        .auto_rearm = true,
+        .callback = on_capture,
+        .user_ctx = NULL,
+    };
+    ret = bmi270_capture_init(&g_capture, &g_dev, &capture_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize capture");
+        return;
+    }
+
+    xTaskCreate(capture_task, "capture", 4096, NULL, 5, NULL);
+
+    ESP_LOGI(TAG, "Capture armed: tap the board or press 'c' for a host trigger");
+
+    while (1) {
+        int c = getchar();
+        if (c == 'c' || c == 'C') {
+            g_host_trigger = true;
+            xSemaphoreGive(int_semaphore);
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
@@ -0,0 +1,319 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file main.c
+ * @brief BMI270 Hybrid Data-Ready + FIFO Example
+ *
+ * This example demonstrates:
+ * - Rate loop fed by the newest sample on every data-ready interrupt (1600Hz)
+ * - Gap-free FIFO history drained at a low watermark (8 frames = 5ms)
+ * - Both paths scheduled from one service task (no SPI collisions)
+ * - Spike rejection on the rate-loop path (bounded delta, no added delay)
+ * - Latency statistics for each path
+ */
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_interrupt.h"
+#include "bmi270_hybrid.h"
+
+static const char *TAG = "BMI270_HYBRID_FIFO";
+
+// M5StampFly BMI270 pin configuration
+#define BMI270_MOSI_PIN     14
+#define BMI270_MISO_PIN     43
+#define BMI270_SCLK_PIN     44
+#define BMI270_CS_PIN       46
+#define BMI270_INT1_PIN     11        // INT1 interrupt pin
+#define BMI270_SPI_CLOCK_HZ 10000000  // 10 MHz
+#define PMW3901_CS_PIN      12        // Other device on shared SPI bus
+
+// History watermark: 8 frames = 104 bytes (5ms @ 1600Hz, ~100µs burst @ 10MHz)
+#define HISTORY_WATERMARK_BYTES (8 * BMI270_FIFO_FRAME_ACC_GYR_SIZE)
+
+// Spike rejection limits (StampFly-class airframe; start generous and tighten from flight logs)
+#define SPIKE_GYR_MAX_ACCEL     2000.0f     // Maximum angular acceleration [rad/s^2]
+#define SPIKE_GYR_MAX_JERK      1.0e6f      // Maximum angular jerk [rad/s^3]
+#define SPIKE_ACC_MAX_SLEW      200.0f      // Maximum change of specific force [g/s]
+#define SPIKE_NOISE_MARGIN_LSB  24          // Sensor noise allowance [LSB]
+
+// Global device handle and hybrid context (context holds ~5KB of buffers)
+static bmi270_dev_t g_dev = {0};
+static bmi270_hybrid_t g_hybrid;
+static bmi270_spike_filter_t g_spike;
+
+// Tasks and interrupt notification
+static SemaphoreHandle_t drdy_semaphore = NULL;
+static TaskHandle_t rate_loop_handle = NULL;
+
+// History consumer state (service task only)
+static uint32_t g_history_samples = 0;
+
+/**
+ * @brief INT1 interrupt handler (data ready)
+ */
+static void IRAM_ATTR bmi270_int1_isr_handler(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    bmi270_hybrid_notify_from_isr(&g_hybrid);
+    xSemaphoreGiveFromISR(drdy_semaphore, &xHigherPriorityTaskWoken);
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief Configure GPIO for INT1 interrupt
+ */
+static esp_err_t configure_int1_gpio(void)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << BMI270_INT1_PIN),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_POSEDGE  // Rising edge (INT1 is active high)
+    };
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+
+    return gpio_isr_handler_add(BMI270_INT1_PIN, bmi270_int1_isr_handler, NULL);
+}
+
+/**
+ * @brief Latest-sample callback: wake the rate loop
+ */
+static void on_latest_sample(const bmi270_hybrid_sample_t *sample, void *user_ctx)
+{
+    xTaskNotifyGive(rate_loop_handle);
+}
+
+/**
+ * @brief History callback: consume the gap-free FIFO batch
+ */
+static void on_history_batch(const bmi270_fifo_batch_t *batch, void *user_ctx)
+{
+    g_history_samples += batch->sample_count;
+
+    if (batch->lost_frames > 0) {
+        ESP_LOGW(TAG, "History overflow: %u frames lost", batch->lost_frames);
+    }
+}
+
+/**
+ * @brief Service task: owns the SPI bus for both paths
+ */
+static void service_task(void *arg)
+{
+    while (1) {
+        if (xSemaphoreTake(drdy_semaphore, portMAX_DELAY) == pdTRUE) {
+            esp_err_t ret = bmi270_hybrid_service(&g_hybrid);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Hybrid service failed");
+            }
+        }
+    }
+}
+
+/**
+ * @brief Rate loop: runs on every new sample, never touches the bus
+ */
+static void rate_loop_task(void *arg)
+{
+    uint32_t age_max_us = 0;
+    uint32_t loops = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        bmi270_hybrid_sample_t sample;
+        if (bmi270_hybrid_get_latest(&g_hybrid, &sample) != ESP_OK) {
+            continue;
+        }
+
+        bmi270_gyro_t gyro;
+        bmi270_convert_gyro_raw(&g_dev, &sample.gyr, &gyro);
+
+        // Sample age when the controller sees it (data ready -> here)
+        uint32_t age_us = (uint32_t)(esp_timer_get_time() - sample.drdy_time_us);
+        if (age_us > age_max_us) {
+            age_max_us = age_us;
+        }
+
+        if (++loops % 1600 == 0) {
+            ESP_LOGD(TAG, "Rate loop: gyr_z=%.3f rad/s, age max=%lu us", gyro.z, age_max_us);
+            age_max_us = 0;
+        }
+    }
+}
+
+/**
+ * @brief Print statistics of both paths
+ */
+static void print_hybrid_stats(void)
+{
+    bmi270_hybrid_stats_t latest;
+    bmi270_fifo_stats_t history;
+
+    if (bmi270_hybrid_get_stats(&g_hybrid, &latest) != ESP_OK ||
+        bmi270_hybrid_get_history_stats(&g_hybrid, &history) != ESP_OK) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Latest : DRDY=%lu, Samples=%lu, Missed=%lu, Stale=%lu, Spikes=%lu, Latency max=%lu us",
+             latest.drdy_events, latest.samples, latest.missed_drdy, latest.stale_reads,
+             latest.spike_rejected, latest.latency_max_us);
+    ESP_LOGI(TAG, "History: Drains=%lu, Frames=%lu, Consumed=%lu, Lost=%lu, Latency max=%lu us",
+             history.drains, history.sensor_frames, g_history_samples, history.lost_frames,
+             history.latency_max_us);
+}
+
+void app_main(void)
+{
+    esp_err_t ret;
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, " BMI270 Hybrid DRDY + FIFO Acquisition");
+    ESP_LOGI(TAG, "========================================");
+
+    // Step 1: Initialize SPI bus
+    ESP_LOGI(TAG, "Step 1: Initializing SPI bus...");
+    bmi270_config_t config = {
+        .gpio_mosi = BMI270_MOSI_PIN,
+        .gpio_miso = BMI270_MISO_PIN,
+        .gpio_sclk = BMI270_SCLK_PIN,
+        .gpio_cs = BMI270_CS_PIN,
+        .spi_clock_hz = BMI270_SPI_CLOCK_HZ,
+        .spi_host = SPI2_HOST,
+        .gpio_other_cs = PMW3901_CS_PIN
+    };
+
+    ret = bmi270_spi_init(&g_dev, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SPI");
+        return;
+    }
+
+    // Step 2: Initialize BMI270
+    ESP_LOGI(TAG, "Step 2: Initializing BMI270...");
+    ret = bmi270_init(&g_dev);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize BMI270");
+        return;
+    }
+
+    // Step 3: 1600Hz for both sensors
+    ESP_LOGI(TAG, "Step 3: Configuring sensors (1600Hz)...");
+    bmi270_set_accel_config(&g_dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    bmi270_set_gyro_config(&g_dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    // Step 4: INT1 pin (active high, push-pull, pulse mode)
+    ESP_LOGI(TAG, "Step 4: Configuring INT1 pin...");
+    bmi270_int_pin_config_t int_config = {
+        .output_enable = true,
+        .active_high = true,
+        .open_drain = false,
+    };
+    ret = bmi270_configure_int_pin(&g_dev, BMI270_INT_PIN_1, &int_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure INT1 pin");
+        return;
+    }
+
+    // Step 5: GPIO interrupt, semaphore and rate loop (before mapping DRDY)
+    ESP_LOGI(TAG, "Step 5: Configuring GPIO INT1 (GPIO%d)...", BMI270_INT1_PIN);
+    drdy_semaphore = xSemaphoreCreateBinary();
+    if (drdy_semaphore == NULL) {
+        ESP_LOGE(TAG, "Failed to create semaphore");
+        return;
+    }
+    ret = configure_int1_gpio();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure INT1 GPIO");
+        return;
+    }
+    xTaskCreate(rate_loop_task, "rate_loop", 4096, NULL, 10, &rate_loop_handle);
+
+    // Step 6: Spike filter for the rate loop (replaces bus-glitch outliers without delay)
+    bmi270_spike_config_t spike_config = {
+        .mode = BMI270_SPIKE_DELTA,
+        .sample_rate_hz = 1600,
+        .gyr_max_accel = SPIKE_GYR_MAX_ACCEL,
+        .gyr_max_jerk = SPIKE_GYR_MAX_JERK,
+        .acc_max_slew = SPIKE_ACC_MAX_SLEW,
+        .noise_margin_lsb = SPIKE_NOISE_MARGIN_LSB,
+    };
+    ret = bmi270_spike_init(&g_spike, &g_dev, &spike_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize spike filter");
+        return;
+    }
+
+    // Step 7: Start hybrid acquisition (FIFO history + DRDY mapping)
+    ESP_LOGI(TAG, "Step 7: Starting hybrid acquisition...");
+    bmi270_hybrid_config_t hybrid_config = {
+        .history_watermark = HISTORY_WATERMARK_BYTES,
+        .int_pin = BMI270_INT_PIN_1,
+        .sample_callback = on_latest_sample,
+        .history_callback = on_history_batch,
+        .user_ctx = NULL,
+        .spike_filter = &g_spike,
+    };
+    ret = bmi270_hybrid_init(&g_hybrid, &g_dev, &hybrid_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start hybrid acquisition");
+        return;
+    }
+
+    // Step 8: Service task (higher priority than the rate loop)
+    ESP_LOGI(TAG, "Step 8: Creating service task...");
+    xTaskCreate(service_task, "imu_service", 4096, NULL, 11, NULL);
+
+    // Periodic statistics
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        print_hybrid_stats();
+    }
+}
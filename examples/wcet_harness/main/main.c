@@ -0,0 +1,465 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file main.c
+ * @brief BMI270 WCET / Jitter Harness
+ *
+ * This example demonstrates:
+ * - Worst-case and tail (p99.99) execution time of the driver hot paths,
+ *   measured with the CPU cycle counter over up to millions of iterations
+ * - The same measurement under each background load source on the other
+ *   core (flash writes, memory/cache traffic, PMW3901 on the shared SPI bus)
+ * - Attribution of the tail to the load source that inflates it most
+ *
+ * Measured paths (core 1, priority above the load tasks):
+ * - read:    bmi270_read_gyro_accel() (one 12-byte burst + conversion)
+ * - drain:   bmi270_fifo_stream_drain() paced at FIFO_DRAIN_PERIOD_US
+ * - parse:   frame parser over a captured 416-byte watermark buffer
+ * - convert: bmi270_convert_gyro_raw() + bmi270_convert_accel_raw()
+ * - filter:  spike filter + decimator over one 32-sample batch
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_fifo_stream.h"
+#include "bmi270_decimator.h"
+#include "bmi270_spike.h"
+#include "wcet_hist.h"
+#include "wcet_load.h"
+
+static const char *TAG = "BMI270_WCET";
+
+// M5StampFly BMI270 pin configuration
+#define BMI270_MOSI_PIN     14
+#define BMI270_MISO_PIN     43
+#define BMI270_SCLK_PIN     44
+#define BMI270_CS_PIN       46
+#define BMI270_SPI_CLOCK_HZ 10000000  // 10 MHz
+#define PMW3901_CS_PIN      12        // Other device on shared SPI bus
+
+// Harness configuration
+#define FIFO_WATERMARK_BYTES    416     // 32 frames @ 1600Hz
+#define FIFO_DRAIN_PERIOD_US    2500    // 4 frames per drain (FIFO paths are paced by the sensor)
+#define BATCH_SAMPLES           32
+#define DECIMATOR_OUTPUT_HZ     50
+#define YIELD_INTERVAL          1000    // Iterations between yields (outside the measured region)
+#define LOAD_SETTLE_MS          200     // Let the load tasks reach steady state
+#define MEASURE_CORE            1
+#define MEASURE_PRIORITY        10
+
+/**
+ * @brief Measured hot paths
+ */
+typedef enum {
+    PATH_READ = 0,
+    PATH_DRAIN,
+    PATH_PARSE,
+    PATH_CONVERT,
+    PATH_FILTER,
+    PATH_COUNT
+} wcet_path_t;
+
+static const char *const PATH_NAMES[PATH_COUNT] = { "read", "drain", "parse", "convert", "filter" };
+static const uint32_t PATH_ITERATIONS[PATH_COUNT] = { 1000000, 20000, 1000000, 1000000, 1000000 };
+
+/**
+ * @brief Background load scenario
+ */
+typedef struct {
+    const char *name;
+    uint32_t load_mask;
+} wcet_scenario_t;
+
+static const wcet_scenario_t SCENARIOS[] = {
+    { "none",    WCET_LOAD_NONE },
+    { "flash",   WCET_LOAD_FLASH },
+    { "memory",  WCET_LOAD_MEMORY },
+    { "pmw3901", WCET_LOAD_PMW3901 },
+    { "all",     WCET_LOAD_ALL },
+};
+#define SCENARIO_COUNT  (sizeof(SCENARIOS) / sizeof(SCENARIOS[0]))
+
+/**
+ * @brief Summary of one path under one scenario [cycles]
+ */
+typedef struct {
+    uint32_t p50;
+    uint32_t p9999;
+    uint32_t max;
+} wcet_result_t;
+
+static bmi270_dev_t g_dev = {0};
+static bmi270_fifo_stream_t g_stream;
+static bmi270_spike_filter_t g_spike;
+static bmi270_decimator_t g_decimator;
+
+static uint8_t g_capture_raw[FIFO_WATERMARK_BYTES];
+static uint16_t g_capture_length;
+static bmi270_fifo_sample_t g_capture_samples[BATCH_SAMPLES];
+static bmi270_fifo_sample_t g_work_samples[BATCH_SAMPLES];
+static bmi270_decimator_output_t g_outputs[BATCH_SAMPLES];
+
+static wcet_hist_t g_hist;
+static wcet_result_t g_results[SCENARIO_COUNT][PATH_COUNT];
+static uint32_t g_overhead;
+static uint32_t g_ticks_per_us;
+
+// Keeps results alive so the compiler cannot drop the measured work
+static volatile float g_sink;
+
+/* ====== Setup ====== */
+
+static esp_err_t sensor_init(void)
+{
+    bmi270_config_t config = {
+        .gpio_mosi = BMI270_MOSI_PIN,
+        .gpio_miso = BMI270_MISO_PIN,
+        .gpio_sclk = BMI270_SCLK_PIN,
+        .gpio_cs = BMI270_CS_PIN,
+        .spi_clock_hz = BMI270_SPI_CLOCK_HZ,
+        .spi_host = SPI2_HOST,
+        .gpio_other_cs = PMW3901_CS_PIN
+    };
+
+    esp_err_t ret = bmi270_spi_init(&g_dev, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SPI");
+        return ret;
+    }
+    ret = bmi270_init(&g_dev);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize BMI270");
+        return ret;
+    }
+    bmi270_set_accel_config(&g_dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    bmi270_set_gyro_config(&g_dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    // Polled stream: no interrupt GPIO, the harness calls drain itself
+    bmi270_fifo_stream_config_t stream_config = {
+        .watermark = FIFO_WATERMARK_BYTES,
+        .int_pin = BMI270_INT_PIN_1,
+    };
+    ret = bmi270_fifo_stream_init(&g_stream, &g_dev, &stream_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize FIFO stream");
+        return ret;
+    }
+
+    bmi270_spike_config_t spike_config = {
+        .mode = BMI270_SPIKE_DELTA,
+        .sample_rate_hz = 1600,
+        .gyr_max_accel = 2000.0f,
+        .gyr_max_jerk = 1.0e6f,
+        .acc_max_slew = 200.0f,
+        .noise_margin_lsb = 24,
+    };
+    ret = bmi270_spike_init(&g_spike, &g_dev, &spike_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize spike filter");
+        return ret;
+    }
+
+    bmi270_decimator_config_t decimator_config = {
+        .input_rate_hz = 1600,
+        .output_rate_hz = DECIMATOR_OUTPUT_HZ,
+        .order = 3,
+        .compensate = true,
+    };
+    ret = bmi270_decimator_init(&g_decimator, &g_dev, &decimator_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize decimator");
+        return ret;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Capture one watermark of real FIFO data for the CPU-only paths
+ */
+static esp_err_t capture_batch(void)
+{
+    bmi270_fifo_parser_t parser;
+    bmi270_fifo_frame_t frame;
+    uint16_t count = 0;
+
+    bmi270_fifo_flush(&g_dev);
+    vTaskDelay(pdMS_TO_TICKS(30));  // > 32 frames at 1600Hz
+
+    esp_err_t ret = bmi270_fifo_read(&g_dev, g_capture_raw, sizeof(g_capture_raw));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read FIFO");
+        return ret;
+    }
+    g_capture_length = sizeof(g_capture_raw);
+
+    bmi270_fifo_parser_init(&parser, g_capture_raw, g_capture_length);
+    while (count < BATCH_SAMPLES && bmi270_fifo_parser_next(&parser, &frame) == ESP_OK) {
+        if (frame.type == BMI270_FIFO_FRAME_SENSOR && frame.has_acc && frame.has_gyr) {
+            g_capture_samples[count].gyr = frame.gyr;
+            g_capture_samples[count].acc = frame.acc;
+            count++;
+        }
+    }
+    if (count < BATCH_SAMPLES) {
+        ESP_LOGE(TAG, "Captured only %u samples", count);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    bmi270_fifo_flush(&g_dev);
+    return ESP_OK;
+}
+
+/* ====== Measurement ====== */
+
+/**
+ * @brief Cost of an empty cycle counter read pair (subtracted from every sample)
+ */
+static uint32_t measure_overhead(void)
+{
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < 1000; i++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Busy-wait for the next drain slot so every drain finds the same amount of data
+ */
+static void drain_pace(void)
+{
+    static int64_t next_drain_us;
+
+    while (esp_timer_get_time() < next_drain_us) {
+    }
+    next_drain_us = esp_timer_get_time() + FIFO_DRAIN_PERIOD_US;
+}
+
+/**
+ * @brief Run one path once; only the path itself is inside the measured region
+ */
+static uint32_t measure_once(wcet_path_t path)
+{
+    uint32_t start;
+    uint32_t cycles = 0;
+
+    switch (path) {
+    case PATH_READ: {
+        bmi270_gyro_t gyro;
+        bmi270_accel_t accel;
+        start = esp_cpu_get_cycle_count();
+        bmi270_read_gyro_accel(&g_dev, &gyro, &accel);
+        cycles = esp_cpu_get_cycle_count() - start;
+        g_sink = gyro.x + accel.z;
+        break;
+    }
+    case PATH_DRAIN: {
+        drain_pace();
+        start = esp_cpu_get_cycle_count();
+        bmi270_fifo_stream_drain(&g_stream);
+        cycles = esp_cpu_get_cycle_count() - start;
+        break;
+    }
+    case PATH_PARSE: {
+        bmi270_fifo_parser_t parser;
+        bmi270_fifo_frame_t frame;
+        uint32_t frames = 0;
+        start = esp_cpu_get_cycle_count();
+        bmi270_fifo_parser_init(&parser, g_capture_raw, g_capture_length);
+        while (bmi270_fifo_parser_next(&parser, &frame) == ESP_OK) {
+            frames++;
+        }
+        cycles = esp_cpu_get_cycle_count() - start;
+        g_sink = frames;
+        break;
+    }
+    case PATH_CONVERT: {
+        bmi270_gyro_t gyro;
+        bmi270_accel_t accel;
+        const bmi270_fifo_sample_t *sample = &g_capture_samples[0];
+        start = esp_cpu_get_cycle_count();
+        bmi270_convert_gyro_raw(&g_dev, &sample->gyr, &gyro);
+        bmi270_convert_accel_raw(&g_dev, &sample->acc, &accel);
+        cycles = esp_cpu_get_cycle_count() - start;
+        g_sink = gyro.x + accel.z;
+        break;
+    }
+    case PATH_FILTER: {
+        uint16_t out_count = 0;
+        memcpy(g_work_samples, g_capture_samples, sizeof(g_work_samples));
+        bmi270_spike_reset(&g_spike);
+        start = esp_cpu_get_cycle_count();
+        for (int i = 0; i < BATCH_SAMPLES; i++) {
+            bmi270_spike_process(&g_spike, &g_work_samples[i].gyr, &g_work_samples[i].acc, 1);
+        }
+        bmi270_decimator_process(&g_decimator, g_work_samples, BATCH_SAMPLES, g_outputs,
+                                 BATCH_SAMPLES, &out_count);
+        cycles = esp_cpu_get_cycle_count() - start;
+        if (out_count > 0) {
+            g_sink = g_outputs[0].gyr.x;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    return (cycles > g_overhead) ? cycles - g_overhead : 0;
+}
+
+static void measure_path(wcet_path_t path, wcet_result_t *result)
+{
+    wcet_hist_reset(&g_hist);
+    if (path == PATH_DRAIN) {
+        bmi270_fifo_flush(&g_dev);
+    }
+
+    for (uint32_t i = 0; i < PATH_ITERATIONS[path]; i++) {
+        wcet_hist_add(&g_hist, measure_once(path));
+        if ((i % YIELD_INTERVAL) == YIELD_INTERVAL - 1) {
+            vTaskDelay(1);  // Lets the idle task run (task watchdog)
+            if (path == PATH_DRAIN) {
+                // The yield let the FIFO fill for a whole tick; empty it unmeasured
+                drain_pace();
+                bmi270_fifo_stream_drain(&g_stream);
+            }
+        }
+    }
+
+    result->p50 = wcet_hist_percentile(&g_hist, 50.0);
+    result->p9999 = wcet_hist_percentile(&g_hist, 99.99);
+    result->max = g_hist.max;
+
+    printf("  %-8s %8lu %8lu %8lu %8lu %8lu  (%.1f / %.1f us)\n", PATH_NAMES[path],
+           (unsigned long)PATH_ITERATIONS[path], (unsigned long)g_hist.min, (unsigned long)result->p50,
+           (unsigned long)result->p9999, (unsigned long)result->max,
+           (double)result->p9999 / g_ticks_per_us, (double)result->max / g_ticks_per_us);
+}
+
+/* ====== Report ====== */
+
+/**
+ * @brief Tail per path and scenario, and the scenario that inflates it most
+ */
+static void print_attribution(void)
+{
+    printf("\np99.99 / max [us] by load source\n");
+    printf("%-8s", "path");
+    for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+        printf(" %17s", SCENARIOS[s].name);
+    }
+    printf("  worst source (single)\n");
+
+    for (int p = 0; p < PATH_COUNT; p++) {
+        const wcet_result_t *base = &g_results[0][p];
+        size_t worst = 0;
+        uint32_t worst_excess = 0;
+
+        printf("%-8s", PATH_NAMES[p]);
+        for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+            const wcet_result_t *r = &g_results[s][p];
+            printf(" %8.1f/%8.1f", (double)r->p9999 / g_ticks_per_us, (double)r->max / g_ticks_per_us);
+
+            // Attribute to the single source (not "all") with the largest p99.99 increase
+            if (s > 0 && SCENARIOS[s].load_mask != WCET_LOAD_ALL && r->p9999 > base->p9999 &&
+                r->p9999 - base->p9999 > worst_excess) {
+                worst_excess = r->p9999 - base->p9999;
+                worst = s;
+            }
+        }
+        if (worst == 0) {
+            printf("  -\n");
+        } else {
+            printf("  %s (+%.1f us)\n", SCENARIOS[worst].name, (double)worst_excess / g_ticks_per_us);
+        }
+    }
+}
+
+static void harness_task(void *arg)
+{
+    g_ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+    g_overhead = measure_overhead();
+
+    printf("\nCPU %lu MHz, counter overhead %lu cycles (subtracted)\n",
+           (unsigned long)g_ticks_per_us, (unsigned long)g_overhead);
+
+    for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+        wcet_load_stats_t load_stats;
+
+        wcet_load_set(SCENARIOS[s].load_mask);
+        vTaskDelay(pdMS_TO_TICKS(LOAD_SETTLE_MS));
+        wcet_load_take_stats(&load_stats);
+
+        printf("\nScenario: %s\n", SCENARIOS[s].name);
+        printf("  %-8s %8s %8s %8s %8s %8s  [cycles]\n", "path", "iter", "min", "p50", "p99.99", "max");
+        for (int p = 0; p < PATH_COUNT; p++) {
+            measure_path((wcet_path_t)p, &g_results[s][p]);
+        }
+
+        wcet_load_set(WCET_LOAD_NONE);
+        wcet_load_take_stats(&load_stats);
+        printf("  load: flash commits %lu, memory passes %lu, pmw3901 reads %lu (errors %lu)\n",
+               (unsigned long)load_stats.flash_commits, (unsigned long)load_stats.memory_passes,
+               (unsigned long)load_stats.pmw3901_reads, (unsigned long)load_stats.pmw3901_errors);
+    }
+
+    print_attribution();
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+
+    ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, " BMI270 WCET / Jitter Harness");
+    ESP_LOGI(TAG, "========================================");
+
+    if (sensor_init() != ESP_OK || capture_batch() != ESP_OK) {
+        return;
+    }
+    if (wcet_load_init(SPI2_HOST, PMW3901_CS_PIN) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start load generators");
+        return;
+    }
+    ESP_LOGI(TAG, "Captured %u bytes; starting measurement on core %d", g_capture_length, MEASURE_CORE);
+
+    xTaskCreatePinnedToCore(harness_task, "wcet_harness", 8192, NULL, MEASURE_PRIORITY, NULL, MEASURE_CORE);
+}
@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file wcet_hist.c
+ * @brief Log-linear cycle histogram
+ */
+
+#include <string.h>
+#include "esp_attr.h"
+#include "wcet_hist.h"
+
+static inline uint32_t hist_index(uint32_t value)
+{
+    if (value < WCET_HIST_SUB) {
+        return value;
+    }
+    uint32_t exponent = 31 - __builtin_clz(value);      // >= WCET_HIST_SUB_BITS
+    uint32_t shift = exponent - WCET_HIST_SUB_BITS;
+    uint32_t sub = (value >> shift) & (WCET_HIST_SUB - 1);
+    return (shift + 1) * WCET_HIST_SUB + sub;
+}
+
+static uint32_t hist_upper(uint32_t index)
+{
+    if (index < WCET_HIST_SUB) {
+        return index;
+    }
+    uint32_t shift = index / WCET_HIST_SUB - 1;
+    uint32_t sub = index % WCET_HIST_SUB;
+    uint64_t upper = ((uint64_t)(WCET_HIST_SUB + sub + 1) << shift) - 1;
+    return (upper > UINT32_MAX) ? UINT32_MAX : (uint32_t)upper;
+}
+
+void wcet_hist_reset(wcet_hist_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->min = UINT32_MAX;
+}
+
+// Runs between measurements of the hot path; keep it out of flash
+void IRAM_ATTR wcet_hist_add(wcet_hist_t *hist, uint32_t cycles)
+{
+    hist->bins[hist_index(cycles)]++;
+    hist->count++;
+    hist->total += cycles;
+    if (cycles < hist->min) {
+        hist->min = cycles;
+    }
+    if (cycles > hist->max) {
+        hist->max = cycles;
+    }
+}
+
+uint32_t wcet_hist_percentile(const wcet_hist_t *hist, double percent)
+{
+    if (hist->count == 0) {
+        return 0;
+    }
+    // Rank of the percentile sample (1-based, rounded up)
+    uint64_t rank = (uint64_t)((double)hist->count * percent / 100.0);
+    if (rank < hist->count) {
+        rank++;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < WCET_HIST_BINS; i++) {
+        seen += hist->bins[i];
+        if (seen >= rank) {
+            uint32_t upper = hist_upper(i);
+            return (upper < hist->max) ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
@@ -0,0 +1,67 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file wcet_hist.h
+ * @brief Log-linear cycle histogram for tail latency (max, p99.99)
+ *
+ * 32 sub-buckets per power of two: any percentile is reported within
+ * about 3% above the true value, in 3.5 KB per histogram, so millions of
+ * samples can be recorded without storing them.
+ */
+
+#ifndef WCET_HIST_H
+#define WCET_HIST_H
+
+#include <stdint.h>
+
+#define WCET_HIST_SUB_BITS      5
+#define WCET_HIST_SUB           (1U << WCET_HIST_SUB_BITS)
+#define WCET_HIST_BINS          ((32 - WCET_HIST_SUB_BITS + 1) * WCET_HIST_SUB)
+
+/**
+ * @brief Cycle histogram
+ */
+typedef struct {
+    uint32_t bins[WCET_HIST_BINS];
+    uint64_t count;
+    uint64_t total;
+    uint32_t min;
+    uint32_t max;
+} wcet_hist_t;
+
+void wcet_hist_reset(wcet_hist_t *hist);
+
+/**
+ * @brief Record one measurement [cycles]
+ */
+void wcet_hist_add(wcet_hist_t *hist, uint32_t cycles);
+
+/**
+ * @brief Percentile (0-100), upper edge of the bucket that contains it [cycles]
+ */
+uint32_t wcet_hist_percentile(const wcet_hist_t *hist, double percent);
+
+#endif // WCET_HIST_H
@@ -0,0 +1,209 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file wcet_load.c
+ * @brief Background load generators for the WCET harness
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "wcet_load.h"
+
+static const char *TAG = "WCET_LOAD";
+
+#define LOAD_CORE               0
+#define LOAD_PRIORITY           5
+#define LOAD_STACK              4096
+#define LOAD_SLICE_US           10000   // Work per slice before yielding one tick (keeps the idle task alive)
+
+#define FLASH_BLOB_SIZE         1024
+#define FLASH_COMMIT_PERIOD_MS  100     // One blob commit per period (bounds flash wear, see README)
+#define MEMORY_BUFFER_SIZE      (32 * 1024)
+#define MEMORY_FLASH_TABLE_SIZE (64 * 1024)
+
+#define PMW3901_CLOCK_HZ        2000000
+#define PMW3901_REG_MOTION_BURST 0x16
+#define PMW3901_BURST_LEN       12
+
+static volatile uint32_t g_load_mask = WCET_LOAD_NONE;
+static volatile wcet_load_stats_t g_load_stats;
+
+static spi_device_handle_t g_pmw3901;
+static uint8_t g_copy_src[MEMORY_BUFFER_SIZE];
+static uint8_t g_copy_dst[MEMORY_BUFFER_SIZE];
+
+// Flash-resident table, larger than the cache; reading it evicts the hot path's code
+static const uint8_t s_flash_table[MEMORY_FLASH_TABLE_SIZE] = { 1 };
+
+/* ====== Generators ====== */
+
+/**
+ * @brief NVS writes: every commit programs flash, and page rollover erases sectors
+ *
+ * Rate-limited rather than back to back: each 1 KB blob takes 34 of the 126
+ * entries of an NVS page, so unthrottled commits erased a sector every few
+ * milliseconds. At one commit per FLASH_COMMIT_PERIOD_MS a sector is still
+ * erased about every 370 ms, often enough to land in every measured path.
+ */
+static void flash_load_task(void *arg)
+{
+    nvs_handle_t handle;
+    static uint8_t blob[FLASH_BLOB_SIZE];
+
+    if (nvs_open("wcet", NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS namespace");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (1) {
+        if (!(g_load_mask & WCET_LOAD_FLASH)) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        blob[0]++;
+        if (nvs_set_blob(handle, "blob", blob, sizeof(blob)) == ESP_OK && nvs_commit(handle) == ESP_OK) {
+            g_load_stats.flash_commits++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(FLASH_COMMIT_PERIOD_MS));
+    }
+}
+
+/**
+ * @brief SRAM copies and flash-table sweeps
+ */
+static void memory_load_task(void *arg)
+{
+    volatile uint32_t sink = 0;
+
+    while (1) {
+        if (!(g_load_mask & WCET_LOAD_MEMORY)) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        int64_t slice_end = esp_timer_get_time() + LOAD_SLICE_US;
+        while (esp_timer_get_time() < slice_end) {
+            memcpy(g_copy_dst, g_copy_src, sizeof(g_copy_dst));
+            uint32_t sum = 0;
+            for (size_t i = 0; i < sizeof(s_flash_table); i += 32) {   // One access per cache line
+                sum += s_flash_table[i];
+            }
+            sink += sum;
+            g_load_stats.memory_passes++;
+        }
+        vTaskDelay(1);
+    }
+}
+
+/**
+ * @brief PMW3901 motion bursts on the shared bus (back to back within a slice)
+ */
+static void pmw3901_load_task(void *arg)
+{
+    uint8_t tx[PMW3901_BURST_LEN + 1] = { PMW3901_REG_MOTION_BURST };
+    uint8_t rx[PMW3901_BURST_LEN + 1];
+
+    while (1) {
+        if (!(g_load_mask & WCET_LOAD_PMW3901)) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        int64_t slice_end = esp_timer_get_time() + LOAD_SLICE_US;
+        while (esp_timer_get_time() < slice_end) {
+            spi_transaction_t trans = {
+                .length = sizeof(tx) * 8,
+                .tx_buffer = tx,
+                .rx_buffer = rx,
+            };
+            if (spi_device_polling_transmit(g_pmw3901, &trans) == ESP_OK) {
+                g_load_stats.pmw3901_reads++;
+            } else {
+                g_load_stats.pmw3901_errors++;
+            }
+        }
+        vTaskDelay(1);
+    }
+}
+
+/* ====== API ====== */
+
+esp_err_t wcet_load_init(spi_host_device_t spi_host, int pmw3901_cs)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // The PMW3901 CS was parked high by bmi270_spi_init(); the SPI driver takes it over here
+    spi_device_interface_config_t dev_config = {
+        .clock_speed_hz = PMW3901_CLOCK_HZ,
+        .mode = 3,
+        .spics_io_num = pmw3901_cs,
+        .queue_size = 1,
+    };
+    ret = spi_bus_add_device(spi_host, &dev_config, &g_pmw3901);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add PMW3901 device: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    memset(g_copy_src, 0x5A, sizeof(g_copy_src));
+
+    if (xTaskCreatePinnedToCore(flash_load_task, "load_flash", LOAD_STACK, NULL, LOAD_PRIORITY, NULL, LOAD_CORE) != pdPASS ||
+        xTaskCreatePinnedToCore(memory_load_task, "load_memory", LOAD_STACK, NULL, LOAD_PRIORITY, NULL, LOAD_CORE) != pdPASS ||
+        xTaskCreatePinnedToCore(pmw3901_load_task, "load_pmw3901", LOAD_STACK, NULL, LOAD_PRIORITY, NULL, LOAD_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create load tasks");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void wcet_load_set(uint32_t mask)
+{
+    g_load_mask = mask;
+}
+
+void wcet_load_take_stats(wcet_load_stats_t *stats)
+{
+    stats->flash_commits = g_load_stats.flash_commits;
+    stats->memory_passes = g_load_stats.memory_passes;
+    stats->pmw3901_reads = g_load_stats.pmw3901_reads;
+    stats->pmw3901_errors = g_load_stats.pmw3901_errors;
+    g_load_stats.flash_commits = 0;
+    g_load_stats.memory_passes = 0;
+    g_load_stats.pmw3901_reads = 0;
+    g_load_stats.pmw3901_errors = 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file wcet_load.h
+ * @brief Background load generators for the WCET harness
+ *
+ * All generators run on core 0 while the hot paths are measured on
+ * core 1:
+ * - Flash: one NVS blob write + commit every 100 ms (flash writes stall the cache of both cores)
+ * - Memory: SRAM memcpy and sequential reads of a flash-resident table (cache eviction)
+ * - PMW3901: burst reads of the optical flow sensor on the shared SPI bus
+ */
+
+#ifndef WCET_LOAD_H
+#define WCET_LOAD_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/spi_master.h"
+
+/**
+ * @brief Load sources (bit mask)
+ */
+typedef enum {
+    WCET_LOAD_NONE    = 0,
+    WCET_LOAD_FLASH   = (1 << 0),
+    WCET_LOAD_MEMORY  = (1 << 1),
+    WCET_LOAD_PMW3901 = (1 << 2),
+    WCET_LOAD_ALL     = WCET_LOAD_FLASH | WCET_LOAD_MEMORY | WCET_LOAD_PMW3901,
+} wcet_load_t;
+
+/**
+ * @brief Load generator counters
+ */
+typedef struct {
+    uint32_t flash_commits;
+    uint32_t memory_passes;
+    uint32_t pmw3901_reads;
+    uint32_t pmw3901_errors;
+} wcet_load_stats_t;
+
+/**
+ * @brief Create the generator tasks (idle until enabled)
+ *
+ * @param spi_host SPI host shared with the BMI270 (after bmi270_spi_init())
+ * @param pmw3901_cs PMW3901 chip select GPIO
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t wcet_load_init(spi_host_device_t spi_host, int pmw3901_cs);
+
+/**
+ * @brief Select the active load sources
+ */
+void wcet_load_set(uint32_t mask);
+
+/**
+ * @brief Snapshot and clear the counters
+ */
+void wcet_load_take_stats(wcet_load_stats_t *stats);
+
+#endif // WCET_LOAD_H
@@ -0,0 +1,226 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_aux.h
+ * @brief BMI270 Auxiliary (AUX) Interface API
+ *
+ * The BMI270 can act as I2C master for a secondary sensor wired to its
+ * AUX pins (ASDx/ASCx). In data mode the BMI270 reads the sensor on its
+ * own at the AUX ODR and stores the result in AUX_DATA_0..7 and, when
+ * enabled, in the FIFO next to accelerometer and gyroscope data, on the
+ * same sensor time base.
+ *
+ * Typical usage (BMM150):
+ *   1. bmi270_init()
+ *   2. bmi270_bmm150_init() (manual mode setup, then data mode)
+ *   3. FIFO with aux_enable = true (bmi270_fifo_configure() or bmi270_fifo_stream_init())
+ *   4. bmi270_bmm150_compensate() on each AUX payload
+ *
+ * Other sensors: bmi270_aux_enable(), bmi270_aux_read()/bmi270_aux_write()
+ * for setup, then bmi270_aux_start_data_mode().
+ *
+ * @note The BMI270 internal AUX pull-ups are not enabled; the board must
+ *       provide pull-ups on the AUX I2C lines.
+ */
+
+#ifndef BMI270_AUX_H
+#define BMI270_AUX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_data.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ====== BMM150 Constants ====== */
+
+#define BMI270_BMM150_I2C_ADDR          0x10    // BMM150 default I2C address (SDO=GND, CSB=GND)
+#define BMI270_BMM150_CHIP_ID           0x32    // Expected BMM150 chip ID
+
+/* ====== Types ====== */
+
+/**
+ * @brief AUX read burst length
+ */
+typedef enum {
+    BMI270_AUX_BURST_1 = 0x00,      ///< 1 byte
+    BMI270_AUX_BURST_2 = 0x01,      ///< 2 bytes
+    BMI270_AUX_BURST_6 = 0x02,      ///< 6 bytes
+    BMI270_AUX_BURST_8 = 0x03       ///< 8 bytes
+} bmi270_aux_burst_t;
+
+/**
+ * @brief AUX data mode configuration structure
+ */
+typedef struct {
+    bmi270_acc_odr_t odr;           ///< AUX read rate (same coding as ACC ODR, max 800Hz)
+    uint8_t offset;                 ///< Read trigger offset (0-15)
+    uint8_t read_addr;              ///< First sensor register read on every trigger
+    bmi270_aux_burst_t burst;       ///< Bytes read on every trigger (stored in AUX_DATA_0..)
+    bool trigger_enable;            ///< Write trigger_value to trigger_reg before every read (forced mode sensors)
+    uint8_t trigger_reg;            ///< Sensor register written before every read
+    uint8_t trigger_value;          ///< Value written before every read
+} bmi270_aux_config_t;
+
+/**
+ * @brief BMM150 trim (factory calibration) registers
+ */
+typedef struct {
+    int8_t dig_x1;
+    int8_t dig_y1;
+    int8_t dig_x2;
+    int8_t dig_y2;
+    uint16_t dig_z1;
+    int16_t dig_z2;
+    int16_t dig_z3;
+    int16_t dig_z4;
+    uint8_t dig_xy1;
+    int8_t dig_xy2;
+    uint16_t dig_xyz1;
+} bmi270_bmm150_trim_t;
+
+/**
+ * @brief Magnetic field in physical units (µT)
+ */
+typedef struct {
+    float x;    ///< X-axis magnetic field [µT]
+    float y;    ///< Y-axis magnetic field [µT]
+    float z;    ///< Z-axis magnetic field [µT]
+} bmi270_mag_t;
+
+/* ====== AUX Interface Functions ====== */
+
+/**
+ * @brief Enable the AUX interface in manual mode
+ *
+ * Sets PWR_CTRL.aux_en and IF_CONF.aux_en, programs the device address
+ * and selects manual mode for sensor setup.
+ *
+ * @param[in] dev      Pointer to BMI270 device structure
+ * @param[in] i2c_addr 7-bit I2C address of the auxiliary sensor
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_aux_enable(bmi270_dev_t *dev, uint8_t i2c_addr);
+
+/**
+ * @brief Disable the AUX interface (PWR_CTRL.aux_en = 0)
+ *
+ * @param[in] dev Pointer to BMI270 device structure
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_aux_disable(bmi270_dev_t *dev);
+
+/**
+ * @brief Read auxiliary sensor registers (manual mode)
+ *
+ * @param[in]  dev    Pointer to BMI270 device structure
+ * @param[in]  reg    First sensor register
+ * @param[out] data   Buffer for register values
+ * @param[in]  length Number of bytes (1-8)
+ * @return
+ *         - ESP_OK: Success
+ *         - ESP_ERR_TIMEOUT: AUX transfer did not complete
+ *         - Other: SPI error
+ */
+esp_err_t bmi270_aux_read(bmi270_dev_t *dev, uint8_t reg, uint8_t *data, size_t length);
+
+/**
+ * @brief Write one auxiliary sensor register (manual mode)
+ *
+ * @param[in] dev   Pointer to BMI270 device structure
+ * @param[in] reg   Sensor register
+ * @param[in] value Value to write
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the AUX transfer did not complete
+ */
+esp_err_t bmi270_aux_write(bmi270_dev_t *dev, uint8_t reg, uint8_t value);
+
+/**
+ * @brief Switch the AUX interface to data mode (autonomous reads)
+ *
+ * @param[in] dev    Pointer to BMI270 device structure
+ * @param[in] config Pointer to data mode configuration
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_aux_start_data_mode(bmi270_dev_t *dev, const bmi270_aux_config_t *config);
+
+/**
+ * @brief Return the AUX interface to manual mode
+ *
+ * @param[in] dev Pointer to BMI270 device structure
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_aux_stop_data_mode(bmi270_dev_t *dev);
+
+/**
+ * @brief Read the latest data mode result (AUX_DATA_0..7)
+ *
+ * For non-FIFO use; with the FIFO the same bytes arrive in each AUX frame.
+ *
+ * @param[in]  dev  Pointer to BMI270 device structure
+ * @param[out] data 8-byte buffer
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_aux_read_data(bmi270_dev_t *dev, uint8_t data[8]);
+
+/* ====== BMM150 Functions ====== */
+
+/**
+ * @brief Set up a BMM150 on the AUX interface and start data mode
+ *
+ * Powers the BMM150 up, checks its chip ID, reads the trim registers,
+ * selects the regular preset (9 XY / 15 Z repetitions) and starts data
+ * mode: every AUX trigger starts a forced measurement and reads the
+ * 8 data bytes (0x42-0x49) of the previous one.
+ *
+ * @param[in]  dev  Pointer to BMI270 device structure
+ * @param[in]  odr  Magnetometer rate (max BMI270_ACC_ODR_100HZ with the regular preset)
+ * @param[out] trim Trim registers for bmi270_bmm150_compensate()
+ * @return
+ *         - ESP_OK: Success
+ *         - ESP_ERR_NOT_FOUND: BMM150 chip ID mismatch (not wired to AUX)
+ *         - ESP_ERR_INVALID_ARG: Invalid parameter
+ *         - Other: SPI or AUX transfer error
+ */
+esp_err_t bmi270_bmm150_init(bmi270_dev_t *dev, bmi270_acc_odr_t odr, bmi270_bmm150_trim_t *trim);
+
+/**
+ * @brief Convert a BMM150 AUX payload to µT (temperature-compensated)
+ *
+ * Uses the Bosch floating-point compensation. Overflowed axes read 0.
+ *
+ * @param[in]  trim Trim registers from bmi270_bmm150_init()
+ * @param[in]  raw  8-byte AUX payload (BMM150 0x42-0x49)
+ * @param[out] mag  Magnetic field [µT]
+ */
+void bmi270_bmm150_compensate(const bmi270_bmm150_trim_t *trim, const uint8_t raw[8], bmi270_mag_t *mag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_AUX_H
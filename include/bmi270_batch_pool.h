@@ -0,0 +1,157 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_batch_pool.h
+ * @brief BMI270 FIFO Batch Lending Pool API
+ *
+ * Without a pool the stream engine parses every drain into one internal
+ * batch that is overwritten by the next drain, so a consumer that needs
+ * the samples later has to copy them.
+ *
+ * With a pool attached (bmi270_fifo_stream_config_t.pool), each drain is
+ * read straight into a free pool buffer and parsed in place, and that
+ * buffer's batch is passed to the callback. A consumer that needs the
+ * batch beyond the callback takes a reference with bmi270_batch_retain()
+ * and may hand the read-only view to other tasks (logging, telemetry,
+ * estimation); every holder calls bmi270_batch_release() when done. A
+ * buffer is reused only after its last reference is released.
+ *
+ * The acquisition path never waits: if every buffer is still lent out,
+ * the drain falls back to the internal batch, the pool counts it as
+ * exhausted, and bmi270_batch_retain() returns NULL for that batch.
+ *
+ * Reference counts are atomic; retain and release may be called from any
+ * task (not from ISRs).
+ */
+
+#ifndef BMI270_BATCH_POOL_H
+#define BMI270_BATCH_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_fifo_stream.h"
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* ====== Constants ====== */
+
+/** Maximum number of buffers in one pool */
+#define BMI270_BATCH_POOL_MAX_BUFFERS   16
+
+/* ====== Types ====== */
+
+/**
+ * @brief One lendable batch buffer (about 5 KB; allocate statically)
+ */
+typedef struct bmi270_batch_buf {
+    bmi270_fifo_batch_t batch;          ///< Parsed batch (first member: the view handed to consumers)
+    uint8_t raw[BMI270_FIFO_SIZE];      ///< FIFO bytes of the drain (batch.raw points here)
+    atomic_uint refs;                   ///< References (0 = free)
+    struct bmi270_batch_pool *pool;     ///< Owning pool
+} bmi270_batch_buf_t;
+
+/**
+ * @brief Pool counters
+ */
+typedef struct {
+    uint32_t lent;              ///< Drains served from the pool
+    uint32_t exhausted;         ///< Drains that found no free buffer (internal batch used)
+    uint32_t retains;           ///< References taken by consumers
+    uint32_t in_use;            ///< Buffers currently referenced
+    uint32_t peak_in_use;       ///< Most buffers referenced at the same time
+} bmi270_batch_pool_stats_t;
+
+/**
+ * @brief Batch pool
+ */
+typedef struct bmi270_batch_pool {
+    bmi270_batch_buf_t *buffers;        ///< Buffer array (caller-provided)
+    uint8_t count;                      ///< Number of buffers
+    uint8_t next;                       ///< Search start of the next acquire (drain task only)
+    atomic_uint in_use;                 ///< Buffers currently referenced
+    atomic_uint peak_in_use;            ///< Peak of in_use
+    atomic_uint lent;                   ///< See bmi270_batch_pool_stats_t
+    atomic_uint exhausted;
+    atomic_uint retains;
+} bmi270_batch_pool_t;
+
+/* ====== Pool Functions ====== */
+
+/**
+ * @brief Initialize a pool over caller-provided buffers
+ *
+ * @param[out] pool    Pointer to pool
+ * @param[in]  buffers Buffer array (e.g. static bmi270_batch_buf_t bufs[4])
+ * @param[in]  count   Number of buffers (1 to BMI270_BATCH_POOL_MAX_BUFFERS)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG otherwise
+ */
+esp_err_t bmi270_batch_pool_init(bmi270_batch_pool_t *pool, bmi270_batch_buf_t *buffers, uint8_t count);
+
+/**
+ * @brief Take a free buffer with one reference (stream engine side)
+ *
+ * Never blocks.
+ *
+ * @param[in] pool Pointer to pool
+ * @return Buffer, or NULL if every buffer is referenced (counted as exhausted)
+ */
+bmi270_batch_buf_t *bmi270_batch_pool_acquire(bmi270_batch_pool_t *pool);
+
+/**
+ * @brief Take a reference to a lent batch
+ *
+ * Call while holding the batch (inside the callback, or with a reference
+ * already taken).
+ *
+ * @param[in] batch Batch passed to the callback
+ * @return The same batch (read-only view), or NULL if it is the stream's
+ *         internal batch (pool exhausted or no pool): copy what you need instead
+ */
+const bmi270_fifo_batch_t *bmi270_batch_retain(const bmi270_fifo_batch_t *batch);
+
+/**
+ * @brief Drop a reference; the buffer returns to the pool with the last one
+ *
+ * @param[in] batch Batch returned by bmi270_batch_retain()
+ */
+void bmi270_batch_release(const bmi270_fifo_batch_t *batch);
+
+/**
+ * @brief Copy the pool counters
+ *
+ * @param[in]  pool  Pointer to pool
+ * @param[out] stats Pointer to counters
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on NULL pointer
+ */
+esp_err_t bmi270_batch_pool_get_stats(bmi270_batch_pool_t *pool, bmi270_batch_pool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_BATCH_POOL_H
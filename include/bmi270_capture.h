@@ -0,0 +1,193 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_capture.h
+ * @brief BMI270 Triggered Burst Capture API
+ *
+ * This file provides an event capture mode built on the FIFO stop-on-full
+ * setting. While armed, FIFO recording is paused. A trigger (host call,
+ * external signal forwarded by the host, or the BMI270 any-motion feature)
+ * starts recording; the sensor then fills the 2 KB FIFO at full ODR
+ * without host involvement and freezes it. The FIFO full interrupt tells
+ * the host to drain the frozen window in one burst, after which the
+ * capture re-arms automatically.
+ *
+ * Typical usage:
+ *   1. bmi270_capture_init()
+ *   2. On trigger: bmi270_capture_trigger() (host / external sources)
+ *   3. On every INT pin event: bmi270_capture_service()
+ */
+
+#ifndef BMI270_CAPTURE_H
+#define BMI270_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_fifo.h"
+#include "bmi270_interrupt.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Capture trigger source
+ */
+typedef enum {
+    BMI270_CAPTURE_TRIGGER_HOST = 0,    ///< Host software request
+    BMI270_CAPTURE_TRIGGER_EXTERNAL,    ///< External signal (e.g. GPIO edge) forwarded by the host
+    BMI270_CAPTURE_TRIGGER_ANY_MOTION   ///< BMI270 any-motion feature interrupt
+} bmi270_capture_trigger_t;
+
+/**
+ * @brief Capture state
+ */
+typedef enum {
+    BMI270_CAPTURE_STATE_IDLE = 0,      ///< Not armed, triggers are ignored
+    BMI270_CAPTURE_STATE_ARMED,         ///< FIFO recording paused, waiting for trigger
+    BMI270_CAPTURE_STATE_CAPTURING      ///< FIFO recording in stop-on-full mode
+} bmi270_capture_state_t;
+
+/**
+ * @brief Completed capture window
+ */
+typedef struct {
+    const uint8_t *data;                ///< FIFO window (header-mode frames, valid during callback only)
+    uint16_t length;                    ///< Valid bytes in data
+    uint16_t frame_count;               ///< Sensor frames in the window
+    bmi270_capture_trigger_t trigger;   ///< Trigger source of this window
+    uint32_t sequence;                  ///< Capture sequence number (starts at 0)
+    int64_t trigger_time_us;            ///< Host time when recording started [µs]
+    int64_t drain_time_us;              ///< Host time when the drain completed [µs]
+} bmi270_capture_event_t;
+
+/**
+ * @brief Capture completion callback
+ *
+ * Called from bmi270_capture_service() after the FIFO window has been
+ * drained and before the capture re-arms.
+ */
+typedef void (*bmi270_capture_cb_t)(const bmi270_capture_event_t *event, void *user_ctx);
+
+/**
+ * @brief Capture configuration structure
+ */
+typedef struct {
+    bmi270_int_pin_t int_pin;               ///< Pin for FIFO full (and any-motion) interrupt
+    bool any_motion_trigger;                ///< Also trigger on the any-motion feature
+    bmi270_any_motion_config_t any_motion;  ///< Any-motion settings (used if any_motion_trigger)
+    bool auto_rearm;                        ///< Re-arm after each drained window
+    bmi270_capture_cb_t callback;           ///< Completion callback (required)
+    void *user_ctx;                         ///< User context passed to callback
+} bmi270_capture_config_t;
+
+/**
+ * @brief Capture context
+ *
+ * Holds the drain buffer; allocate statically (about 2 KB).
+ */
+typedef struct {
+    bmi270_dev_t *dev;                      ///< BMI270 device
+    bmi270_capture_config_t config;         ///< Capture configuration
+    volatile bmi270_capture_state_t state;  ///< Current state
+    bmi270_capture_trigger_t trigger;       ///< Trigger source of the running window
+    int64_t trigger_time_us;                ///< Start time of the running window [µs]
+    uint32_t sequence;                      ///< Number of completed windows
+    uint8_t buffer[BMI270_FIFO_SIZE];       ///< Drain buffer
+} bmi270_capture_t;
+
+/**
+ * @brief Initialize capture mode and arm it
+ *
+ * Configures the FIFO (header mode, stop-on-full, recording paused),
+ * maps the FIFO full interrupt and, if requested, the any-motion feature.
+ *
+ * @param[out] cap    Pointer to capture context
+ * @param[in]  dev    Pointer to BMI270 device structure
+ * @param[in]  config Pointer to capture configuration
+ * @return ESP_OK on success, error code otherwise
+ *
+ * @note The interrupt pin must be configured with bmi270_configure_int_pin()
+ */
+esp_err_t bmi270_capture_init(bmi270_capture_t *cap, bmi270_dev_t *dev,
+                              const bmi270_capture_config_t *config);
+
+/**
+ * @brief Arm capture (pause FIFO recording and wait for a trigger)
+ *
+ * @param[in] cap Pointer to capture context
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_capture_arm(bmi270_capture_t *cap);
+
+/**
+ * @brief Disarm capture (pause FIFO recording and ignore triggers)
+ *
+ * @param[in] cap Pointer to capture context
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_capture_disarm(bmi270_capture_t *cap);
+
+/**
+ * @brief Start a capture window from a host or external trigger
+ *
+ * Costs one FIFO flush and one register write; the window is then
+ * recorded by the sensor alone.
+ *
+ * @param[in] cap    Pointer to capture context
+ * @param[in] source BMI270_CAPTURE_TRIGGER_HOST or BMI270_CAPTURE_TRIGGER_EXTERNAL
+ * @return
+ *         - ESP_OK: Recording started
+ *         - ESP_ERR_INVALID_STATE: Not armed (idle or already capturing)
+ *         - Other: SPI error
+ */
+esp_err_t bmi270_capture_trigger(bmi270_capture_t *cap, bmi270_capture_trigger_t source);
+
+/**
+ * @brief Service capture interrupts
+ *
+ * Call from task context whenever the interrupt pin fires. Reads
+ * INT_STATUS_0/1 once, starts recording on an any-motion event and drains
+ * a full FIFO in a single burst, invokes the callback and re-arms.
+ *
+ * @param[in] cap Pointer to capture context
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_capture_service(bmi270_capture_t *cap);
+
+/**
+ * @brief Get current capture state
+ *
+ * @param[in] cap Pointer to capture context
+ * @return Current state (IDLE if cap is NULL)
+ */
+bmi270_capture_state_t bmi270_capture_get_state(const bmi270_capture_t *cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_CAPTURE_H
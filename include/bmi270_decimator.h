@@ -0,0 +1,158 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/**
+ * @file bmi270_decimator.h
+ * @brief BMI270 Integer CIC/Boxcar Decimator API
+ *
+ * Decimates raw ACC+GYR FIFO samples in the integer domain: each input
+ * sample costs six int32 additions per filter stage, and the conversion
+ * to physical units happens once per output sample with a cached scale
+ * (no double-precision math; the ESP32-S3 FPU is single-precision only).
+ *
+ * The filter is a CIC (cascaded integrator-comb) of order 1-3 with unit
+ * differential delay. Order 1 is a boxcar average, which also supports
+ * non-integer ratios (e.g. 1600Hz -> 60Hz alternates 26- and 27-sample
+ * windows). An optional 3-tap FIR at the output rate compensates the CIC
+ * passband droop.
+ *
+ * Typical usage:
+ *   1. bmi270_decimator_init() with the FIFO ODR and the output rate
+ *   2. In the FIFO batch callback: bmi270_decimator_process()
+ *   3. On sync loss or dropped frames: bmi270_decimator_reset()
+ */
+
+#ifndef BMI270_DECIMATOR_H
+#define BMI270_DECIMATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_fifo_stream.h"
+#include "bmi270_data.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ====== Constants ====== */
+
+/** Maximum CIC order */
+#define BMI270_DECIMATOR_MAX_ORDER      3
+
+/** Channels: GYR X/Y/Z, ACC X/Y/Z */
+#define BMI270_DECIMATOR_CHANNELS       6
+
+/** Largest CIC gain (ratio^order) that keeps int16 input within int32 */
+#define BMI270_DECIMATOR_MAX_GAIN       65536U
+
+/* ====== Types ====== */
+
+/**
+ * @brief Decimator configuration structure
+ */
+typedef struct {
+    uint32_t input_rate_hz;     ///< Input sample rate (FIFO ODR) [Hz]
+    uint32_t output_rate_hz;    ///< Output sample rate [Hz] (input/output must be an integer for order >= 2 or compensation)
+    uint8_t order;              ///< CIC order 1-3 (1 = boxcar average)
+    bool compensate;            ///< Apply the 3-tap droop compensation FIR (adds one output sample of delay)
+} bmi270_decimator_config_t;
+
+/**
+ * @brief One decimated output sample
+ */
+typedef struct {
+    bmi270_gyro_t gyr;          ///< Gyroscope [rad/s]
+    bmi270_accel_t acc;         ///< Accelerometer [g]
+    uint16_t sample_index;      ///< Index of the input sample that completed this output (in the processed block)
+} bmi270_decimator_output_t;
+
+/**
+ * @brief Decimator context
+ */
+typedef struct {
+    bmi270_dev_t *dev;                      ///< BMI270 device (range settings)
+    bmi270_decimator_config_t config;       ///< Decimator configuration
+    uint32_t integ[BMI270_DECIMATOR_MAX_ORDER][BMI270_DECIMATOR_CHANNELS];  ///< Integrators (modulo 2^32)
+    uint32_t comb[BMI270_DECIMATOR_MAX_ORDER][BMI270_DECIMATOR_CHANNELS];   ///< Comb delay lines
+    int32_t history[2][BMI270_DECIMATOR_CHANNELS];  ///< Previous CIC outputs (compensation FIR)
+    uint32_t phase;                         ///< Rate accumulator (output_rate_hz per input sample)
+    uint16_t window;                        ///< Input samples in the current window
+    uint16_t window_min;                    ///< floor(input/output)
+    uint8_t warmup;                         ///< Outputs still to discard while the filter settles
+    uint8_t scale_acc_range;                ///< acc_range of the cached scale
+    uint8_t scale_gyr_range;                ///< gyr_range of the cached scale
+    float acc_scale[2];                     ///< Output scale [g per count], window_min and window_min + 1
+    float gyr_scale[2];                     ///< Output scale [rad/s per count], window_min and window_min + 1
+    uint32_t outputs;                       ///< Outputs produced
+    uint32_t dropped_outputs;               ///< Outputs discarded because the output buffer was full
+} bmi270_decimator_t;
+
+/* ====== Decimator Functions ====== */
+
+/**
+ * @brief Initialize decimator
+ *
+ * @param[out] dec    Pointer to decimator context
+ * @param[in]  dev    Pointer to BMI270 device structure (ranges are read on every output)
+ * @param[in]  config Pointer to decimator configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the ratio/order combination
+ *         is not supported (order >= 2 and compensation need an integer ratio,
+ *         ratio^order <= 65536)
+ */
+esp_err_t bmi270_decimator_init(bmi270_decimator_t *dec, bmi270_dev_t *dev,
+                                const bmi270_decimator_config_t *config);
+
+/**
+ * @brief Clear filter state (call after a FIFO discontinuity)
+ *
+ * @param[in] dec Pointer to decimator context
+ */
+void bmi270_decimator_reset(bmi270_decimator_t *dec);
+
+/**
+ * @brief Feed samples and collect decimated outputs
+ *
+ * Outputs that do not fit in the buffer are discarded and counted in
+ * dropped_outputs. A buffer of count / floor(input/output) + 1 entries
+ * is always enough.
+ *
+ * @param[in]  dec       Pointer to decimator context
+ * @param[in]  samples   Input samples (e.g. batch->samples)
+ * @param[in]  count     Number of input samples
+ * @param[out] out       Output buffer
+ * @param[in]  max_out   Capacity of out
+ * @param[out] out_count Number of outputs written
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if outputs were dropped
+ */
+esp_err_t bmi270_decimator_process(bmi270_decimator_t *dec, const bmi270_fifo_sample_t *samples,
+                                   uint16_t count, bmi270_decimator_output_t *out,
+                                   uint16_t max_out, uint16_t *out_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_DECIMATOR_H
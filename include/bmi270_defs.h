@@ -48,6 +48,9 @@ extern "C" {
 #define BMI270_REG_ERR_REG              0x02    // Error register
 #define BMI270_REG_STATUS               0x03    // Status register
 
+/* Auxiliary Sensor Data Registers (AUX_DATA_0..7) */
+#define BMI270_REG_AUX_DATA_0           0x04    // First byte read from the auxiliary sensor
+
 /* Sensor Data Registers */
 #define BMI270_REG_ACC_X_LSB            0x0C    // Accelerometer X-axis LSB
 #define BMI270_REG_ACC_X_MSB            0x0D    // Accelerometer X-axis MSB
@@ -63,6 +66,15 @@ extern "C" {
 #define BMI270_REG_GYR_Z_LSB            0x16    // Gyroscope Z-axis LSB
 #define BMI270_REG_GYR_Z_MSB            0x17    // Gyroscope Z-axis MSB
 
+/* Sensor Time Registers (24-bit, 39.0625µs/LSB) */
+#define BMI270_REG_SENSORTIME_0         0x18    // Sensor time LSB
+#define BMI270_REG_SENSORTIME_1         0x19    // Sensor time middle byte
+#define BMI270_REG_SENSORTIME_2         0x1A    // Sensor time MSB
+
+/* Interrupt Status Registers (clear-on-read) */
+#define BMI270_REG_INT_STATUS_0         0x1C    // Feature engine interrupt status
+#define BMI270_REG_INT_STATUS_1         0x1D    // FIFO / data ready interrupt status
+
 /* Internal Status */
 #define BMI270_REG_INTERNAL_STATUS      0x21    // Internal status register
 
@@ -75,6 +87,10 @@ extern "C" {
 #define BMI270_REG_FIFO_LENGTH_1        0x25    // FIFO length MSB (read-only)
 #define BMI270_REG_FIFO_DATA            0x26    // FIFO data read
 
+/* Feature Engine Registers */
+#define BMI270_REG_FEAT_PAGE            0x2F    // Feature configuration page select
+#define BMI270_REG_FEATURES             0x30    // Feature configuration window (16 bytes)
+
 /* FIFO Configuration Registers */
 #define BMI270_REG_FIFO_DOWNS           0x45    // FIFO downsampling configuration
 #define BMI270_REG_FIFO_WTM_0           0x46    // FIFO watermark threshold LSB
@@ -88,10 +104,21 @@ extern "C" {
 #define BMI270_REG_GYR_CONF             0x42    // Gyroscope configuration
 #define BMI270_REG_GYR_RANGE            0x43    // Gyroscope range
 
+/* Auxiliary Interface Registers */
+#define BMI270_REG_AUX_CONF             0x44    // AUX ODR and read offset
+#define BMI270_REG_AUX_DEV_ID           0x4B    // AUX I2C device address (bits 7:1)
+#define BMI270_REG_AUX_IF_CONF          0x4C    // AUX interface configuration
+#define BMI270_REG_AUX_RD_ADDR          0x4D    // AUX read address (starts a read in manual mode)
+#define BMI270_REG_AUX_WR_ADDR          0x4E    // AUX write address (starts a write in manual mode)
+#define BMI270_REG_AUX_WR_DATA          0x4F    // AUX write data
+
 /* Interrupt Configuration Registers */
+#define BMI270_REG_ERR_REG_MSK          0x52    // Error interrupt mask
 #define BMI270_REG_INT1_IO_CTRL         0x53    // INT1 pin configuration
 #define BMI270_REG_INT2_IO_CTRL         0x54    // INT2 pin configuration
 #define BMI270_REG_INT_LATCH            0x55    // Interrupt latch configuration
+#define BMI270_REG_INT1_MAP_FEAT        0x56    // Feature interrupt mapping to INT1
+#define BMI270_REG_INT2_MAP_FEAT        0x57    // Feature interrupt mapping to INT2
 #define BMI270_REG_INT_MAP_DATA         0x58    // Data Ready interrupt mapping
 
 /* Initialization Registers */
@@ -100,6 +127,15 @@ extern "C" {
 #define BMI270_REG_INIT_ADDR_1          0x5C    // Init address MSB
 #define BMI270_REG_INIT_DATA            0x5E    // Init data register
 
+/* Interface Configuration */
+#define BMI270_REG_IF_CONF              0x6B    // Serial interface configuration
+#define BMI270_REG_DRV                  0x6C    // Pad drive strength
+#define BMI270_REG_NV_CONF              0x70    // SPI/I2C interface options (NVM backed)
+
+/* Offset Compensation Registers */
+#define BMI270_REG_OFFSET_0             0x71    // ACC X offset (OFFSET_0..OFFSET_6 = 0x71..0x77)
+#define BMI270_REG_OFFSET_6             0x77    // GYR offset MSBs and offset enables
+
 /* Power Registers */
 #define BMI270_REG_PWR_CONF             0x7C    // Power configuration
 #define BMI270_REG_PWR_CTRL             0x7D    // Power control
@@ -137,6 +173,27 @@ extern "C" {
 #define BMI270_PWR_CTRL_ACC_EN          (1 << 2)    // Enable accelerometer
 #define BMI270_PWR_CTRL_TEMP_EN         (1 << 3)    // Enable temperature sensor
 
+/* STATUS Register Bits */
+#define BMI270_STATUS_AUX_BUSY          (1 << 2)    // AUX interface operation in progress
+
+/* IF_CONF Register Bits */
+#define BMI270_IF_CONF_AUX_EN           (1 << 5)    // Enable AUX I2C master on the AUX pins
+
+/* AUX_IF_CONF Register Bits */
+#define BMI270_AUX_RD_BURST_MASK        0x03        // aux_rd_burst<1:0> (data mode burst length)
+#define BMI270_AUX_MAN_RD_BURST_SHIFT   2           // man_rd_burst<3:2> (manual mode burst length)
+#define BMI270_AUX_FCU_WRITE_EN         (1 << 6)    // Write AUX_WR_DATA to AUX_WR_ADDR before each data mode read
+#define BMI270_AUX_MANUAL_EN            (1 << 7)    // Manual mode (host-issued AUX transfers)
+
+/* AUX_CONF Register Fields */
+#define BMI270_AUX_ODR_MASK             0x0F        // aux_odr<3:0> (same coding as ACC ODR, max 800Hz)
+#define BMI270_AUX_OFFSET_SHIFT         4           // aux_offset<7:4> (read trigger delay)
+#define BMI270_AUX_OFFSET_MASK          0x0F        // aux_offset field width (before shifting)
+
+/* AUX Timing */
+#define BMI270_AUX_BUSY_POLL_US         100         // AUX busy poll interval
+#define BMI270_AUX_BUSY_TIMEOUT_US      10000       // AUX transfer timeout
+
 /* Commands */
 #define BMI270_CMD_SOFT_RESET           0xB6    // Soft reset command
 #define BMI270_CMD_FIFO_FLUSH           0xB0    // FIFO flush command
@@ -192,11 +249,34 @@ extern "C" {
 #define BMI270_INT_LATCH_ENABLED        0x01        // Latched mode
 
 /* INT_MAP_DATA Register Bits */
+#define BMI270_FIFO_FULL_INT1           (1 << 0)    // Map FIFO Full to INT1
 #define BMI270_FIFO_WM_INT1             (1 << 1)    // Map FIFO Watermark to INT1
 #define BMI270_DRDY_INT1                (1 << 2)    // Map Data Ready to INT1
+#define BMI270_FIFO_FULL_INT2           (1 << 4)    // Map FIFO Full to INT2
 #define BMI270_FIFO_WM_INT2             (1 << 5)    // Map FIFO Watermark to INT2
 #define BMI270_DRDY_INT2                (1 << 6)    // Map Data Ready to INT2
 
+/* INT1_MAP_FEAT / INT2_MAP_FEAT Register Bits */
+#define BMI270_FEAT_ANY_MOTION_INT      (1 << 6)    // Map any-motion feature interrupt
+
+/* INT_STATUS_0 Register Bits */
+#define BMI270_INT_STATUS_ANY_MOTION    (1 << 6)    // Any-motion detected
+
+/* INT_STATUS_1 Register Bits */
+#define BMI270_INT_STATUS_FFULL         (1 << 0)    // FIFO full
+#define BMI270_INT_STATUS_FWM           (1 << 1)    // FIFO watermark reached
+#define BMI270_INT_STATUS_ERR           (1 << 2)    // Error interrupt
+#define BMI270_INT_STATUS_GYR_DRDY      (1 << 6)    // Gyroscope data ready
+#define BMI270_INT_STATUS_ACC_DRDY      (1 << 7)    // Accelerometer data ready
+
+/* Any-Motion Feature Configuration (feature page 1, offset 0x0C) */
+#define BMI270_FEAT_PAGE_ANY_MOTION     1           // Feature page holding any-motion config
+#define BMI270_FEAT_ANY_MOTION_OFFSET   0x0C        // Byte offset inside the feature window
+#define BMI270_ANY_MOTION_DURATION_MASK 0x1FFF      // any_motion_1: duration [20ms/LSB]
+#define BMI270_ANY_MOTION_SEL_XYZ       0xE000      // any_motion_1: select X/Y/Z axes
+#define BMI270_ANY_MOTION_THRESHOLD_MASK 0x07FF     // any_motion_2: threshold [0.48mg/LSB]
+#define BMI270_ANY_MOTION_ENABLE        0x8000      // any_motion_2: enable
+
 /* FIFO_CONFIG_0 Register Bits */
 #define BMI270_FIFO_STOP_ON_FULL        (1 << 0)    // FIFO stops on full (1) or overwrites (0)
 
@@ -204,6 +284,7 @@ extern "C" {
 #define BMI270_FIFO_ACC_EN              (1 << 6)    // Enable accelerometer data in FIFO
 #define BMI270_FIFO_GYR_EN              (1 << 7)    // Enable gyroscope data in FIFO
 #define BMI270_FIFO_HEADER_EN           (1 << 4)    // Enable frame headers in FIFO
+#define BMI270_FIFO_AUX_EN              (1 << 5)    // Enable auxiliary sensor data in FIFO
 
 /* FIFO Frame Headers (Header Mode) */
 #define BMI270_FIFO_HEAD_SKIP           0x40        // Skip frame
@@ -212,12 +293,29 @@ extern "C" {
 #define BMI270_FIFO_HEAD_ACC            0x84        // Accelerometer frame (0b10000100)
 #define BMI270_FIFO_HEAD_GYR            0x88        // Gyroscope frame (0b10001000)
 #define BMI270_FIFO_HEAD_ACC_GYR        0x8C        // Accelerometer + Gyroscope frame (0b10001100)
+#define BMI270_FIFO_HEAD_OVER_READ      0x80        // Returned when reading past the FIFO fill level
+
+/* FIFO Header Fields */
+#define BMI270_FIFO_HEAD_MODE_MASK      0xC0        // fh_mode<1:0>
+#define BMI270_FIFO_HEAD_MODE_REGULAR   0x80        // Regular frame (sensor data)
+#define BMI270_FIFO_HEAD_MODE_CONTROL   0x40        // Control frame (metadata)
+#define BMI270_FIFO_HEAD_EXT_MASK       0x03        // fh_ext<1:0> (INT1/INT2 tags)
+#define BMI270_FIFO_HEAD_ACC_BIT        0x04        // Regular frame contains accelerometer data
+#define BMI270_FIFO_HEAD_GYR_BIT        0x08        // Regular frame contains gyroscope data
+#define BMI270_FIFO_HEAD_AUX_BIT        0x10        // Regular frame contains auxiliary data
 
 /* FIFO Constants */
 #define BMI270_FIFO_SIZE                2048        // FIFO hardware buffer size (bytes)
+#define BMI270_FIFO_LENGTH_MASK         0x3FFF      // FIFO_LENGTH valid bits
+#define BMI270_FIFO_WTM_MSB_MASK        0x1F        // FIFO_WTM_1 valid bits
 #define BMI270_FIFO_FRAME_ACC_SIZE      7           // Accelerometer frame size (1 header + 6 data)
 #define BMI270_FIFO_FRAME_GYR_SIZE      7           // Gyroscope frame size (1 header + 6 data)
 #define BMI270_FIFO_FRAME_ACC_GYR_SIZE  13          // Accel+Gyro frame size (1 header + 6 acc + 6 gyr)
+#define BMI270_FIFO_FRAME_ACC_GYR_AUX_SIZE 21        // Accel+Gyro+Aux frame size (1 header + 8 aux + 6 gyr + 6 acc)
+#define BMI270_FIFO_AUX_PAYLOAD         8           // Auxiliary payload per frame (AUX_DATA_0..7)
+#define BMI270_FIFO_SKIP_PAYLOAD        1           // Skip frame payload (number of dropped frames)
+#define BMI270_FIFO_SENSOR_TIME_PAYLOAD 3           // Sensor time frame payload (24-bit time)
+#define BMI270_FIFO_CONFIG_PAYLOAD      4           // Config change frame payload
 
 
 #ifdef __cplusplus
@@ -0,0 +1,190 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_envelope.h
+ * @brief BMI270 Peak-Preserving Telemetry Downsampler API
+ *
+ * Averaging a window of samples into one telemetry point (as the
+ * decimator does) hides exactly the short transients that matter when
+ * tuning live. This downsampler reduces the full-rate FIFO stream to one
+ * record per window and per axis that keeps them visible:
+ *
+ *   - BMI270_ENVELOPE_MINMAX: min, max and mean of the window, plus the
+ *     extreme sample (min or max, whichever is farther from the mean) as
+ *     a single representative point. No delay.
+ *   - BMI270_ENVELOPE_LTTB: streaming largest-triangle-three-buckets. The
+ *     point is the sample of the window that forms the largest triangle
+ *     with the previously selected point and the mean of the next window,
+ *     which follows the shape of the signal better than the extreme.
+ *     Outputs lag one window; min/max/mean refer to the same window.
+ *
+ * Work per input sample is integer only (compare and add per axis; LTTB
+ * also stores the sample). Conversion to physical units happens once per
+ * output with a cached scale that follows range changes.
+ *
+ * Typical usage:
+ *   1. bmi270_envelope_init() with the FIFO ODR and the telemetry rate
+ *   2. In the FIFO batch callback: bmi270_envelope_process()
+ *   3. On sync loss or dropped frames: bmi270_envelope_reset()
+ */
+
+#ifndef BMI270_ENVELOPE_H
+#define BMI270_ENVELOPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_fifo_stream.h"
+#include "bmi270_data.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ====== Constants ====== */
+
+/** Channels: GYR X/Y/Z, ACC X/Y/Z */
+#define BMI270_ENVELOPE_CHANNELS        6
+
+/** Largest window (input samples per output), e.g. 1600Hz -> 12.5Hz */
+#define BMI270_ENVELOPE_MAX_WINDOW      128
+
+/* ====== Types ====== */
+
+/**
+ * @brief Representative point selection
+ */
+typedef enum {
+    BMI270_ENVELOPE_MINMAX = 0,     ///< Min/max/mean; point = extreme sample (no delay)
+    BMI270_ENVELOPE_LTTB,           ///< Min/max/mean; point = largest triangle (one window delay)
+} bmi270_envelope_mode_t;
+
+/**
+ * @brief Downsampler configuration structure
+ */
+typedef struct {
+    bmi270_envelope_mode_t mode;    ///< Point selection
+    uint32_t input_rate_hz;         ///< Input sample rate (FIFO ODR) [Hz]
+    uint32_t output_rate_hz;        ///< Output rate [Hz] (input/output must be an integer, 2 to BMI270_ENVELOPE_MAX_WINDOW)
+} bmi270_envelope_config_t;
+
+/**
+ * @brief Envelope of one channel over one window
+ */
+typedef struct {
+    float min;                  ///< Smallest sample
+    float max;                  ///< Largest sample
+    float mean;                 ///< Window average
+    float point;                ///< Representative sample (see bmi270_envelope_mode_t)
+    uint16_t point_offset;      ///< Position of point in the window (0 = oldest)
+} bmi270_envelope_channel_t;
+
+/**
+ * @brief One downsampled output (GYR X/Y/Z [rad/s], ACC X/Y/Z [g])
+ */
+typedef struct {
+    bmi270_envelope_channel_t ch[BMI270_ENVELOPE_CHANNELS];    ///< GYR X/Y/Z, ACC X/Y/Z
+    uint32_t window;            ///< Window number since reset (the window described)
+    uint16_t sample_index;      ///< Index of the input sample that completed this output (in the processed block)
+} bmi270_envelope_output_t;
+
+/**
+ * @brief Raw statistics of one window
+ */
+typedef struct {
+    int16_t min[BMI270_ENVELOPE_CHANNELS];      ///< Smallest sample [LSB]
+    int16_t max[BMI270_ENVELOPE_CHANNELS];      ///< Largest sample [LSB]
+    int32_t sum[BMI270_ENVELOPE_CHANNELS];      ///< Sum of the samples [LSB]
+    uint16_t min_at[BMI270_ENVELOPE_CHANNELS];  ///< Offset of the first minimum
+    uint16_t max_at[BMI270_ENVELOPE_CHANNELS];  ///< Offset of the first maximum
+} bmi270_envelope_window_t;
+
+/**
+ * @brief Downsampler context (about 3.3KB; allocate statically)
+ */
+typedef struct {
+    bmi270_dev_t *dev;                      ///< BMI270 device (range settings)
+    bmi270_envelope_config_t config;        ///< Configuration
+    uint16_t window_len;                    ///< Input samples per output
+    uint16_t fill;                          ///< Samples in the current window
+    uint32_t windows;                       ///< Windows completed since reset
+    bmi270_envelope_window_t current;       ///< Window being filled
+    bmi270_envelope_window_t pending;       ///< LTTB: completed window waiting for the next one
+    bool has_pending;                       ///< LTTB: pending is valid
+    int16_t bucket[2][BMI270_ENVELOPE_MAX_WINDOW][BMI270_ENVELOPE_CHANNELS];  ///< LTTB: samples of current/pending window
+    uint8_t bucket_current;                 ///< LTTB: bucket being filled
+    int16_t anchor[BMI270_ENVELOPE_CHANNELS];       ///< LTTB: last selected point [LSB]
+    int32_t anchor_pos[BMI270_ENVELOPE_CHANNELS];   ///< LTTB: its position relative to the pending window (half samples)
+    uint8_t scale_acc_range;                ///< acc_range of the cached scale
+    uint8_t scale_gyr_range;                ///< gyr_range of the cached scale
+    float scale[BMI270_ENVELOPE_CHANNELS];  ///< Output scale per LSB
+    uint32_t outputs;                       ///< Outputs produced
+    uint32_t dropped_outputs;               ///< Outputs discarded because the output buffer was full
+} bmi270_envelope_t;
+
+/* ====== Downsampler Functions ====== */
+
+/**
+ * @brief Initialize downsampler
+ *
+ * @param[out] env    Pointer to downsampler context
+ * @param[in]  dev    Pointer to BMI270 device structure (ranges are read on every output)
+ * @param[in]  config Pointer to downsampler configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the ratio is not an integer
+ *         from 2 to BMI270_ENVELOPE_MAX_WINDOW
+ */
+esp_err_t bmi270_envelope_init(bmi270_envelope_t *env, bmi270_dev_t *dev,
+                               const bmi270_envelope_config_t *config);
+
+/**
+ * @brief Drop the partial window and LTTB history (call after a FIFO discontinuity)
+ *
+ * @param[in] env Pointer to downsampler context
+ */
+void bmi270_envelope_reset(bmi270_envelope_t *env);
+
+/**
+ * @brief Feed samples and collect downsampled outputs
+ *
+ * Outputs that do not fit in the buffer are discarded and counted in
+ * dropped_outputs. A buffer of count / window + 1 entries is always enough.
+ *
+ * @param[in]  env       Pointer to downsampler context
+ * @param[in]  samples   Input samples (e.g. batch->samples)
+ * @param[in]  count     Number of input samples
+ * @param[out] out       Output buffer
+ * @param[in]  max_out   Capacity of out
+ * @param[out] out_count Number of outputs written
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if outputs were dropped
+ */
+esp_err_t bmi270_envelope_process(bmi270_envelope_t *env, const bmi270_fifo_sample_t *samples,
+                                  uint16_t count, bmi270_envelope_output_t *out,
+                                  uint16_t max_out, uint16_t *out_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_ENVELOPE_H
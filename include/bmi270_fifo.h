@@ -0,0 +1,192 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_fifo.h
+ * @brief BMI270 FIFO API
+ *
+ * This file provides functions for configuring the BMI270 FIFO, reading
+ * its contents in a single burst transaction, and parsing header-mode
+ * FIFO frames.
+ */
+
+#ifndef BMI270_FIFO_H
+#define BMI270_FIFO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_data.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief FIFO configuration structure
+ */
+typedef struct {
+    bool acc_enable;        ///< Store accelerometer data in FIFO
+    bool gyr_enable;        ///< Store gyroscope data in FIFO
+    bool aux_enable;        ///< Store auxiliary sensor data in FIFO (see bmi270_aux.h)
+    bool header_enable;     ///< Header mode (required by bmi270_fifo_parser_next())
+    bool stop_on_full;      ///< true = FIFO mode (stop when full), false = Stream mode (overwrite)
+    uint16_t watermark;     ///< Watermark level [bytes] (0-2047)
+} bmi270_fifo_config_t;
+
+/**
+ * @brief FIFO frame type (header mode)
+ */
+typedef enum {
+    BMI270_FIFO_FRAME_SENSOR = 0,       ///< Regular frame with accelerometer, gyroscope and/or auxiliary data
+    BMI270_FIFO_FRAME_SKIP,             ///< Skip frame (frames dropped on overrun)
+    BMI270_FIFO_FRAME_SENSOR_TIME,      ///< Sensor time frame
+    BMI270_FIFO_FRAME_CONFIG_CHANGE     ///< Configuration change frame
+} bmi270_fifo_frame_type_t;
+
+/**
+ * @brief One parsed FIFO frame
+ */
+typedef struct {
+    bmi270_fifo_frame_type_t type;  ///< Frame type
+    uint8_t header;                 ///< Raw frame header byte
+    bool has_acc;                   ///< acc field is valid (SENSOR frames)
+    bool has_gyr;                   ///< gyr field is valid (SENSOR frames)
+    bool has_aux;                   ///< aux field is valid (SENSOR frames)
+    bmi270_raw_data_t acc;          ///< Raw accelerometer sample [LSB]
+    bmi270_raw_data_t gyr;          ///< Raw gyroscope sample [LSB]
+    uint8_t aux[BMI270_FIFO_AUX_PAYLOAD];   ///< Raw auxiliary payload (AUX_DATA_0..7, sensor specific)
+    uint32_t value;                 ///< Skipped frame count (SKIP) or 24-bit sensor time (SENSOR_TIME)
+} bmi270_fifo_frame_t;
+
+/**
+ * @brief FIFO frame parser state
+ *
+ * Iterates over a buffer read from FIFO_DATA without copying it.
+ */
+typedef struct {
+    const uint8_t *data;    ///< FIFO data buffer
+    uint16_t length;        ///< Buffer length in bytes
+    uint16_t offset;        ///< Offset of the next frame header
+} bmi270_fifo_parser_t;
+
+/* ====== FIFO Configuration Functions ====== */
+
+/**
+ * @brief Configure FIFO mode, enabled sensors and watermark
+ *
+ * Writes FIFO_WTM_0, FIFO_WTM_1, FIFO_CONFIG_0 and FIFO_CONFIG_1 in a single
+ * burst write transaction.
+ *
+ * @param[in] dev    Pointer to BMI270 device structure
+ * @param[in] config Pointer to FIFO configuration structure
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_configure(bmi270_dev_t *dev, const bmi270_fifo_config_t *config);
+
+/**
+ * @brief Set FIFO watermark level
+ *
+ * @param[in] dev       Pointer to BMI270 device structure
+ * @param[in] watermark Watermark level [bytes] (0-2047)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_set_watermark(bmi270_dev_t *dev, uint16_t watermark);
+
+/**
+ * @brief Enable or disable sensor data in FIFO without touching other settings
+ *
+ * Rewrites FIFO_CONFIG_1 only (the AUX enable bit is preserved). Disabling
+ * both sensors freezes the FIFO contents when AUX is not stored.
+ *
+ * @param[in] dev        Pointer to BMI270 device structure
+ * @param[in] acc_enable Store accelerometer data in FIFO
+ * @param[in] gyr_enable Store gyroscope data in FIFO
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_set_sensors(bmi270_dev_t *dev, bool acc_enable, bool gyr_enable);
+
+/**
+ * @brief Flush FIFO (discard all stored frames)
+ *
+ * @param[in] dev Pointer to BMI270 device structure
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_flush(bmi270_dev_t *dev);
+
+/* ====== FIFO Reading Functions ====== */
+
+/**
+ * @brief Read current FIFO fill level
+ *
+ * @param[in]  dev    Pointer to BMI270 device structure
+ * @param[out] length Number of bytes stored in FIFO (0-2048)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_get_length(bmi270_dev_t *dev, uint16_t *length);
+
+/**
+ * @brief Read FIFO data in a single burst transaction
+ *
+ * Reading past the fill level is allowed; the sensor returns
+ * BMI270_FIFO_HEAD_OVER_READ (0x80) for the missing bytes, which the
+ * parser treats as end of data.
+ *
+ * @param[in]  dev    Pointer to BMI270 device structure
+ * @param[out] buffer Buffer for FIFO data
+ * @param[in]  length Number of bytes to read (1-2048)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_read(bmi270_dev_t *dev, uint8_t *buffer, uint16_t length);
+
+/* ====== FIFO Parsing Functions ====== */
+
+/**
+ * @brief Initialize FIFO frame parser
+ *
+ * @param[out] parser Pointer to parser state
+ * @param[in]  data   FIFO data buffer (header mode)
+ * @param[in]  length Buffer length in bytes
+ */
+void bmi270_fifo_parser_init(bmi270_fifo_parser_t *parser, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Parse next FIFO frame
+ *
+ * @param[in,out] parser Pointer to parser state
+ * @param[out]    frame  Pointer to parsed frame
+ * @return
+ *         - ESP_OK: Frame parsed
+ *         - ESP_ERR_NOT_FOUND: End of data (buffer end, over-read marker or truncated frame)
+ *         - ESP_ERR_INVALID_RESPONSE: Unknown header (frame sync lost, flush FIFO to recover)
+ *
+ * @note parser->offset is the number of bytes consumed so far
+ */
+esp_err_t bmi270_fifo_parser_next(bmi270_fifo_parser_t *parser, bmi270_fifo_frame_t *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_FIFO_H
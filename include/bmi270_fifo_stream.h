@@ -0,0 +1,260 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_fifo_stream.h
+ * @brief BMI270 FIFO Stream Engine API
+ *
+ * This file provides a watermark-driven FIFO streaming engine. Each drain
+ * reads the FIFO fill level and the latched interrupt status in one burst,
+ * drains the FIFO in a second burst, parses the frames into a sample batch
+ * and hands it to a callback.
+ *
+ * The engine keeps per-stream statistics (frame counts by type, bytes per
+ * drain, fill level relative to watermark, watermark-to-drain latency,
+ * overflows and lost frames). Statistics are published once per drain and
+ * can be read from any task without locking via
+ * bmi270_fifo_stream_get_stats().
+ *
+ * Batches can be lent to consumers without copying by attaching a
+ * reference-counted buffer pool (see bmi270_batch_pool.h).
+ */
+
+#ifndef BMI270_FIFO_STREAM_H
+#define BMI270_FIFO_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_fifo.h"
+#include "bmi270_interrupt.h"
+#include "bmi270_spike.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ====== Constants ====== */
+
+/** Maximum number of ACC+GYR samples in one full FIFO */
+#define BMI270_FIFO_MAX_SAMPLES         (BMI270_FIFO_SIZE / BMI270_FIFO_FRAME_ACC_GYR_SIZE + 1)
+
+/** Maximum number of AUX samples in one full FIFO (AUX ODR <= ACC/GYR ODR) */
+#define BMI270_FIFO_MAX_AUX_SAMPLES     (BMI270_FIFO_SIZE / BMI270_FIFO_FRAME_ACC_GYR_AUX_SIZE + 1)
+
+/** Bytes-per-drain histogram: 128-byte bins over 0-2048 bytes */
+#define BMI270_FIFO_STATS_BYTES_BINS    16
+#define BMI270_FIFO_STATS_BYTES_BIN_SIZE 128
+
+/** Fill-at-drain histogram: 25% of watermark per bin, last bin collects >= 375% */
+#define BMI270_FIFO_STATS_FILL_BINS     16
+#define BMI270_FIFO_STATS_FILL_BIN_PCT  25
+
+/** Watermark-to-drain latency histogram: bin k counts [2^k, 2^(k+1)) µs, bin 0 includes 0 */
+#define BMI270_FIFO_STATS_LATENCY_BINS  20
+
+/* ====== Types ====== */
+
+struct bmi270_batch_buf;
+struct bmi270_batch_pool;
+
+/**
+ * @brief One ACC+GYR sample from the FIFO (raw LSB)
+ */
+typedef struct {
+    bmi270_raw_data_t gyr;      ///< Gyroscope [LSB]
+    bmi270_raw_data_t acc;      ///< Accelerometer [LSB]
+} bmi270_fifo_sample_t;
+
+/**
+ * @brief One AUX sample from the FIFO (raw, sensor specific)
+ */
+typedef struct {
+    uint8_t data[BMI270_FIFO_AUX_PAYLOAD];  ///< AUX_DATA_0..7 (e.g. BMM150 0x42-0x49)
+    uint16_t sample_index;      ///< Index of the ACC+GYR sample stored in the same frame (shared time base)
+} bmi270_fifo_aux_sample_t;
+
+/**
+ * @brief Parsed FIFO batch (one drain)
+ */
+typedef struct {
+    bmi270_fifo_sample_t samples[BMI270_FIFO_MAX_SAMPLES];  ///< Samples in FIFO order (oldest first)
+    uint16_t sample_count;      ///< Number of valid samples
+    bmi270_fifo_aux_sample_t aux_samples[BMI270_FIFO_MAX_AUX_SAMPLES];  ///< AUX samples (oldest first)
+    uint16_t aux_count;         ///< Number of valid AUX samples
+    uint16_t fifo_length;       ///< FIFO fill level at drain [bytes]
+    uint16_t lost_frames;       ///< Frames dropped by the sensor before this batch (skip frames)
+    bool sync_lost;             ///< Unknown header found; FIFO was flushed
+    uint32_t sequence;          ///< Drain sequence number
+    int64_t drain_time_us;      ///< Host time when the drain completed [µs]
+    const uint8_t *raw;         ///< FIFO bytes of this drain (fifo_length bytes, same lifetime as the batch)
+    struct bmi270_batch_buf *owner;     ///< Pool buffer holding this batch (NULL = internal batch, valid during the callback only)
+} bmi270_fifo_batch_t;
+
+/**
+ * @brief Batch callback, called from bmi270_fifo_stream_drain()
+ */
+typedef void (*bmi270_fifo_batch_cb_t)(const bmi270_fifo_batch_t *batch, void *user_ctx);
+
+/**
+ * @brief FIFO stream statistics
+ */
+typedef struct {
+    uint32_t watermark_events;      ///< Watermark triggers (ISR notifications or drain_length calls)
+    uint32_t drains;                ///< Completed drains
+    uint32_t empty_drains;          ///< Drains that found no complete frame
+    uint32_t drain_errors;          ///< Drains aborted by SPI errors, or whose sync-loss flush failed
+    uint32_t sensor_frames;         ///< Regular (ACC/GYR/AUX) frames
+    uint32_t aux_frames;            ///< Regular frames carrying AUX data
+    uint32_t skip_frames;           ///< Skip frames
+    uint32_t sensor_time_frames;    ///< Sensor time frames
+    uint32_t config_frames;         ///< Config change frames
+    uint32_t sync_losses;           ///< Unknown headers (FIFO flushed)
+    uint32_t overflow_events;       ///< Drains that reported dropped frames
+    uint32_t lost_frames;           ///< Total frames dropped by the sensor
+    uint32_t spike_rejected;        ///< Samples with axes replaced by the spike filter
+    uint64_t bytes_total;           ///< Total bytes drained
+    uint16_t bytes_max;             ///< Largest drain [bytes]
+    uint32_t latency_max_us;        ///< Worst watermark-to-drain latency [µs]
+    uint32_t bytes_hist[BMI270_FIFO_STATS_BYTES_BINS];      ///< Bytes per drain
+    uint32_t fill_hist[BMI270_FIFO_STATS_FILL_BINS];        ///< Fill at drain relative to watermark
+    uint32_t latency_hist[BMI270_FIFO_STATS_LATENCY_BINS];  ///< Watermark-to-drain latency
+} bmi270_fifo_stats_t;
+
+/**
+ * @brief FIFO stream configuration structure
+ */
+typedef struct {
+    uint16_t watermark;             ///< Watermark level [bytes] (multiple of 13 recommended)
+    bmi270_int_pin_t int_pin;       ///< Pin for the watermark interrupt
+    bool aux_enable;                ///< Also store AUX data (configure with bmi270_aux_init() first)
+    bmi270_fifo_batch_cb_t callback;    ///< Batch callback (may be NULL)
+    void *user_ctx;                 ///< User context passed to callback
+    bmi270_spike_filter_t *spike_filter;    ///< Spike filter applied to every sample (may be NULL)
+    struct bmi270_batch_pool *pool; ///< Lend batches from this pool (NULL = internal batch, reused every drain)
+} bmi270_fifo_stream_config_t;
+
+/**
+ * @brief FIFO stream context
+ *
+ * Holds the drain buffer and the batch (about 5 KB); allocate statically.
+ */
+typedef struct {
+    bmi270_dev_t *dev;                      ///< BMI270 device
+    bmi270_fifo_stream_config_t config;     ///< Stream configuration
+    volatile uint32_t isr_time_us;          ///< Last watermark ISR time (lower 32 bits) [µs]
+    volatile uint32_t isr_count;            ///< Watermark ISR count
+    uint32_t isr_count_seen;                ///< ISR count at previous drain
+    uint8_t buffer[BMI270_FIFO_SIZE];       ///< Drain buffer
+    bmi270_fifo_batch_t batch;              ///< Batch passed to callback
+    bmi270_fifo_stats_t stats_work;         ///< Statistics (drain task only)
+    bmi270_fifo_stats_t stats_published;    ///< Statistics snapshot source
+    atomic_uint stats_seq;                  ///< Sequence counter (odd while publishing)
+} bmi270_fifo_stream_t;
+
+/* ====== Stream Functions ====== */
+
+/**
+ * @brief Initialize FIFO stream
+ *
+ * Configures the FIFO (ACC+GYR[+AUX], header mode, stream mode, watermark),
+ * flushes it and maps the watermark interrupt.
+ *
+ * @param[out] stream Pointer to stream context
+ * @param[in]  dev    Pointer to BMI270 device structure
+ * @param[in]  config Pointer to stream configuration
+ * @return ESP_OK on success, error code otherwise
+ *
+ * @note The interrupt pin must be configured with bmi270_configure_int_pin()
+ */
+esp_err_t bmi270_fifo_stream_init(bmi270_fifo_stream_t *stream, bmi270_dev_t *dev,
+                                  const bmi270_fifo_stream_config_t *config);
+
+/**
+ * @brief Record a watermark interrupt (ISR safe)
+ *
+ * Call from the GPIO ISR before waking the drain task. Used for the
+ * watermark-to-drain latency histogram.
+ *
+ * @param[in] stream Pointer to stream context
+ */
+void bmi270_fifo_stream_notify_from_isr(bmi270_fifo_stream_t *stream);
+
+/**
+ * @brief Drain FIFO, parse the batch and invoke the callback
+ *
+ * Uses two SPI transactions: INT_STATUS_1..FIFO_LENGTH (also clears a
+ * latched interrupt) and the FIFO data burst.
+ *
+ * On sync loss the FIFO is flushed (one retry). If the flush fails the
+ * batch is still delivered with sync_lost set, and its error is returned.
+ *
+ * @param[in] stream Pointer to stream context
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_stream_drain(bmi270_fifo_stream_t *stream);
+
+/**
+ * @brief Drain FIFO whose length the caller has already read
+ *
+ * For callers that fetch FIFO_LENGTH as part of a larger status burst
+ * (e.g. the hybrid acquisition mode). Issues only the FIFO data burst;
+ * latency is measured from event_time_us and counted as a watermark event.
+ *
+ * @param[in] stream        Pointer to stream context
+ * @param[in] fifo_length   FIFO fill level [bytes] (FIFO_LENGTH_0/1)
+ * @param[in] event_time_us Time of the triggering interrupt (lower 32 bits of esp_timer_get_time()) [µs]
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_fifo_stream_drain_length(bmi270_fifo_stream_t *stream, uint16_t fifo_length,
+                                          uint32_t event_time_us);
+
+/**
+ * @brief Get a consistent statistics snapshot (lock-free)
+ *
+ * May be called from any task while the drain task is running.
+ *
+ * @param[in]  stream   Pointer to stream context
+ * @param[out] snapshot Pointer to statistics copy
+ * @return
+ *         - ESP_OK: Snapshot copied
+ *         - ESP_ERR_TIMEOUT: Publisher was active on every retry (try again later)
+ */
+esp_err_t bmi270_fifo_stream_get_stats(bmi270_fifo_stream_t *stream, bmi270_fifo_stats_t *snapshot);
+
+/**
+ * @brief Reset statistics
+ *
+ * Must be called from the drain task (or while it is stopped).
+ *
+ * @param[in] stream Pointer to stream context
+ */
+void bmi270_fifo_stream_reset_stats(bmi270_fifo_stream_t *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_FIFO_STREAM_H
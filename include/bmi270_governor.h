@@ -0,0 +1,238 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_governor.h
+ * @brief BMI270 Deadline-Aware Load Governor API
+ *
+ * When telemetry, logging and diagnostics run in the same batch callback
+ * as the rate-critical path, one slow stage (e.g. a flash write) delays
+ * the next drain and the FIFO overflows. The governor runs the stages of
+ * the callback against a per-batch deadline and sheds non-critical work
+ * first:
+ *
+ *   - Deadline: the next watermark is due watermark / ODR after the
+ *     current one. The budget is budget_percent of that period, minus
+ *     the time already spent since the watermark (ISR timestamp from
+ *     bmi270_fifo_stream_notify_from_isr(), or the FIFO fill above the
+ *     watermark).
+ *   - Stages run in class order: CRITICAL, LOGGING, METRICS, TELEMETRY.
+ *     A non-critical stage is admitted only if its cost estimate (a
+ *     decaying peak of its measured run times) fits in what is left of
+ *     the budget. Once one class is cut, all lower classes are cut for
+ *     that batch, so telemetry is shed first, then metrics, then logging.
+ *     CRITICAL stages always run.
+ *   - A stage marked deferrable keeps a reference to the batch (needs a
+ *     batch pool on the stream, see bmi270_batch_pool.h) and runs it
+ *     later when a batch leaves slack above the cut; without a pool the
+ *     work is shed.
+ *     Each held batch occupies a pool buffer, so at most max_retained
+ *     batches are held across all stages (default: pool size - 1, which
+ *     leaves the next drain a buffer). A stage whose queue is full, or
+ *     that meets the limit, drops its own oldest deferred batch; a stage
+ *     with nothing queued sheds instead.
+ *   - A batch reporting sync loss flushes all deferred batches: the
+ *     samples before the resync are stale and their buffers are needed.
+ *
+ * Set bmi270_governor_batch_cb() as the stream callback with the governor
+ * as user_ctx. All stages run in the drain task.
+ */
+
+#ifndef BMI270_GOVERNOR_H
+#define BMI270_GOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_fifo_stream.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ====== Constants ====== */
+
+/** Maximum number of stages */
+#define BMI270_GOVERNOR_MAX_STAGES      8
+
+/** Deferred batches kept per stage */
+#define BMI270_GOVERNOR_MAX_DEFERRED    4
+
+/** Default budget: share of the watermark period for the callback [%] */
+#define BMI270_GOVERNOR_DEFAULT_BUDGET  75
+
+/* ====== Types ====== */
+
+/**
+ * @brief Stage class (run order; shed in reverse)
+ */
+typedef enum {
+    BMI270_GOVERNOR_CRITICAL = 0,   ///< Rate path (filters, estimator); never shed
+    BMI270_GOVERNOR_LOGGING,        ///< Shed last
+    BMI270_GOVERNOR_METRICS,        ///< Shed after telemetry
+    BMI270_GOVERNOR_TELEMETRY,      ///< Shed first (e.g. telemetry decimation)
+    BMI270_GOVERNOR_CLASS_COUNT,
+} bmi270_governor_class_t;
+
+/**
+ * @brief Stage function
+ *
+ * @param batch    Batch (fresh, or deferred from an earlier drain)
+ * @param deferred true if the batch is replayed after being deferred
+ * @param ctx      Stage context
+ */
+typedef void (*bmi270_governor_stage_fn_t)(const bmi270_fifo_batch_t *batch, bool deferred, void *ctx);
+
+/**
+ * @brief Stage declaration
+ */
+typedef struct {
+    const char *name;                   ///< Name for logs
+    bmi270_governor_class_t cls;        ///< Class
+    bmi270_governor_stage_fn_t fn;      ///< Stage function
+    void *ctx;                          ///< Context passed to fn
+    bool deferrable;                    ///< Keep batches and run them later instead of shedding
+} bmi270_governor_stage_config_t;
+
+/**
+ * @brief Governor configuration structure
+ */
+typedef struct {
+    uint32_t odr_hz;                    ///< FIFO ODR [Hz]
+    uint8_t budget_percent;             ///< Share of the watermark period for the callback (0 = default)
+    uint8_t max_retained;               ///< Deferred batches held across all stages (0 = pool size - 1)
+} bmi270_governor_config_t;
+
+/**
+ * @brief Per-stage counters
+ */
+typedef struct {
+    uint32_t runs;                      ///< Fresh batches processed
+    uint32_t shed;                      ///< Batches skipped for lack of budget
+    uint32_t deferred;                  ///< Batches queued for later
+    uint32_t replayed;                  ///< Deferred batches processed
+    uint32_t deferred_dropped;          ///< Deferred batches dropped unrun (queue full, limit, flush)
+    uint32_t max_us;                    ///< Longest run [µs]
+    uint32_t estimate_us;               ///< Current cost estimate [µs]
+} bmi270_governor_stage_stats_t;
+
+/**
+ * @brief Governor counters
+ */
+typedef struct {
+    uint32_t batches;                   ///< Batches handled
+    uint32_t late_batches;              ///< Batches that arrived with less than half the budget left
+    uint32_t shed_batches;              ///< Batches where at least one stage was shed or deferred
+    uint32_t overruns;                  ///< Batches whose callback exceeded the budget
+    uint32_t budget_us;                 ///< Full budget per batch [µs]
+    uint32_t max_callback_us;           ///< Longest callback [µs]
+    uint32_t shed_by_class[BMI270_GOVERNOR_CLASS_COUNT];    ///< Stage runs shed or deferred, per class
+    bmi270_governor_stage_stats_t stages[BMI270_GOVERNOR_MAX_STAGES];   ///< In run order
+    uint8_t stage_count;                ///< Valid entries in stages
+} bmi270_governor_stats_t;
+
+/**
+ * @brief One stage (internal)
+ */
+typedef struct {
+    bmi270_governor_stage_config_t config;
+    const bmi270_fifo_batch_t *queue[BMI270_GOVERNOR_MAX_DEFERRED];    ///< Deferred batches (oldest first)
+    uint8_t queued;                     ///< Valid entries in queue
+} bmi270_governor_stage_t;
+
+/**
+ * @brief Governor context
+ */
+typedef struct {
+    const bmi270_fifo_stream_t *stream;     ///< Stream (watermark, frame size, ISR time)
+    bmi270_governor_config_t config;        ///< Configuration
+    uint32_t period_us;                     ///< Watermark period [µs]
+    uint32_t budget_us;                     ///< Budget per batch [µs]
+    uint16_t watermark_frames;              ///< Frames per watermark
+    uint8_t frame_size;                     ///< Bytes per FIFO frame
+    uint32_t isr_count_seen;                ///< Stream ISR count at the previous batch
+    uint8_t retained_limit;                 ///< Deferred batches allowed across all stages
+    uint8_t retained;                       ///< Deferred batches held across all stages
+    bmi270_governor_stage_t stages[BMI270_GOVERNOR_MAX_STAGES];    ///< Sorted by class
+    uint8_t stage_count;                    ///< Registered stages
+    bmi270_governor_stats_t stats;          ///< Counters (drain task; stats.stages[i] belongs to stages[i])
+} bmi270_governor_t;
+
+/* ====== Governor Functions ====== */
+
+/**
+ * @brief Initialize governor for a stream
+ *
+ * @param[out] gov    Pointer to governor context
+ * @param[in]  stream Initialized FIFO stream (watermark, AUX setting and pool size are read once)
+ * @param[in]  config Pointer to governor configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid parameters
+ */
+esp_err_t bmi270_governor_init(bmi270_governor_t *gov, const bmi270_fifo_stream_t *stream,
+                               const bmi270_governor_config_t *config);
+
+/**
+ * @brief Add a stage (stages of the same class run in the order added)
+ *
+ * @param[in] gov   Pointer to governor context
+ * @param[in] stage Stage declaration
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if BMI270_GOVERNOR_MAX_STAGES are registered
+ */
+esp_err_t bmi270_governor_add_stage(bmi270_governor_t *gov, const bmi270_governor_stage_config_t *stage);
+
+/**
+ * @brief Run the stages for one batch (use as bmi270_fifo_stream_config_t.callback)
+ *
+ * @param[in] batch    Batch from the stream
+ * @param[in] user_ctx Pointer to governor context
+ */
+void bmi270_governor_batch_cb(const bmi270_fifo_batch_t *batch, void *user_ctx);
+
+/**
+ * @brief Release all deferred batches without running them
+ *
+ * Called automatically for a batch with sync_lost; call it when stopping
+ * the stream so the pool gets its buffers back.
+ *
+ * @param[in] gov Pointer to governor context
+ */
+void bmi270_governor_flush(bmi270_governor_t *gov);
+
+/**
+ * @brief Copy the counters
+ *
+ * Call from the drain task, or accept that the copy may mix counters from
+ * two consecutive batches.
+ *
+ * @param[in]  gov   Pointer to governor context
+ * @param[out] stats Pointer to counters
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_governor_get_stats(const bmi270_governor_t *gov, bmi270_governor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_GOVERNOR_H
@@ -0,0 +1,218 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_hybrid.h
+ * @brief BMI270 Hybrid Data-Ready + FIFO Acquisition API
+ *
+ * Serves two consumers from one sensor at the same time:
+ *   - Latest-sample path: every data-ready interrupt reads the data
+ *     registers and publishes the newest ACC+GYR sample to a lock-free
+ *     slot (and an optional callback) for the rate loop.
+ *   - History path: the FIFO keeps a gap-free record and is drained into
+ *     a bmi270_fifo_stream_t once it reaches a low watermark, for
+ *     estimation and logging.
+ *
+ * Both paths are issued from one service task, so their SPI transactions
+ * never collide. Each data-ready event costs one burst (ACC/GYR data,
+ * sensor time, INT_STATUS_0/1 and FIFO length, 0x0C-0x25); the FIFO burst
+ * follows only when the low watermark is reached, after the latest
+ * sample has been published.
+ *
+ * Typical usage:
+ *   1. bmi270_configure_int_pin(), then bmi270_hybrid_init()
+ *   2. GPIO ISR: bmi270_hybrid_notify_from_isr(), wake the service task
+ *   3. Service task: bmi270_hybrid_service()
+ *   4. Rate loop (any task): bmi270_hybrid_get_latest()
+ */
+
+#ifndef BMI270_HYBRID_H
+#define BMI270_HYBRID_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_fifo_stream.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ====== Types ====== */
+
+/**
+ * @brief Latest sample from the data registers
+ */
+typedef struct {
+    bmi270_raw_data_t gyr;      ///< Gyroscope [LSB]
+    bmi270_raw_data_t acc;      ///< Accelerometer [LSB]
+    uint32_t sensor_time;       ///< Sensor time (24-bit, 39.0625µs/LSB)
+    uint16_t int_status;        ///< INT_STATUS_0 (bits 0-7) and INT_STATUS_1 (bits 8-15), cleared by the read
+    uint32_t sequence;          ///< Sample sequence number
+    int64_t drdy_time_us;       ///< Host time of the data-ready interrupt [µs]
+    int64_t read_time_us;       ///< Host time when the sample was published [µs]
+} bmi270_hybrid_sample_t;
+
+/**
+ * @brief Latest-sample callback, called from bmi270_hybrid_service()
+ *
+ * Runs before any FIFO transaction of the same event. Keep it short.
+ */
+typedef void (*bmi270_hybrid_sample_cb_t)(const bmi270_hybrid_sample_t *sample, void *user_ctx);
+
+/**
+ * @brief Latest-sample path statistics
+ *
+ * History path statistics are available through bmi270_hybrid_get_history_stats().
+ */
+typedef struct {
+    uint32_t drdy_events;           ///< bmi270_hybrid_notify_from_isr() calls
+    uint32_t samples;               ///< Samples published
+    uint32_t missed_drdy;           ///< Data-ready events that arrived while the previous one was serviced
+    uint32_t stale_reads;           ///< Services without a data-ready flag in INT_STATUS_1
+    uint32_t bus_errors;            ///< Failed data register bursts
+    uint32_t history_drains;        ///< FIFO drains issued by the low watermark
+    uint32_t spike_rejected;        ///< Latest samples with axes replaced by the spike filter
+    uint32_t latency_max_us;        ///< Worst data-ready-to-publish latency [µs]
+    uint32_t latency_hist[BMI270_FIFO_STATS_LATENCY_BINS];  ///< Data-ready-to-publish latency
+} bmi270_hybrid_stats_t;
+
+/**
+ * @brief Hybrid acquisition configuration structure
+ */
+typedef struct {
+    uint16_t history_watermark;             ///< FIFO low watermark [bytes] (multiple of 13 recommended)
+    bmi270_int_pin_t int_pin;               ///< Pin for the data-ready interrupt
+    bmi270_hybrid_sample_cb_t sample_callback;  ///< Latest-sample callback (may be NULL)
+    bmi270_fifo_batch_cb_t history_callback;    ///< History batch callback (may be NULL)
+    void *user_ctx;                         ///< User context passed to both callbacks
+    bmi270_spike_filter_t *spike_filter;    ///< Spike filter for the latest-sample path (may be NULL)
+} bmi270_hybrid_config_t;
+
+/**
+ * @brief Hybrid acquisition context
+ *
+ * Contains a bmi270_fifo_stream_t (about 5 KB); allocate statically.
+ */
+typedef struct {
+    bmi270_dev_t *dev;                      ///< BMI270 device
+    bmi270_hybrid_config_t config;          ///< Configuration
+    bmi270_fifo_stream_t history;           ///< FIFO history path
+    volatile uint32_t isr_time_us;          ///< Last data-ready ISR time (lower 32 bits) [µs]
+    volatile uint32_t isr_count;            ///< Data-ready ISR count
+    uint32_t isr_count_seen;                ///< ISR count at previous service
+    uint32_t spike_sensor_time;             ///< Sensor time of the previous filtered sample
+    bmi270_hybrid_sample_t latest;          ///< Latest-sample slot
+    atomic_uint latest_seq;                 ///< Slot sequence counter (odd while publishing)
+    bmi270_hybrid_stats_t stats_work;       ///< Statistics (service task only)
+    bmi270_hybrid_stats_t stats_published;  ///< Statistics snapshot source
+    atomic_uint stats_seq;                  ///< Sequence counter (odd while publishing)
+} bmi270_hybrid_t;
+
+/* ====== Hybrid Acquisition Functions ====== */
+
+/**
+ * @brief Initialize hybrid acquisition
+ *
+ * Configures the FIFO (ACC+GYR, header mode, stream mode, low watermark),
+ * flushes it and maps only the data-ready interrupt to config->int_pin.
+ * The FIFO watermark is detected from the FIFO length read on every
+ * data-ready event, so it needs no interrupt of its own.
+ *
+ * @param[out] hybrid Pointer to hybrid context
+ * @param[in]  dev    Pointer to BMI270 device structure
+ * @param[in]  config Pointer to configuration
+ * @return ESP_OK on success, error code otherwise
+ *
+ * @note The interrupt pin must be configured with bmi270_configure_int_pin()
+ */
+esp_err_t bmi270_hybrid_init(bmi270_hybrid_t *hybrid, bmi270_dev_t *dev,
+                             const bmi270_hybrid_config_t *config);
+
+/**
+ * @brief Record a data-ready interrupt (ISR safe)
+ *
+ * Call from the GPIO ISR before waking the service task.
+ *
+ * @param[in] hybrid Pointer to hybrid context
+ */
+void bmi270_hybrid_notify_from_isr(bmi270_hybrid_t *hybrid);
+
+/**
+ * @brief Service one data-ready event
+ *
+ * 1. Reads 0x0C-0x25 in one burst and publishes the latest sample
+ * 2. Calls the sample callback
+ * 3. If the FIFO length from the same burst reached the low watermark,
+ *    drains the FIFO (one more burst) and calls the history callback
+ *
+ * @param[in] hybrid Pointer to hybrid context
+ * @return ESP_OK on success, error code otherwise
+ *
+ * @note The burst reads INT_STATUS_0, which clears feature engine
+ *       interrupts (e.g. any-motion). Check sample.int_status instead.
+ */
+esp_err_t bmi270_hybrid_service(bmi270_hybrid_t *hybrid);
+
+/**
+ * @brief Copy the latest sample (lock-free)
+ *
+ * May be called from any task while the service task is running.
+ *
+ * @param[in]  hybrid Pointer to hybrid context
+ * @param[out] sample Pointer to sample copy
+ * @return
+ *         - ESP_OK: Sample copied
+ *         - ESP_ERR_NOT_FOUND: No sample published yet
+ *         - ESP_ERR_TIMEOUT: Publisher was active on every retry (try again)
+ */
+esp_err_t bmi270_hybrid_get_latest(bmi270_hybrid_t *hybrid, bmi270_hybrid_sample_t *sample);
+
+/**
+ * @brief Get a consistent latest-sample path statistics snapshot (lock-free)
+ *
+ * @param[in]  hybrid   Pointer to hybrid context
+ * @param[out] snapshot Pointer to statistics copy
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the publisher was active on every retry
+ */
+esp_err_t bmi270_hybrid_get_stats(bmi270_hybrid_t *hybrid, bmi270_hybrid_stats_t *snapshot);
+
+/**
+ * @brief Get a consistent history path statistics snapshot (lock-free)
+ *
+ * latency_hist measures from the data-ready interrupt that found the
+ * FIFO at the low watermark to the end of the FIFO burst.
+ *
+ * @param[in]  hybrid   Pointer to hybrid context
+ * @param[out] snapshot Pointer to statistics copy
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the publisher was active on every retry
+ */
+esp_err_t bmi270_hybrid_get_history_stats(bmi270_hybrid_t *hybrid, bmi270_fifo_stats_t *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_HYBRID_H
@@ -61,6 +61,22 @@ typedef struct {
     bool open_drain;        ///< true = Open-Drain, false = Push-Pull
 } bmi270_int_pin_config_t;
 
+/* ====== Any-Motion Feature Configuration ====== */
+
+/**
+ * @brief Any-motion feature configuration
+ *
+ * The any-motion detector runs on the BMI270 feature engine and compares
+ * consecutive accelerometer samples against a slope threshold.
+ */
+typedef struct {
+    uint16_t threshold;     ///< Slope threshold [0.48mg/LSB] (0-2047, e.g. 83 = ~40mg)
+    uint16_t duration;      ///< Consecutive samples above threshold [20ms/LSB] (0-8191)
+    bool axis_x;            ///< Evaluate X-axis
+    bool axis_y;            ///< Evaluate Y-axis
+    bool axis_z;            ///< Evaluate Z-axis
+} bmi270_any_motion_config_t;
+
 /* ====== Interrupt Configuration Functions ====== */
 
 /**
@@ -109,6 +125,100 @@ esp_err_t bmi270_disable_data_ready_interrupt(bmi270_dev_t *dev,
  */
 esp_err_t bmi270_set_int_latch_mode(bmi270_dev_t *dev, bool latched);
 
+/* ====== FIFO Interrupt Configuration ====== */
+
+/**
+ * @brief Enable FIFO watermark interrupt
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param int_pin Interrupt pin to use (INT1 or INT2)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_enable_fifo_watermark_interrupt(bmi270_dev_t *dev,
+                                                   bmi270_int_pin_t int_pin);
+
+/**
+ * @brief Disable FIFO watermark interrupt
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param int_pin Interrupt pin to disable (INT1 or INT2)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_disable_fifo_watermark_interrupt(bmi270_dev_t *dev,
+                                                    bmi270_int_pin_t int_pin);
+
+/**
+ * @brief Enable FIFO full interrupt
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param int_pin Interrupt pin to use (INT1 or INT2)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_enable_fifo_full_interrupt(bmi270_dev_t *dev,
+                                              bmi270_int_pin_t int_pin);
+
+/**
+ * @brief Disable FIFO full interrupt
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param int_pin Interrupt pin to disable (INT1 or INT2)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_disable_fifo_full_interrupt(bmi270_dev_t *dev,
+                                               bmi270_int_pin_t int_pin);
+
+/* ====== Feature Interrupt Configuration ====== */
+
+/**
+ * @brief Configure and enable the any-motion feature
+ *
+ * Writes the any-motion block of feature page 1 (read-modify-write of the
+ * 16-byte feature window).
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param config Pointer to any-motion configuration
+ * @return ESP_OK on success, error code otherwise
+ *
+ * @note Requires the configuration file to be loaded (bmi270_init())
+ */
+esp_err_t bmi270_config_any_motion(bmi270_dev_t *dev,
+                                    const bmi270_any_motion_config_t *config);
+
+/**
+ * @brief Enable any-motion interrupt
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param int_pin Interrupt pin to use (INT1 or INT2)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_enable_any_motion_interrupt(bmi270_dev_t *dev,
+                                               bmi270_int_pin_t int_pin);
+
+/**
+ * @brief Disable any-motion interrupt
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param int_pin Interrupt pin to disable (INT1 or INT2)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_disable_any_motion_interrupt(bmi270_dev_t *dev,
+                                                bmi270_int_pin_t int_pin);
+
+/* ====== Interrupt Status ====== */
+
+/**
+ * @brief Read and clear interrupt status
+ *
+ * Reads INT_STATUS_0 (0x1C) and INT_STATUS_1 (0x1D) in a single burst.
+ * Both registers are cleared on read, which also releases a latched
+ * interrupt pin.
+ *
+ * @param dev Pointer to BMI270 device structure
+ * @param status Interrupt status (bits 0-7: INT_STATUS_0, bits 8-15: INT_STATUS_1)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_read_int_status(bmi270_dev_t *dev, uint16_t *status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,232 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_regmap.h
+ * @brief BMI270 Register Map Snapshot and Configuration Drift Detection API
+ *
+ * After an ESD event or a brown-out the sensor can silently fall back to
+ * reset values in some registers (e.g. ACC_RANGE) while the driver keeps
+ * scaling samples with its cached range. This module reads the whole
+ * configuration region in two bursts and compares it with the expected
+ * configuration:
+ *
+ *   - block 0: 0x40-0x5C (ACC/GYR/AUX/FIFO/interrupt/init control, 29 bytes)
+ *   - block 1: 0x6B-0x7D (interface, offsets, power, 19 bytes)
+ *
+ * INIT_DATA (0x5E) is excluded because reading it walks the config memory.
+ *
+ * The expected configuration is captured from the sensor once bring-up is
+ * complete, with ACC_RANGE/GYR_RANGE taken from the driver's cached ranges
+ * (the values the samples are scaled with). Later range changes through
+ * bmi270_set_accel_range()/bmi270_set_gyro_range() are picked up from the
+ * cache automatically; after any other intentional configuration change,
+ * call bmi270_regmap_monitor_capture() again.
+ *
+ * For in-flight use bmi270_regmap_monitor_step() reads one block per call
+ * (about 30 µs at 10 MHz), so a rolling schedule covers the whole map
+ * every two calls. Drifted registers can be written back automatically;
+ * a lost INIT_CTRL means the config file is gone and only bmi270_init()
+ * can recover, which is reported instead of re-applied. INIT_CTRL lies in
+ * block 0, so a step that finds drift in block 1 reads it once more before
+ * deciding (a soft reset also clears PWR_CTRL, which must not be written
+ * back to a sensor without its config file).
+ *
+ * A corrupted burst (bit error, dropped or stuck MISO) reads like drift, so
+ * drift is confirmed before anything is classified or written: the drifted
+ * block (and INIT_CTRL, when it mismatched outside that block) is read a
+ * second time and only registers that mismatch in both reads count.
+ *
+ * The monitor uses the bus: call it from the task that owns the device
+ * (e.g. between FIFO drains).
+ */
+
+#ifndef BMI270_REGMAP_H
+#define BMI270_REGMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_types.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ====== Constants ====== */
+
+/** Number of burst blocks covering the configuration region */
+#define BMI270_REGMAP_BLOCKS            2
+
+/** Drifted registers reported per check (further ones are only counted) */
+#define BMI270_REGMAP_MAX_REPORT        8
+
+/* ====== Types ====== */
+
+/**
+ * @brief Register image indexed by address (only the two blocks are read)
+ */
+typedef struct {
+    uint8_t regs[128];          ///< Register values (regs[BMI270_REG_ACC_RANGE], ...)
+} bmi270_regmap_snapshot_t;
+
+/**
+ * @brief One drifted register
+ */
+typedef struct {
+    uint8_t addr;               ///< Register address
+    uint8_t expected;           ///< Expected value (compared bits only)
+    uint8_t actual;             ///< Value read back (compared bits only)
+} bmi270_regmap_drift_t;
+
+/**
+ * @brief Result of one check
+ */
+typedef struct {
+    uint8_t count;              ///< Drifted registers found
+    bool reset_detected;        ///< INIT_CTRL lost: config file gone, call bmi270_init()
+    bool reapplied;             ///< Expected values written back and verified
+    bmi270_regmap_drift_t regs[BMI270_REGMAP_MAX_REPORT];  ///< First drifted registers
+} bmi270_regmap_report_t;
+
+/**
+ * @brief Monitor configuration structure
+ */
+typedef struct {
+    bool reapply;               ///< Write drifted registers back (except when a reset is detected)
+} bmi270_regmap_config_t;
+
+/**
+ * @brief Monitor counters
+ */
+typedef struct {
+    uint32_t bursts;            ///< Block reads
+    uint32_t read_errors;       ///< Block reads that failed on the bus
+    uint32_t drift_events;      ///< Steps/checks that found drift without a reset
+    uint32_t drifted_regs;      ///< Drifted registers found (mismatching in both reads)
+    uint32_t unconfirmed;       ///< Steps/checks whose drift did not repeat on the re-read
+    uint32_t resets_detected;   ///< Steps/checks that found INIT_CTRL lost
+    uint32_t reapplied;         ///< Registers written back
+    uint32_t reapply_failures;  ///< Re-applies that did not read back as expected
+} bmi270_regmap_stats_t;
+
+/**
+ * @brief Drift monitor context
+ */
+typedef struct {
+    bmi270_dev_t *dev;                      ///< BMI270 device
+    bmi270_regmap_config_t config;          ///< Configuration
+    bmi270_regmap_snapshot_t expected;      ///< Expected configuration
+    bmi270_regmap_snapshot_t actual;        ///< Last values read
+    uint8_t next_block;                     ///< Block read by the next step
+    bmi270_regmap_stats_t stats;            ///< Counters (owner task)
+} bmi270_regmap_monitor_t;
+
+/* ====== Snapshot Functions ====== */
+
+/**
+ * @brief Read the configuration region (two bursts)
+ *
+ * @param[in]  dev      Pointer to BMI270 device structure
+ * @param[out] snapshot Register image (addresses outside the blocks are zeroed)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_regmap_read(bmi270_dev_t *dev, bmi270_regmap_snapshot_t *snapshot);
+
+/**
+ * @brief Compare two images over the monitored bits
+ *
+ * Only documented configuration bits are compared; reserved addresses,
+ * trigger registers and status bits are ignored.
+ *
+ * @param[in]  expected  Expected image
+ * @param[in]  actual    Image read from the sensor
+ * @param[out] drift     Drifted registers (may be NULL)
+ * @param[in]  max_drift Capacity of drift
+ * @return Number of drifted registers (may exceed max_drift)
+ */
+uint8_t bmi270_regmap_diff(const bmi270_regmap_snapshot_t *expected,
+                           const bmi270_regmap_snapshot_t *actual,
+                           bmi270_regmap_drift_t *drift, uint8_t max_drift);
+
+/* ====== Drift Monitor Functions ====== */
+
+/**
+ * @brief Initialize monitor and capture the expected configuration
+ *
+ * Call after the sensor, FIFO and interrupts are fully configured.
+ *
+ * @param[out] monitor Pointer to monitor context
+ * @param[in]  dev     Pointer to BMI270 device structure (init_complete)
+ * @param[in]  config  Pointer to monitor configuration (NULL = report only)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_regmap_monitor_init(bmi270_regmap_monitor_t *monitor, bmi270_dev_t *dev,
+                                     const bmi270_regmap_config_t *config);
+
+/**
+ * @brief Re-capture the expected configuration from the sensor
+ *
+ * Call after an intentional configuration change (ODR, FIFO, interrupts).
+ *
+ * @param[in] monitor Pointer to monitor context
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_regmap_monitor_capture(bmi270_regmap_monitor_t *monitor);
+
+/**
+ * @brief Check the next block (one burst; rolling schedule)
+ *
+ * Drift costs one more burst (plus an INIT_CTRL read for block 1) to confirm.
+ *
+ * @param[in]  monitor Pointer to monitor context
+ * @param[out] report  Result for this block (may be NULL)
+ * @return ESP_OK when the block was checked (drift or not), error code on bus error
+ *         or when re-applying failed
+ */
+esp_err_t bmi270_regmap_monitor_step(bmi270_regmap_monitor_t *monitor, bmi270_regmap_report_t *report);
+
+/**
+ * @brief Check both blocks (two bursts)
+ *
+ * @param[in]  monitor Pointer to monitor context
+ * @param[out] report  Result for the whole map (may be NULL)
+ * @return Same as bmi270_regmap_monitor_step()
+ */
+esp_err_t bmi270_regmap_monitor_check(bmi270_regmap_monitor_t *monitor, bmi270_regmap_report_t *report);
+
+/**
+ * @brief Copy the counters
+ *
+ * @param[in]  monitor Pointer to monitor context
+ * @param[out] stats   Pointer to counters
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_regmap_get_stats(const bmi270_regmap_monitor_t *monitor, bmi270_regmap_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_REGMAP_H
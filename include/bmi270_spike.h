@@ -0,0 +1,185 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/**
+ * @file bmi270_spike.h
+ * @brief BMI270 Spike Rejection Filter API
+ *
+ * A corrupted SPI transfer typically turns one sample into a full-scale
+ * spike. This filter removes such outliers from raw ACC/GYR samples,
+ * per axis, before conversion:
+ *
+ *   - BMI270_SPIKE_DELTA: physics-bounded check with no group delay. A
+ *     sample is rejected if its change from the previous output exceeds
+ *     what the airframe can do in one sample period (maximum angular
+ *     acceleration), or if the change of that change exceeds the maximum
+ *     jerk. A rejected axis is replaced by the linear prediction from the
+ *     last two outputs. After max_consecutive rejections in a row the
+ *     axis re-synchronizes to the input, so a real step (e.g. a crash)
+ *     cannot lock the filter out.
+ *   - BMI270_SPIKE_MEDIAN3: causal median of the last three samples.
+ *     Removes any single-sample spike without tuning, at the cost of one
+ *     sample of delay.
+ *
+ * Thresholds are given in physical units and converted to LSB per sample
+ * once; they follow range changes of the device automatically. The work
+ * per sample is a few integer compares per axis.
+ *
+ * The filter can be attached to a FIFO stream (bmi270_fifo_stream_config_t)
+ * or to the latest-sample path of the hybrid mode (bmi270_hybrid_config_t),
+ * or called directly with bmi270_spike_process().
+ */
+
+#ifndef BMI270_SPIKE_H
+#define BMI270_SPIKE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "bmi270_data.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ====== Constants ====== */
+
+/** Axes: GYR X/Y/Z, ACC X/Y/Z */
+#define BMI270_SPIKE_AXES               6
+
+/** Default consecutive rejections before an axis re-synchronizes */
+#define BMI270_SPIKE_DEFAULT_MAX_CONSECUTIVE    4
+
+/* ====== Types ====== */
+
+/**
+ * @brief Rejection method
+ */
+typedef enum {
+    BMI270_SPIKE_OFF = 0,       ///< Pass through (counters still run)
+    BMI270_SPIKE_DELTA,         ///< Physics-bounded delta/jerk check (no delay)
+    BMI270_SPIKE_MEDIAN3,       ///< Causal median of 3 (one sample delay)
+} bmi270_spike_mode_t;
+
+/**
+ * @brief Spike filter configuration structure
+ *
+ * A limit of 0 disables that check. In BMI270_SPIKE_MEDIAN3 mode the
+ * delta limits only decide which replacements are counted as rejections.
+ */
+typedef struct {
+    bmi270_spike_mode_t mode;   ///< Rejection method
+    uint32_t sample_rate_hz;    ///< Sample rate (ODR) [Hz]
+    float gyr_max_accel;        ///< Maximum angular acceleration of the airframe [rad/s^2]
+    float gyr_max_jerk;         ///< Maximum angular jerk of the airframe [rad/s^3]
+    float acc_max_slew;         ///< Maximum change of specific force [g/s]
+    uint16_t noise_margin_lsb;  ///< Added to every limit to tolerate sensor noise [LSB]
+    uint8_t max_consecutive;    ///< Rejections in a row before re-sync (0 = default)
+} bmi270_spike_config_t;
+
+/**
+ * @brief Spike filter counters
+ */
+typedef struct {
+    uint32_t samples;           ///< Samples processed
+    uint32_t rejected_samples;  ///< Samples with at least one axis replaced
+    uint32_t rejected_axes;     ///< Axis values replaced
+    uint32_t resyncs;           ///< Axes re-synchronized after max_consecutive rejections
+} bmi270_spike_stats_t;
+
+/**
+ * @brief Per-axis state
+ */
+typedef struct {
+    int16_t y1;                 ///< Previous output (DELTA) or input (MEDIAN3)
+    int16_t y2;                 ///< Output/input before y1
+    uint8_t rejects;            ///< Consecutive rejections
+} bmi270_spike_axis_t;
+
+/**
+ * @brief Spike filter context
+ */
+typedef struct {
+    bmi270_dev_t *dev;                      ///< BMI270 device (range settings)
+    bmi270_spike_config_t config;           ///< Configuration
+    bmi270_spike_axis_t axis[BMI270_SPIKE_AXES];    ///< Axis state (GYR X/Y/Z, ACC X/Y/Z)
+    uint8_t history;                        ///< Valid samples in the axis state (0-2)
+    uint8_t limit_acc_range;                ///< acc_range of the cached limits
+    uint8_t limit_gyr_range;                ///< gyr_range of the cached limits
+    int32_t delta_limit[BMI270_SPIKE_AXES]; ///< Per-sample change limit [LSB] (0 = off)
+    int32_t jerk_limit[BMI270_SPIKE_AXES];  ///< Per-sample change-of-change limit [LSB] (0 = off)
+    bmi270_spike_stats_t stats;             ///< Counters (owner task)
+} bmi270_spike_filter_t;
+
+/* ====== Spike Filter Functions ====== */
+
+/**
+ * @brief Initialize spike filter
+ *
+ * @param[out] filter Pointer to filter context
+ * @param[in]  dev    Pointer to BMI270 device structure (ranges are checked on every sample)
+ * @param[in]  config Pointer to filter configuration
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_spike_init(bmi270_spike_filter_t *filter, bmi270_dev_t *dev,
+                            const bmi270_spike_config_t *config);
+
+/**
+ * @brief Forget the sample history (after a discontinuity); counters are kept
+ *
+ * @param[in] filter Pointer to filter context
+ */
+void bmi270_spike_reset(bmi270_spike_filter_t *filter);
+
+/**
+ * @brief Filter one ACC+GYR sample in place
+ *
+ * @param[in]     filter Pointer to filter context
+ * @param[in,out] gyr    Gyroscope sample [LSB]
+ * @param[in,out] acc    Accelerometer sample [LSB]
+ * @param[in]     steps  Sample periods since the previous call (1 = consecutive;
+ *                       larger values widen the delta limit and skip the jerk check)
+ * @return Number of axes replaced
+ */
+uint8_t bmi270_spike_process(bmi270_spike_filter_t *filter, bmi270_raw_data_t *gyr,
+                             bmi270_raw_data_t *acc, uint16_t steps);
+
+/**
+ * @brief Copy the counters
+ *
+ * Call from the task that runs the filter, or accept that the copy may
+ * mix counters from two consecutive samples (each counter is a 32-bit word).
+ *
+ * @param[in]  filter Pointer to filter context
+ * @param[out] stats  Pointer to counters
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t bmi270_spike_get_stats(const bmi270_spike_filter_t *filter, bmi270_spike_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_SPIKE_H
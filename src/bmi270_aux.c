@@ -0,0 +1,472 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_aux.c
+ * @brief BMI270 Auxiliary (AUX) Interface Implementation
+ *
+ * Manual mode transfers are started by writing AUX_RD_ADDR / AUX_WR_ADDR
+ * and complete when STATUS.aux_busy clears. BMM150 compensation follows
+ * the Bosch BMM150 SensorAPI floating-point formulas.
+ */
+
+#include <string.h>
+#include "bmi270_aux.h"
+#include "bmi270_defs.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "BMI270_AUX";
+
+// Forward declarations from bmi270_spi.c
+extern esp_err_t bmi270_read_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data);
+extern esp_err_t bmi270_write_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t data);
+extern esp_err_t bmi270_read_burst(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data, size_t length);
+
+/* BMM150 registers */
+#define BMM150_REG_CHIP_ID              0x40
+#define BMM150_REG_DATA_X_LSB           0x42
+#define BMM150_REG_POWER_CONTROL        0x4B
+#define BMM150_REG_OP_MODE              0x4C
+#define BMM150_REG_REP_XY               0x51
+#define BMM150_REG_REP_Z                0x52
+#define BMM150_REG_DIG_X1               0x5D    // dig_x1, dig_y1
+#define BMM150_REG_DIG_Z4_LSB           0x62    // dig_z4, dig_x2, dig_y2
+#define BMM150_REG_DIG_Z2_LSB           0x68    // dig_z2, dig_z1, dig_xyz1
+#define BMM150_REG_DIG_Z3_LSB           0x6E    // dig_z3, dig_xy2, dig_xy1
+
+#define BMM150_POWER_ON                 0x01
+#define BMM150_OP_MODE_FORCED           0x02    // opmode<2:1> = 01
+#define BMM150_REP_XY_REGULAR           0x04    // 9 repetitions
+#define BMM150_REP_Z_REGULAR            0x0E    // 15 repetitions
+#define BMM150_STARTUP_MS               3
+
+#define BMM150_OVERFLOW_XY              (-4096)
+#define BMM150_OVERFLOW_Z               (-16384)
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Wait until STATUS.aux_busy clears
+ */
+static esp_err_t bmi270_aux_wait_idle(bmi270_dev_t *dev) {
+    for (int elapsed = 0; elapsed <= BMI270_AUX_BUSY_TIMEOUT_US; elapsed += BMI270_AUX_BUSY_POLL_US) {
+        uint8_t status;
+        esp_err_t ret = bmi270_read_register(dev, BMI270_REG_STATUS, &status);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if ((status & BMI270_STATUS_AUX_BUSY) == 0) {
+            return ESP_OK;
+        }
+        esp_rom_delay_us(BMI270_AUX_BUSY_POLL_US);
+    }
+
+    ESP_LOGE(TAG, "AUX transfer timeout");
+    return ESP_ERR_TIMEOUT;
+}
+
+/**
+ * @brief Smallest burst setting covering length bytes
+ */
+static bmi270_aux_burst_t bmi270_aux_burst_for(size_t length) {
+    if (length <= 1) {
+        return BMI270_AUX_BURST_1;
+    }
+    if (length <= 2) {
+        return BMI270_AUX_BURST_2;
+    }
+    if (length <= 6) {
+        return BMI270_AUX_BURST_6;
+    }
+    return BMI270_AUX_BURST_8;
+}
+
+/**
+ * @brief Read-modify-write helper for single bits
+ */
+static esp_err_t bmi270_aux_update_bits(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t mask, bool set) {
+    uint8_t value;
+    esp_err_t ret = bmi270_read_register(dev, reg_addr, &value);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    value = set ? (value | mask) : (value & ~mask);
+    return bmi270_write_register(dev, reg_addr, value);
+}
+
+/* ====== AUX Interface Functions ====== */
+
+/**
+ * @brief Enable the AUX interface in manual mode
+ */
+esp_err_t bmi270_aux_enable(bmi270_dev_t *dev, uint8_t i2c_addr) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_aux_enable");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (i2c_addr > 0x7F) {
+        ESP_LOGE(TAG, "Invalid AUX I2C address: 0x%02X", i2c_addr);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = bmi270_aux_update_bits(dev, BMI270_REG_PWR_CTRL, BMI270_PWR_CTRL_AUX_EN, true);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable AUX in PWR_CTRL");
+        return ret;
+    }
+
+    ret = bmi270_aux_update_bits(dev, BMI270_REG_IF_CONF, BMI270_IF_CONF_AUX_EN, true);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable AUX in IF_CONF");
+        return ret;
+    }
+
+    ret = bmi270_write_register(dev, BMI270_REG_AUX_DEV_ID, (uint8_t)(i2c_addr << 1));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write AUX_DEV_ID");
+        return ret;
+    }
+
+    ret = bmi270_write_register(dev, BMI270_REG_AUX_IF_CONF, BMI270_AUX_MANUAL_EN);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write AUX_IF_CONF");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "AUX interface enabled (manual mode, I2C address 0x%02X)", i2c_addr);
+    return bmi270_aux_wait_idle(dev);
+}
+
+/**
+ * @brief Disable the AUX interface
+ */
+esp_err_t bmi270_aux_disable(bmi270_dev_t *dev) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_aux_disable");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = bmi270_aux_update_bits(dev, BMI270_REG_PWR_CTRL, BMI270_PWR_CTRL_AUX_EN, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to disable AUX in PWR_CTRL");
+    }
+    return ret;
+}
+
+/**
+ * @brief Read auxiliary sensor registers (manual mode)
+ */
+esp_err_t bmi270_aux_read(bmi270_dev_t *dev, uint8_t reg, uint8_t *data, size_t length) {
+    if (dev == NULL || data == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_aux_read");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (length == 0 || length > BMI270_FIFO_AUX_PAYLOAD) {
+        ESP_LOGE(TAG, "Invalid AUX read length: %u", (unsigned)length);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Manual burst length, then the read itself (started by AUX_RD_ADDR)
+    uint8_t if_conf = BMI270_AUX_MANUAL_EN | (bmi270_aux_burst_for(length) << BMI270_AUX_MAN_RD_BURST_SHIFT);
+    esp_err_t ret = bmi270_write_register(dev, BMI270_REG_AUX_IF_CONF, if_conf);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = bmi270_write_register(dev, BMI270_REG_AUX_RD_ADDR, reg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = bmi270_aux_wait_idle(dev);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    uint8_t aux_data[BMI270_FIFO_AUX_PAYLOAD];
+    ret = bmi270_read_burst(dev, BMI270_REG_AUX_DATA_0, aux_data, length);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    memcpy(data, aux_data, length);
+    return ESP_OK;
+}
+
+/**
+ * @brief Write one auxiliary sensor register (manual mode)
+ */
+esp_err_t bmi270_aux_write(bmi270_dev_t *dev, uint8_t reg, uint8_t value) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_aux_write");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = bmi270_write_register(dev, BMI270_REG_AUX_WR_DATA, value);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Writing AUX_WR_ADDR starts the transfer
+    ret = bmi270_write_register(dev, BMI270_REG_AUX_WR_ADDR, reg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    return bmi270_aux_wait_idle(dev);
+}
+
+/**
+ * @brief Switch the AUX interface to data mode
+ */
+esp_err_t bmi270_aux_start_data_mode(bmi270_dev_t *dev, const bmi270_aux_config_t *config) {
+    if (dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_aux_start_data_mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (config->odr < BMI270_ACC_ODR_0_78HZ || config->odr > BMI270_ACC_ODR_800HZ ||
+        config->offset > BMI270_AUX_OFFSET_MASK) {
+        ESP_LOGE(TAG, "Invalid AUX ODR/offset: 0x%02X/%u", config->odr, config->offset);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret;
+
+    // Trigger register/value are latched while still in manual mode
+    // (this also issues the first trigger write)
+    if (config->trigger_enable) {
+        ret = bmi270_aux_write(dev, config->trigger_reg, config->trigger_value);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write AUX trigger register");
+            return ret;
+        }
+    }
+
+    uint8_t aux_conf = (uint8_t)((config->odr & BMI270_AUX_ODR_MASK) |
+                                 ((config->offset & BMI270_AUX_OFFSET_MASK) << BMI270_AUX_OFFSET_SHIFT));
+    ret = bmi270_write_register(dev, BMI270_REG_AUX_CONF, aux_conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write AUX_CONF");
+        return ret;
+    }
+
+    uint8_t if_conf = (uint8_t)(config->burst & BMI270_AUX_RD_BURST_MASK);
+    if (config->trigger_enable) {
+        if_conf |= BMI270_AUX_FCU_WRITE_EN;
+    }
+    ret = bmi270_write_register(dev, BMI270_REG_AUX_IF_CONF, if_conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write AUX_IF_CONF");
+        return ret;
+    }
+
+    ret = bmi270_write_register(dev, BMI270_REG_AUX_RD_ADDR, config->read_addr);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write AUX_RD_ADDR");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "AUX data mode: ODR=0x%02X, read 0x%02X, AUX_IF_CONF=0x%02X",
+             config->odr, config->read_addr, if_conf);
+    return ESP_OK;
+}
+
+/**
+ * @brief Return the AUX interface to manual mode
+ */
+esp_err_t bmi270_aux_stop_data_mode(bmi270_dev_t *dev) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_aux_stop_data_mode");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = bmi270_write_register(dev, BMI270_REG_AUX_IF_CONF, BMI270_AUX_MANUAL_EN);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write AUX_IF_CONF");
+        return ret;
+    }
+
+    // Let a data mode read in flight finish
+    return bmi270_aux_wait_idle(dev);
+}
+
+/**
+ * @brief Read the latest data mode result
+ */
+esp_err_t bmi270_aux_read_data(bmi270_dev_t *dev, uint8_t data[8]) {
+    if (dev == NULL || data == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_aux_read_data");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return bmi270_read_burst(dev, BMI270_REG_AUX_DATA_0, data, BMI270_FIFO_AUX_PAYLOAD);
+}
+
+/* ====== BMM150 Functions ====== */
+
+/**
+ * @brief Set up a BMM150 on the AUX interface and start data mode
+ */
+esp_err_t bmi270_bmm150_init(bmi270_dev_t *dev, bmi270_acc_odr_t odr, bmi270_bmm150_trim_t *trim) {
+    if (dev == NULL || trim == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_bmm150_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (odr < BMI270_ACC_ODR_0_78HZ || odr > BMI270_ACC_ODR_100HZ) {
+        ESP_LOGE(TAG, "BMM150 ODR 0x%02X exceeds 100Hz (regular preset)", odr);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = bmi270_aux_enable(dev, BMI270_BMM150_I2C_ADDR);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Suspend -> sleep mode
+    ret = bmi270_aux_write(dev, BMM150_REG_POWER_CONTROL, BMM150_POWER_ON);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to power on BMM150");
+        return ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(BMM150_STARTUP_MS));
+
+    uint8_t chip_id;
+    ret = bmi270_aux_read(dev, BMM150_REG_CHIP_ID, &chip_id, 1);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (chip_id != BMI270_BMM150_CHIP_ID) {
+        ESP_LOGE(TAG, "BMM150 chip ID mismatch: 0x%02X (expected 0x%02X)", chip_id, BMI270_BMM150_CHIP_ID);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Trim registers (4 manual reads)
+    uint8_t xy1[2], z4[4], z2[6], z3[4];
+    if ((ret = bmi270_aux_read(dev, BMM150_REG_DIG_X1, xy1, sizeof(xy1))) != ESP_OK ||
+        (ret = bmi270_aux_read(dev, BMM150_REG_DIG_Z4_LSB, z4, sizeof(z4))) != ESP_OK ||
+        (ret = bmi270_aux_read(dev, BMM150_REG_DIG_Z2_LSB, z2, sizeof(z2))) != ESP_OK ||
+        (ret = bmi270_aux_read(dev, BMM150_REG_DIG_Z3_LSB, z3, sizeof(z3))) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read BMM150 trim registers");
+        return ret;
+    }
+
+    trim->dig_x1 = (int8_t)xy1[0];
+    trim->dig_y1 = (int8_t)xy1[1];
+    trim->dig_z4 = (int16_t)((z4[1] << 8) | z4[0]);
+    trim->dig_x2 = (int8_t)z4[2];
+    trim->dig_y2 = (int8_t)z4[3];
+    trim->dig_z2 = (int16_t)((z2[1] << 8) | z2[0]);
+    trim->dig_z1 = (uint16_t)((z2[3] << 8) | z2[2]);
+    trim->dig_xyz1 = (uint16_t)(((z2[5] & 0x7F) << 8) | z2[4]);
+    trim->dig_z3 = (int16_t)((z3[1] << 8) | z3[0]);
+    trim->dig_xy2 = (int8_t)z3[2];
+    trim->dig_xy1 = z3[3];
+
+    // Regular preset
+    ret = bmi270_aux_write(dev, BMM150_REG_REP_XY, BMM150_REP_XY_REGULAR);
+    if (ret == ESP_OK) {
+        ret = bmi270_aux_write(dev, BMM150_REG_REP_Z, BMM150_REP_Z_REGULAR);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set BMM150 repetitions");
+        return ret;
+    }
+
+    // Each trigger: start a forced measurement, read the 8 data bytes
+    bmi270_aux_config_t aux_config = {
+        .odr = odr,
+        .offset = 0,
+        .read_addr = BMM150_REG_DATA_X_LSB,
+        .burst = BMI270_AUX_BURST_8,
+        .trigger_enable = true,
+        .trigger_reg = BMM150_REG_OP_MODE,
+        .trigger_value = BMM150_OP_MODE_FORCED,
+    };
+    ret = bmi270_aux_start_data_mode(dev, &aux_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "BMM150 initialized on AUX (ODR=0x%02X)", odr);
+    return ESP_OK;
+}
+
+/**
+ * @brief Convert a BMM150 AUX payload to µT
+ */
+void bmi270_bmm150_compensate(const bmi270_bmm150_trim_t *trim, const uint8_t raw[8], bmi270_mag_t *mag) {
+    if (trim == NULL || raw == NULL || mag == NULL) {
+        return;
+    }
+
+    // X/Y: 13-bit, Z: 15-bit (signed, MSB-aligned); RHALL: 14-bit unsigned
+    int16_t data_x = (int16_t)((int16_t)((raw[1] << 8) | raw[0]) >> 3);
+    int16_t data_y = (int16_t)((int16_t)((raw[3] << 8) | raw[2]) >> 3);
+    int16_t data_z = (int16_t)((int16_t)((raw[5] << 8) | raw[4]) >> 1);
+    uint16_t rhall = (uint16_t)(((raw[7] << 8) | raw[6]) >> 2);
+
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    if (rhall != 0 && trim->dig_xyz1 != 0) {
+        float r = ((float)trim->dig_xyz1 * 16384.0f / rhall) - 16384.0f;
+        float xy_common = (float)trim->dig_xy2 * (r * r / 268435456.0f) + r * (float)trim->dig_xy1 / 16384.0f;
+
+        if (data_x != BMM150_OVERFLOW_XY) {
+            x = data_x * ((xy_common + 256.0f) * ((float)trim->dig_x2 + 160.0f));
+            x = ((x / 8192.0f) + ((float)trim->dig_x1 * 8.0f)) / 16.0f;
+        }
+        if (data_y != BMM150_OVERFLOW_XY) {
+            y = data_y * ((xy_common + 256.0f) * ((float)trim->dig_y2 + 160.0f));
+            y = ((y / 8192.0f) + ((float)trim->dig_y1 * 8.0f)) / 16.0f;
+        }
+    }
+
+    if (data_z != BMM150_OVERFLOW_Z && trim->dig_z1 != 0 && trim->dig_z2 != 0 &&
+        trim->dig_xyz1 != 0 && rhall != 0) {
+        float z0 = (float)data_z - (float)trim->dig_z4;
+        float z1 = (float)rhall - (float)trim->dig_xyz1;
+        float z2 = (float)trim->dig_z3 * z1;
+        float z4 = (float)trim->dig_z2 + (float)trim->dig_z1 * (float)rhall / 32768.0f;
+        z = ((z0 * 131072.0f) - z2) / (z4 * 4.0f) / 16.0f;
+    }
+
+    mag->x = x;
+    mag->y = y;
+    mag->z = z;
+}
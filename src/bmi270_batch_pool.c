@@ -0,0 +1,152 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_batch_pool.c
+ * @brief BMI270 FIFO Batch Lending Pool Implementation
+ */
+
+#include <string.h>
+#include "bmi270_batch_pool.h"
+#include "esp_log.h"
+
+static const char *TAG = "BMI270_BATCH_POOL";
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Track the number of referenced buffers and its peak
+ */
+static void pool_count_in_use(bmi270_batch_pool_t *pool) {
+    unsigned in_use = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+    unsigned peak = atomic_load_explicit(&pool->peak_in_use, memory_order_relaxed);
+    while (in_use > peak &&
+           !atomic_compare_exchange_weak_explicit(&pool->peak_in_use, &peak, in_use,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/* ====== Pool Functions ====== */
+
+esp_err_t bmi270_batch_pool_init(bmi270_batch_pool_t *pool, bmi270_batch_buf_t *buffers, uint8_t count) {
+    if (pool == NULL || buffers == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_batch_pool_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (count == 0 || count > BMI270_BATCH_POOL_MAX_BUFFERS) {
+        ESP_LOGE(TAG, "Invalid buffer count %u (1-%d)", count, BMI270_BATCH_POOL_MAX_BUFFERS);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    pool->buffers = buffers;
+    pool->count = count;
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->peak_in_use, 0);
+    atomic_init(&pool->lent, 0);
+    atomic_init(&pool->exhausted, 0);
+    atomic_init(&pool->retains, 0);
+
+    for (uint8_t i = 0; i < count; i++) {
+        memset(&buffers[i].batch, 0, sizeof(buffers[i].batch));
+        atomic_init(&buffers[i].refs, 0);
+        buffers[i].pool = pool;
+    }
+    return ESP_OK;
+}
+
+bmi270_batch_buf_t *bmi270_batch_pool_acquire(bmi270_batch_pool_t *pool) {
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    // Round-robin from the last buffer handed out: the oldest release is the likeliest free
+    for (uint8_t n = 0; n < pool->count; n++) {
+        uint8_t i = (uint8_t)((pool->next + n) % pool->count);
+        bmi270_batch_buf_t *buf = &pool->buffers[i];
+        unsigned expected = 0;
+        // Acquire pairs with the release in bmi270_batch_release(): the last
+        // reader is done with the buffer before the engine overwrites it
+        if (atomic_compare_exchange_strong_explicit(&buf->refs, &expected, 1,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            pool->next = (uint8_t)((i + 1) % pool->count);
+            pool_count_in_use(pool);
+            atomic_fetch_add_explicit(&pool->lent, 1, memory_order_relaxed);
+            return buf;
+        }
+    }
+
+    atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+    return NULL;
+}
+
+const bmi270_fifo_batch_t *bmi270_batch_retain(const bmi270_fifo_batch_t *batch) {
+    if (batch == NULL || batch->owner == NULL) {
+        return NULL;
+    }
+
+    bmi270_batch_buf_t *buf = batch->owner;
+    unsigned refs = atomic_load_explicit(&buf->refs, memory_order_relaxed);
+    do {
+        if (refs == 0) {
+            // The caller did not hold a reference: the buffer may already be refilled
+            ESP_LOGE(TAG, "bmi270_batch_retain on a released batch");
+            return NULL;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&buf->refs, &refs, refs + 1,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    atomic_fetch_add_explicit(&buf->pool->retains, 1, memory_order_relaxed);
+    return batch;
+}
+
+void bmi270_batch_release(const bmi270_fifo_batch_t *batch) {
+    if (batch == NULL || batch->owner == NULL) {
+        return;
+    }
+
+    bmi270_batch_buf_t *buf = batch->owner;
+    unsigned refs = atomic_fetch_sub_explicit(&buf->refs, 1, memory_order_release);
+    if (refs == 1) {
+        atomic_fetch_sub_explicit(&buf->pool->in_use, 1, memory_order_relaxed);
+    } else if (refs == 0) {
+        atomic_store_explicit(&buf->refs, 0, memory_order_relaxed);
+        ESP_LOGE(TAG, "bmi270_batch_release without a reference");
+    }
+}
+
+esp_err_t bmi270_batch_pool_get_stats(bmi270_batch_pool_t *pool, bmi270_batch_pool_stats_t *stats) {
+    if (pool == NULL || stats == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_batch_pool_get_stats");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->lent = atomic_load_explicit(&pool->lent, memory_order_relaxed);
+    stats->exhausted = atomic_load_explicit(&pool->exhausted, memory_order_relaxed);
+    stats->retains = atomic_load_explicit(&pool->retains, memory_order_relaxed);
+    stats->in_use = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+    stats->peak_in_use = atomic_load_explicit(&pool->peak_in_use, memory_order_relaxed);
+    return ESP_OK;
+}
@@ -0,0 +1,307 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_capture.c
+ * @brief BMI270 Triggered Burst Capture Implementation
+ *
+ * State machine:
+ *   ARMED     --trigger-->   CAPTURING  (flush FIFO, enable ACC+GYR recording)
+ *   CAPTURING --FIFO full--> ARMED/IDLE (pause recording, drain 2 KB in one burst)
+ *
+ * All functions must be called from the same task.
+ */
+
+#include <string.h>
+#include "bmi270_capture.h"
+#include "bmi270_defs.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BMI270_CAPTURE";
+
+// Forward declarations from bmi270_spi.c
+extern esp_err_t bmi270_write_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t data);
+
+// FIFO_CONFIG_1 values used by capture mode (header mode always on)
+#define CAPTURE_FIFO_PAUSED     (BMI270_FIFO_HEADER_EN)
+#define CAPTURE_FIFO_RECORDING  (BMI270_FIFO_HEADER_EN | BMI270_FIFO_ACC_EN | BMI270_FIFO_GYR_EN)
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Pause FIFO recording (contents are kept)
+ */
+static esp_err_t capture_pause_fifo(bmi270_capture_t *cap) {
+    esp_err_t ret = bmi270_write_register(cap->dev, BMI270_REG_FIFO_CONFIG_1, CAPTURE_FIFO_PAUSED);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to pause FIFO recording");
+    }
+    return ret;
+}
+
+/**
+ * @brief Start a capture window
+ */
+static esp_err_t capture_start(bmi270_capture_t *cap, bmi270_capture_trigger_t source) {
+    // Discard config-change frames left from the previous window
+    esp_err_t ret = bmi270_fifo_flush(cap->dev);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = bmi270_write_register(cap->dev, BMI270_REG_FIFO_CONFIG_1, CAPTURE_FIFO_RECORDING);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start FIFO recording");
+        return ret;
+    }
+
+    cap->trigger = source;
+    cap->trigger_time_us = esp_timer_get_time();
+    cap->state = BMI270_CAPTURE_STATE_CAPTURING;
+
+    ESP_LOGD(TAG, "Capture #%lu started (trigger=%d)", cap->sequence, source);
+    return ESP_OK;
+}
+
+/**
+ * @brief Drain the frozen FIFO, report it and re-arm
+ */
+static esp_err_t capture_drain(bmi270_capture_t *cap) {
+    // Pause first so the FIFO does not refill while it is being read
+    esp_err_t ret = capture_pause_fifo(cap);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // One burst for the whole FIFO; bytes past the fill level read as 0x80
+    ret = bmi270_fifo_read(cap->dev, cap->buffer, BMI270_FIFO_SIZE);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    bmi270_fifo_parser_t parser;
+    bmi270_fifo_frame_t frame;
+    uint16_t frame_count = 0;
+    bmi270_fifo_parser_init(&parser, cap->buffer, BMI270_FIFO_SIZE);
+    while ((ret = bmi270_fifo_parser_next(&parser, &frame)) == ESP_OK) {
+        if (frame.type == BMI270_FIFO_FRAME_SENSOR) {
+            frame_count++;
+        }
+    }
+    if (ret == ESP_ERR_INVALID_RESPONSE) {
+        ESP_LOGW(TAG, "Capture #%lu: frame sync lost at byte %u", cap->sequence, parser.offset);
+    }
+
+    bmi270_capture_event_t event = {
+        .data = cap->buffer,
+        .length = parser.offset,
+        .frame_count = frame_count,
+        .trigger = cap->trigger,
+        .sequence = cap->sequence,
+        .trigger_time_us = cap->trigger_time_us,
+        .drain_time_us = esp_timer_get_time(),
+    };
+
+    cap->sequence++;
+    cap->state = cap->config.auto_rearm ? BMI270_CAPTURE_STATE_ARMED : BMI270_CAPTURE_STATE_IDLE;
+
+    ESP_LOGD(TAG, "Capture #%lu drained: %u bytes, %u frames",
+             event.sequence, event.length, event.frame_count);
+
+    cap->config.callback(&event, cap->config.user_ctx);
+    return ESP_OK;
+}
+
+/* ====== Capture API ====== */
+
+/**
+ * @brief Initialize capture mode and arm it
+ */
+esp_err_t bmi270_capture_init(bmi270_capture_t *cap, bmi270_dev_t *dev,
+                              const bmi270_capture_config_t *config) {
+    if (cap == NULL || dev == NULL || config == NULL || config->callback == NULL) {
+        ESP_LOGE(TAG, "Invalid parameters in bmi270_capture_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(cap, 0, sizeof(*cap));
+    cap->dev = dev;
+    cap->config = *config;
+    cap->state = BMI270_CAPTURE_STATE_IDLE;
+
+    // FIFO mode (stop-on-full), header mode, recording paused
+    bmi270_fifo_config_t fifo_config = {
+        .acc_enable = false,
+        .gyr_enable = false,
+        .header_enable = true,
+        .stop_on_full = true,
+        .watermark = 0,
+    };
+    esp_err_t ret = bmi270_fifo_configure(dev, &fifo_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = bmi270_enable_fifo_full_interrupt(dev, config->int_pin);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (config->any_motion_trigger) {
+        ret = bmi270_config_any_motion(dev, &config->any_motion);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        ret = bmi270_enable_any_motion_interrupt(dev, config->int_pin);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
+    ret = bmi270_capture_arm(cap);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Capture initialized: INT%d, any-motion trigger=%s, auto re-arm=%s",
+             config->int_pin + 1, config->any_motion_trigger ? "ON" : "OFF",
+             config->auto_rearm ? "ON" : "OFF");
+    return ESP_OK;
+}
+
+/**
+ * @brief Arm capture
+ */
+esp_err_t bmi270_capture_arm(bmi270_capture_t *cap) {
+    if (cap == NULL || cap->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_capture_arm");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = capture_pause_fifo(cap);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Clear stale FIFO full / any-motion status
+    uint16_t status;
+    ret = bmi270_read_int_status(cap->dev, &status);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    cap->state = BMI270_CAPTURE_STATE_ARMED;
+    return ESP_OK;
+}
+
+/**
+ * @brief Disarm capture
+ */
+esp_err_t bmi270_capture_disarm(bmi270_capture_t *cap) {
+    if (cap == NULL || cap->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_capture_disarm");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = capture_pause_fifo(cap);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    cap->state = BMI270_CAPTURE_STATE_IDLE;
+    return ESP_OK;
+}
+
+/**
+ * @brief Start a capture window from a host or external trigger
+ */
+esp_err_t bmi270_capture_trigger(bmi270_capture_t *cap, bmi270_capture_trigger_t source) {
+    if (cap == NULL || cap->dev == NULL || source == BMI270_CAPTURE_TRIGGER_ANY_MOTION) {
+        ESP_LOGE(TAG, "Invalid parameters in bmi270_capture_trigger");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (cap->state != BMI270_CAPTURE_STATE_ARMED) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return capture_start(cap, source);
+}
+
+/**
+ * @brief Service capture interrupts
+ */
+esp_err_t bmi270_capture_service(bmi270_capture_t *cap) {
+    if (cap == NULL || cap->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_capture_service");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t status;
+    esp_err_t ret = bmi270_read_int_status(cap->dev, &status);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    uint8_t int_status_0 = status & 0xFF;
+    uint8_t int_status_1 = status >> 8;
+
+    if (cap->state == BMI270_CAPTURE_STATE_CAPTURING &&
+        (int_status_1 & BMI270_INT_STATUS_FFULL)) {
+        ret = capture_drain(cap);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to drain capture window");
+            return ret;
+        }
+    }
+
+    // Any-motion may arrive together with FIFO full; start the next window right away
+    if (cap->state == BMI270_CAPTURE_STATE_ARMED && cap->config.any_motion_trigger &&
+        (int_status_0 & BMI270_INT_STATUS_ANY_MOTION)) {
+        ret = capture_start(cap, BMI270_CAPTURE_TRIGGER_ANY_MOTION);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to start capture on any-motion");
+            return ret;
+        }
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Get current capture state
+ */
+bmi270_capture_state_t bmi270_capture_get_state(const bmi270_capture_t *cap) {
+    if (cap == NULL) {
+        return BMI270_CAPTURE_STATE_IDLE;
+    }
+    return cap->state;
+}
@@ -32,6 +32,7 @@
 
 #include "bmi270_data.h"
 #include "bmi270_defs.h"
+#include "bmi270_internal.h"
 #include "esp_log.h"
 
 static const char *TAG = "BMI270_DATA";
@@ -46,7 +47,7 @@ extern esp_err_t bmi270_read_burst(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t
 /**
  * @brief Get scale factor for accelerometer based on range setting
  */
-static float bmi270_get_accel_scale(uint8_t range) {
+float bmi270_get_accel_scale(uint8_t range) {
     switch (range) {
         case BMI270_ACC_RANGE_2G:  return BMI270_ACC_SCALE_2G;
         case BMI270_ACC_RANGE_4G:  return BMI270_ACC_SCALE_4G;
@@ -59,7 +60,7 @@ static float bmi270_get_accel_scale(uint8_t range) {
 /**
  * @brief Get scale factor for gyroscope based on range setting
  */
-static float bmi270_get_gyro_scale(uint8_t range) {
+float bmi270_get_gyro_scale(uint8_t range) {
     switch (range) {
         case BMI270_GYR_RANGE_125DPS:  return BMI270_GYR_SCALE_125DPS;
         case BMI270_GYR_RANGE_250DPS:  return BMI270_GYR_SCALE_250DPS;
@@ -0,0 +1,244 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/**
+ * @file bmi270_decimator.c
+ * @brief BMI270 Integer CIC/Boxcar Decimator Implementation
+ *
+ * Integrators and combs run modulo 2^32: intermediate wrap-around cancels
+ * in the comb as long as the final output fits in int32, which is what
+ * BMI270_DECIMATOR_MAX_GAIN guarantees.
+ */
+
+#include <string.h>
+#include "bmi270_decimator.h"
+#include "bmi270_defs.h"
+#include "bmi270_internal.h"
+#include "esp_log.h"
+
+static const char *TAG = "BMI270_DECIMATOR";
+
+// Droop compensation FIR [-a, 1 + 2a, -a] in Q14, per CIC order.
+// a makes the response flat again at a quarter of the output rate:
+// (1 + 2a) * sinc(1/4)^order = 1
+#define COMP_Q          14
+#define COMP_ONE        (1 << COMP_Q)
+static const int32_t s_comp_a[BMI270_DECIMATOR_MAX_ORDER] = { 907, 1914, 3033 };
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Recompute the cached output scale for the current ranges
+ */
+static void update_scale(bmi270_decimator_t *dec) {
+    float acc_lsb = bmi270_get_accel_scale(dec->dev->acc_range);
+    float gyr_lsb = bmi270_get_gyro_scale(dec->dev->gyr_range);
+
+    for (int i = 0; i < 2; i++) {
+        // CIC gain: window^order (order 1 may alternate between two windows)
+        float gain = 1.0f;
+        for (uint8_t stage = 0; stage < dec->config.order; stage++) {
+            gain *= (float)(dec->window_min + i);
+        }
+        dec->acc_scale[i] = 1.0f / (gain * acc_lsb);
+        dec->gyr_scale[i] = BMI270_DEG_TO_RAD / (gain * gyr_lsb);
+    }
+    dec->scale_acc_range = dec->dev->acc_range;
+    dec->scale_gyr_range = dec->dev->gyr_range;
+}
+
+/**
+ * @brief Comb stages and optional compensation for one output
+ *
+ * @return true if the output is valid (filter settled)
+ */
+static bool finish_output(bmi270_decimator_t *dec, int32_t y[BMI270_DECIMATOR_CHANNELS]) {
+    uint8_t order = dec->config.order;
+
+    for (int ch = 0; ch < BMI270_DECIMATOR_CHANNELS; ch++) {
+        uint32_t v = dec->integ[order - 1][ch];
+        for (uint8_t stage = 0; stage < order; stage++) {
+            uint32_t prev = dec->comb[stage][ch];
+            dec->comb[stage][ch] = v;
+            v -= prev;
+        }
+        y[ch] = (int32_t)v;
+    }
+
+    if (dec->config.compensate) {
+        int32_t a = s_comp_a[order - 1];
+        for (int ch = 0; ch < BMI270_DECIMATOR_CHANNELS; ch++) {
+            int32_t x0 = y[ch];
+            int32_t x1 = dec->history[0][ch];
+            int32_t x2 = dec->history[1][ch];
+            int64_t acc = (int64_t)(COMP_ONE + 2 * a) * x1 - (int64_t)a * ((int64_t)x0 + x2);
+            dec->history[1][ch] = x1;
+            dec->history[0][ch] = x0;
+            // Unity DC gain, so the result stays within the CIC output range
+            y[ch] = (int32_t)(acc >> COMP_Q);
+        }
+    }
+
+    if (dec->warmup > 0) {
+        dec->warmup--;
+        return false;
+    }
+    return true;
+}
+
+/* ====== Decimator Functions ====== */
+
+esp_err_t bmi270_decimator_init(bmi270_decimator_t *dec, bmi270_dev_t *dev,
+                                const bmi270_decimator_config_t *config) {
+    if (dec == NULL || dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_decimator_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->order < 1 || config->order > BMI270_DECIMATOR_MAX_ORDER ||
+        config->output_rate_hz == 0 || config->output_rate_hz > config->input_rate_hz) {
+        ESP_LOGE(TAG, "Invalid decimator config: order %u, %lu Hz -> %lu Hz", config->order,
+                 (unsigned long)config->input_rate_hz, (unsigned long)config->output_rate_hz);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t ratio = config->input_rate_hz / config->output_rate_hz;
+    bool integer_ratio = (config->input_rate_hz % config->output_rate_hz) == 0;
+    if (!integer_ratio && (config->order > 1 || config->compensate)) {
+        // Windows of different length have different gains
+        ESP_LOGE(TAG, "CIC order %u%s needs an integer ratio (%lu Hz -> %lu Hz)", config->order,
+                 config->compensate ? " with compensation" : "",
+                 (unsigned long)config->input_rate_hz, (unsigned long)config->output_rate_hz);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Largest window must keep |int16| * window^order within int32
+    uint32_t window_max = integer_ratio ? ratio : ratio + 1;
+    uint64_t gain = 1;
+    for (uint8_t stage = 0; stage < config->order; stage++) {
+        gain *= window_max;
+    }
+    if (gain > BMI270_DECIMATOR_MAX_GAIN) {
+        ESP_LOGE(TAG, "Decimation gain %llu exceeds int32 range (ratio %lu, order %u)",
+                 (unsigned long long)gain, (unsigned long)ratio, config->order);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(dec, 0, sizeof(*dec));
+    dec->dev = dev;
+    dec->config = *config;
+    dec->window_min = (uint16_t)ratio;
+    bmi270_decimator_reset(dec);
+    update_scale(dec);
+
+    ESP_LOGI(TAG, "Decimator: %lu Hz -> %lu Hz, CIC order %u%s", (unsigned long)config->input_rate_hz,
+             (unsigned long)config->output_rate_hz, config->order,
+             config->compensate ? " + compensation" : "");
+    return ESP_OK;
+}
+
+void bmi270_decimator_reset(bmi270_decimator_t *dec) {
+    if (dec == NULL) {
+        return;
+    }
+    memset(dec->integ, 0, sizeof(dec->integ));
+    memset(dec->comb, 0, sizeof(dec->comb));
+    memset(dec->history, 0, sizeof(dec->history));
+    dec->phase = 0;
+    dec->window = 0;
+    // CIC transient lasts order - 1 outputs; the FIR needs two more
+    dec->warmup = (uint8_t)(dec->config.order - 1 + (dec->config.compensate ? 2 : 0));
+}
+
+esp_err_t bmi270_decimator_process(bmi270_decimator_t *dec, const bmi270_fifo_sample_t *samples,
+                                   uint16_t count, bmi270_decimator_output_t *out,
+                                   uint16_t max_out, uint16_t *out_count) {
+    if (dec == NULL || (samples == NULL && count > 0) || out == NULL || out_count == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_decimator_process");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t order = dec->config.order;
+    uint32_t input_rate = dec->config.input_rate_hz;
+    uint32_t output_rate = dec->config.output_rate_hz;
+    uint16_t produced = 0;
+    uint32_t dropped = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const bmi270_fifo_sample_t *s = &samples[i];
+        uint32_t x[BMI270_DECIMATOR_CHANNELS] = {
+            (uint32_t)(int32_t)s->gyr.x, (uint32_t)(int32_t)s->gyr.y, (uint32_t)(int32_t)s->gyr.z,
+            (uint32_t)(int32_t)s->acc.x, (uint32_t)(int32_t)s->acc.y, (uint32_t)(int32_t)s->acc.z,
+        };
+
+        // Integrator cascade at the input rate
+        for (int ch = 0; ch < BMI270_DECIMATOR_CHANNELS; ch++) {
+            dec->integ[0][ch] += x[ch];
+        }
+        for (uint8_t stage = 1; stage < order; stage++) {
+            for (int ch = 0; ch < BMI270_DECIMATOR_CHANNELS; ch++) {
+                dec->integ[stage][ch] += dec->integ[stage - 1][ch];
+            }
+        }
+        dec->window++;
+
+        dec->phase += output_rate;
+        if (dec->phase < input_rate) {
+            continue;
+        }
+        dec->phase -= input_rate;
+
+        // Output sample: combs, compensation, one conversion with the cached scale
+        int32_t y[BMI270_DECIMATOR_CHANNELS];
+        int scale_index = (dec->window > dec->window_min) ? 1 : 0;
+        dec->window = 0;
+        if (!finish_output(dec, y)) {
+            continue;
+        }
+        if (produced >= max_out) {
+            dropped++;
+            continue;
+        }
+        if (dec->dev->acc_range != dec->scale_acc_range || dec->dev->gyr_range != dec->scale_gyr_range) {
+            update_scale(dec);
+        }
+
+        float gyr_scale = dec->gyr_scale[scale_index];
+        float acc_scale = dec->acc_scale[scale_index];
+        bmi270_decimator_output_t *o = &out[produced++];
+        o->gyr.x = (float)y[0] * gyr_scale;
+        o->gyr.y = (float)y[1] * gyr_scale;
+        o->gyr.z = (float)y[2] * gyr_scale;
+        o->acc.x = (float)y[3] * acc_scale;
+        o->acc.y = (float)y[4] * acc_scale;
+        o->acc.z = (float)y[5] * acc_scale;
+        o->sample_index = i;
+    }
+
+    dec->outputs += produced;
+    dec->dropped_outputs += dropped;
+    *out_count = produced;
+    return (dropped > 0) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
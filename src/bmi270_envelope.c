@@ -0,0 +1,271 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_envelope.c
+ * @brief BMI270 Peak-Preserving Telemetry Downsampler Implementation
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "bmi270_envelope.h"
+#include "bmi270_defs.h"
+#include "bmi270_internal.h"
+#include "esp_log.h"
+
+static const char *TAG = "BMI270_ENVELOPE";
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Recompute the cached output scale for the current ranges
+ */
+static void update_scale(bmi270_envelope_t *env) {
+    float gyr_scale = BMI270_DEG_TO_RAD / bmi270_get_gyro_scale(env->dev->gyr_range);
+    float acc_scale = 1.0f / bmi270_get_accel_scale(env->dev->acc_range);
+
+    for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+        env->scale[ch] = (ch < 3) ? gyr_scale : acc_scale;
+    }
+    env->scale_acc_range = env->dev->acc_range;
+    env->scale_gyr_range = env->dev->gyr_range;
+}
+
+/**
+ * @brief Start an empty window
+ */
+static void window_clear(bmi270_envelope_window_t *w) {
+    for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+        w->min[ch] = INT16_MAX;
+        w->max[ch] = INT16_MIN;
+        w->sum[ch] = 0;
+    }
+}
+
+/**
+ * @brief Largest-triangle point of the pending window for one channel
+ *
+ * Triangle: previous point A, candidate B in the pending window, mean C of
+ * the window just completed. Positions are in half samples relative to the
+ * pending window start and values are scaled by the window length, so the
+ * doubled area stays exact in int64.
+ *
+ * @return Offset of the selected sample in the pending window
+ */
+static uint16_t lttb_select(const bmi270_envelope_t *env, int ch) {
+    const int16_t (*bucket)[BMI270_ENVELOPE_CHANNELS] = env->bucket[env->bucket_current ^ 1];
+    int64_t n = env->window_len;
+    int64_t ax = env->anchor_pos[ch];
+    int64_t ay = (int64_t)env->anchor[ch] * n;
+    int64_t cx = 2 * n + (n - 1);       // Centre of the completed window
+    int64_t cy = env->current.sum[ch];
+
+    uint16_t best = 0;
+    int64_t best_area = -1;
+    for (uint16_t j = 0; j < env->window_len; j++) {
+        int64_t bx = 2 * (int64_t)j;
+        int64_t by = (int64_t)bucket[j][ch] * n;
+        int64_t area = llabs((ax - cx) * (by - ay) - (ax - bx) * (cy - ay));
+        if (area > best_area) {
+            best_area = area;
+            best = j;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Convert a window to physical units
+ */
+static void fill_output(const bmi270_envelope_t *env, const bmi270_envelope_window_t *w,
+                        bmi270_envelope_output_t *o) {
+    float inv_window = 1.0f / (float)env->window_len;
+    for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+        float scale = env->scale[ch];
+        o->ch[ch].min = (float)w->min[ch] * scale;
+        o->ch[ch].max = (float)w->max[ch] * scale;
+        o->ch[ch].mean = (float)w->sum[ch] * inv_window * scale;
+    }
+}
+
+/**
+ * @brief Close the current window; returns true if an output was produced
+ */
+static bool finish_window(bmi270_envelope_t *env, bmi270_envelope_output_t *o) {
+    uint32_t number = env->windows++;
+    int32_t n = env->window_len;
+
+    if (env->config.mode == BMI270_ENVELOPE_MINMAX) {
+        if (o != NULL) {
+            fill_output(env, &env->current, o);
+            for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+                // Extreme: the bound farther from the mean (compared as window sums)
+                int32_t above = env->current.max[ch] * n - env->current.sum[ch];
+                int32_t below = env->current.sum[ch] - env->current.min[ch] * n;
+                bool upper = (above >= below);
+                o->ch[ch].point = (float)(upper ? env->current.max[ch] : env->current.min[ch]) * env->scale[ch];
+                o->ch[ch].point_offset = upper ? env->current.max_at[ch] : env->current.min_at[ch];
+            }
+            o->window = number;
+        }
+        window_clear(&env->current);
+        return o != NULL;
+    }
+
+    // LTTB: the first window only seeds the anchor
+    bool produced = false;
+    if (!env->has_pending) {
+        for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+            env->anchor[ch] = env->bucket[env->bucket_current][0][ch];
+            env->anchor_pos[ch] = 0;
+        }
+        env->has_pending = true;
+    } else {
+        const int16_t (*pending)[BMI270_ENVELOPE_CHANNELS] = env->bucket[env->bucket_current ^ 1];
+        if (o != NULL) {
+            fill_output(env, &env->pending, o);
+            o->window = number - 1;
+        }
+        for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+            uint16_t j = lttb_select(env, ch);
+            if (o != NULL) {
+                o->ch[ch].point = (float)pending[j][ch] * env->scale[ch];
+                o->ch[ch].point_offset = j;
+            }
+            // The selected point anchors the next triangle; re-base it on the completed window
+            env->anchor[ch] = pending[j][ch];
+            env->anchor_pos[ch] = 2 * (int32_t)j - 2 * n;
+        }
+        produced = (o != NULL);
+    }
+
+    env->pending = env->current;
+    env->bucket_current ^= 1;
+    window_clear(&env->current);
+    return produced;
+}
+
+/* ====== Downsampler Functions ====== */
+
+esp_err_t bmi270_envelope_init(bmi270_envelope_t *env, bmi270_dev_t *dev,
+                               const bmi270_envelope_config_t *config) {
+    if (env == NULL || dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_envelope_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->output_rate_hz == 0 || config->input_rate_hz % config->output_rate_hz != 0 ||
+        config->input_rate_hz / config->output_rate_hz < 2 ||
+        config->input_rate_hz / config->output_rate_hz > BMI270_ENVELOPE_MAX_WINDOW ||
+        (config->mode != BMI270_ENVELOPE_MINMAX && config->mode != BMI270_ENVELOPE_LTTB)) {
+        ESP_LOGE(TAG, "Invalid envelope config: mode %d, %lu Hz -> %lu Hz (integer ratio 2-%d)",
+                 config->mode, (unsigned long)config->input_rate_hz,
+                 (unsigned long)config->output_rate_hz, BMI270_ENVELOPE_MAX_WINDOW);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(env, 0, sizeof(*env));
+    env->dev = dev;
+    env->config = *config;
+    env->window_len = (uint16_t)(config->input_rate_hz / config->output_rate_hz);
+    bmi270_envelope_reset(env);
+    update_scale(env);
+
+    ESP_LOGI(TAG, "Envelope: %lu Hz -> %lu Hz (%u samples per window), %s",
+             (unsigned long)config->input_rate_hz, (unsigned long)config->output_rate_hz,
+             env->window_len, config->mode == BMI270_ENVELOPE_LTTB ? "LTTB" : "min/max");
+    return ESP_OK;
+}
+
+void bmi270_envelope_reset(bmi270_envelope_t *env) {
+    if (env == NULL) {
+        return;
+    }
+    env->fill = 0;
+    env->windows = 0;
+    env->has_pending = false;
+    env->bucket_current = 0;
+    window_clear(&env->current);
+    window_clear(&env->pending);
+}
+
+esp_err_t bmi270_envelope_process(bmi270_envelope_t *env, const bmi270_fifo_sample_t *samples,
+                                  uint16_t count, bmi270_envelope_output_t *out,
+                                  uint16_t max_out, uint16_t *out_count) {
+    if (env == NULL || (samples == NULL && count > 0) || out == NULL || out_count == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_envelope_process");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool lttb = (env->config.mode == BMI270_ENVELOPE_LTTB);
+    uint16_t produced = 0;
+    uint32_t dropped = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const bmi270_fifo_sample_t *s = &samples[i];
+        int16_t x[BMI270_ENVELOPE_CHANNELS] = {
+            s->gyr.x, s->gyr.y, s->gyr.z, s->acc.x, s->acc.y, s->acc.z,
+        };
+
+        bmi270_envelope_window_t *w = &env->current;
+        for (int ch = 0; ch < BMI270_ENVELOPE_CHANNELS; ch++) {
+            if (x[ch] < w->min[ch]) {
+                w->min[ch] = x[ch];
+                w->min_at[ch] = env->fill;
+            }
+            if (x[ch] > w->max[ch]) {
+                w->max[ch] = x[ch];
+                w->max_at[ch] = env->fill;
+            }
+            w->sum[ch] += x[ch];
+        }
+        if (lttb) {
+            memcpy(env->bucket[env->bucket_current][env->fill], x, sizeof(x));
+        }
+
+        if (++env->fill < env->window_len) {
+            continue;
+        }
+        env->fill = 0;
+
+        // One conversion per output with the cached scale
+        if (env->dev->acc_range != env->scale_acc_range || env->dev->gyr_range != env->scale_gyr_range) {
+            update_scale(env);
+        }
+        bmi270_envelope_output_t *o = (produced < max_out) ? &out[produced] : NULL;
+        bool has_output = lttb ? env->has_pending : true;
+        if (has_output && o == NULL) {
+            dropped++;
+        }
+        if (finish_window(env, o)) {
+            o->sample_index = i;
+            produced++;
+        }
+    }
+
+    env->outputs += produced;
+    env->dropped_outputs += dropped;
+    *out_count = produced;
+    return dropped > 0 ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
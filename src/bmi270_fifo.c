@@ -0,0 +1,368 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_fifo.c
+ * @brief BMI270 FIFO Implementation
+ *
+ * This file implements FIFO configuration, burst reading and
+ * header-mode frame parsing for the BMI270 sensor.
+ */
+
+#include <string.h>
+#include "bmi270_fifo.h"
+#include "bmi270_defs.h"
+#include "esp_log.h"
+
+static const char *TAG = "BMI270_FIFO";
+
+// Forward declarations from bmi270_spi.c
+extern esp_err_t bmi270_read_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data);
+extern esp_err_t bmi270_write_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t data);
+extern esp_err_t bmi270_read_burst(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data, size_t length);
+extern esp_err_t bmi270_write_burst(bmi270_dev_t *dev, uint8_t reg_addr, const uint8_t *data, size_t length);
+
+/* ====== FIFO Configuration Functions ====== */
+
+/**
+ * @brief Configure FIFO mode, enabled sensors and watermark
+ *
+ * FIFO_WTM_0 (0x46) to FIFO_CONFIG_1 (0x49) are contiguous, so the
+ * whole configuration is written in one burst.
+ */
+esp_err_t bmi270_fifo_configure(bmi270_dev_t *dev, const bmi270_fifo_config_t *config) {
+    if (dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_configure");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (config->watermark >= BMI270_FIFO_SIZE) {
+        ESP_LOGE(TAG, "Invalid FIFO watermark: %u bytes", config->watermark);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t fifo_config_0 = config->stop_on_full ? BMI270_FIFO_STOP_ON_FULL : 0x00;
+    uint8_t fifo_config_1 = 0x00;
+    if (config->acc_enable) {
+        fifo_config_1 |= BMI270_FIFO_ACC_EN;
+    }
+    if (config->gyr_enable) {
+        fifo_config_1 |= BMI270_FIFO_GYR_EN;
+    }
+    if (config->aux_enable) {
+        fifo_config_1 |= BMI270_FIFO_AUX_EN;
+    }
+    if (config->header_enable) {
+        fifo_config_1 |= BMI270_FIFO_HEADER_EN;
+    }
+
+    uint8_t regs[4] = {
+        (uint8_t)(config->watermark & 0xFF),                            // FIFO_WTM_0
+        (uint8_t)((config->watermark >> 8) & BMI270_FIFO_WTM_MSB_MASK), // FIFO_WTM_1
+        fifo_config_0,                                                  // FIFO_CONFIG_0
+        fifo_config_1                                                   // FIFO_CONFIG_1
+    };
+
+    esp_err_t ret = bmi270_write_burst(dev, BMI270_REG_FIFO_WTM_0, regs, sizeof(regs));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write FIFO configuration");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "FIFO configured: %s mode, CONFIG_1=0x%02X, watermark=%u bytes",
+             config->stop_on_full ? "FIFO (stop-on-full)" : "Stream",
+             fifo_config_1, config->watermark);
+    return ESP_OK;
+}
+
+/**
+ * @brief Set FIFO watermark level
+ */
+esp_err_t bmi270_fifo_set_watermark(bmi270_dev_t *dev, uint16_t watermark) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_set_watermark");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (watermark >= BMI270_FIFO_SIZE) {
+        ESP_LOGE(TAG, "Invalid FIFO watermark: %u bytes", watermark);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t wtm[2] = {
+        (uint8_t)(watermark & 0xFF),
+        (uint8_t)((watermark >> 8) & BMI270_FIFO_WTM_MSB_MASK)
+    };
+
+    esp_err_t ret = bmi270_write_burst(dev, BMI270_REG_FIFO_WTM_0, wtm, sizeof(wtm));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write FIFO watermark");
+        return ret;
+    }
+
+    ESP_LOGD(TAG, "FIFO watermark set to %u bytes", watermark);
+    return ESP_OK;
+}
+
+/**
+ * @brief Enable or disable sensor data in FIFO
+ */
+esp_err_t bmi270_fifo_set_sensors(bmi270_dev_t *dev, bool acc_enable, bool gyr_enable) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_set_sensors");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Read current FIFO_CONFIG_1 to preserve header mode
+    uint8_t fifo_config_1;
+    esp_err_t ret = bmi270_read_register(dev, BMI270_REG_FIFO_CONFIG_1, &fifo_config_1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read FIFO_CONFIG_1");
+        return ret;
+    }
+
+    fifo_config_1 &= ~(BMI270_FIFO_ACC_EN | BMI270_FIFO_GYR_EN);
+    if (acc_enable) {
+        fifo_config_1 |= BMI270_FIFO_ACC_EN;
+    }
+    if (gyr_enable) {
+        fifo_config_1 |= BMI270_FIFO_GYR_EN;
+    }
+
+    ret = bmi270_write_register(dev, BMI270_REG_FIFO_CONFIG_1, fifo_config_1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write FIFO_CONFIG_1");
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Flush FIFO
+ */
+esp_err_t bmi270_fifo_flush(bmi270_dev_t *dev) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_flush");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = bmi270_write_register(dev, BMI270_REG_CMD, BMI270_CMD_FIFO_FLUSH);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to flush FIFO");
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+/* ====== FIFO Reading Functions ====== */
+
+/**
+ * @brief Read current FIFO fill level
+ */
+esp_err_t bmi270_fifo_get_length(bmi270_dev_t *dev, uint16_t *length) {
+    if (dev == NULL || length == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_get_length");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t length_data[2];
+    esp_err_t ret = bmi270_read_burst(dev, BMI270_REG_FIFO_LENGTH_0, length_data, 2);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read FIFO length");
+        return ret;
+    }
+
+    *length = (uint16_t)((length_data[1] << 8) | length_data[0]) & BMI270_FIFO_LENGTH_MASK;
+    return ESP_OK;
+}
+
+/**
+ * @brief Read FIFO data in a single burst transaction
+ */
+esp_err_t bmi270_fifo_read(bmi270_dev_t *dev, uint8_t *buffer, uint16_t length) {
+    if (dev == NULL || buffer == NULL || length == 0 || length > BMI270_FIFO_SIZE) {
+        ESP_LOGE(TAG, "Invalid parameters in bmi270_fifo_read");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = bmi270_read_burst(dev, BMI270_REG_FIFO_DATA, buffer, length);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read FIFO data (%u bytes)", length);
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+/* ====== FIFO Parsing Functions ====== */
+
+/**
+ * @brief Decode one little-endian 3-axis sample
+ */
+static void bmi270_fifo_decode_axes(const uint8_t *p, bmi270_raw_data_t *out) {
+    out->x = (int16_t)((p[1] << 8) | p[0]);
+    out->y = (int16_t)((p[3] << 8) | p[2]);
+    out->z = (int16_t)((p[5] << 8) | p[4]);
+}
+
+/**
+ * @brief Initialize FIFO frame parser
+ */
+void bmi270_fifo_parser_init(bmi270_fifo_parser_t *parser, const uint8_t *data, uint16_t length) {
+    if (parser == NULL) {
+        return;
+    }
+    parser->data = data;
+    parser->length = (data != NULL) ? length : 0;
+    parser->offset = 0;
+}
+
+/**
+ * @brief Parse next FIFO frame
+ *
+ * Regular frame payload order is GYR then ACC (see bmi270_doc_ja.md).
+ * INT tag bits (fh_ext) are ignored when decoding the header.
+ */
+esp_err_t bmi270_fifo_parser_next(bmi270_fifo_parser_t *parser, bmi270_fifo_frame_t *frame) {
+    if (parser == NULL || frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (parser->offset >= parser->length) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const uint8_t *p = &parser->data[parser->offset];
+    uint16_t remaining = parser->length - parser->offset;
+    uint8_t header = p[0];
+    uint8_t header_id = header & ~BMI270_FIFO_HEAD_EXT_MASK;
+    uint16_t frame_size;
+
+    frame->header = header;
+    frame->has_acc = false;
+    frame->has_gyr = false;
+    frame->has_aux = false;
+    frame->value = 0;
+
+    if ((header_id & BMI270_FIFO_HEAD_MODE_MASK) == BMI270_FIFO_HEAD_MODE_REGULAR) {
+        frame->has_aux = (header_id & BMI270_FIFO_HEAD_AUX_BIT) != 0;
+        frame->has_gyr = (header_id & BMI270_FIFO_HEAD_GYR_BIT) != 0;
+        frame->has_acc = (header_id & BMI270_FIFO_HEAD_ACC_BIT) != 0;
+
+        // Over-read marker (no sensor bits set) or unsupported payload
+        if (!frame->has_acc && !frame->has_gyr && !frame->has_aux) {
+            if (header_id == BMI270_FIFO_HEAD_OVER_READ) {
+                return ESP_ERR_NOT_FOUND;
+            }
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if ((header_id & ~(BMI270_FIFO_HEAD_ACC_BIT | BMI270_FIFO_HEAD_GYR_BIT | BMI270_FIFO_HEAD_AUX_BIT)) !=
+            BMI270_FIFO_HEAD_MODE_REGULAR) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+
+        frame_size = 1 + (frame->has_aux ? BMI270_FIFO_AUX_PAYLOAD : 0) +
+                     (frame->has_gyr ? 6 : 0) + (frame->has_acc ? 6 : 0);
+        if (remaining < frame_size) {
+            return ESP_ERR_NOT_FOUND;  // Truncated frame at end of buffer
+        }
+
+        // Payload order: AUX, GYR, ACC
+        frame->type = BMI270_FIFO_FRAME_SENSOR;
+        const uint8_t *payload = &p[1];
+        if (frame->has_aux) {
+            memcpy(frame->aux, payload, BMI270_FIFO_AUX_PAYLOAD);
+            payload += BMI270_FIFO_AUX_PAYLOAD;
+        }
+        if (frame->has_gyr) {
+            bmi270_fifo_decode_axes(payload, &frame->gyr);
+            payload += 6;
+        }
+        if (frame->has_acc) {
+            bmi270_fifo_decode_axes(payload, &frame->acc);
+        }
+    } else {
+        switch (header_id) {
+            case BMI270_FIFO_HEAD_SKIP:
+                frame->type = BMI270_FIFO_FRAME_SKIP;
+                frame_size = 1 + BMI270_FIFO_SKIP_PAYLOAD;
+                if (remaining >= frame_size) {
+                    frame->value = p[1];
+                }
+                break;
+            case BMI270_FIFO_HEAD_SENSOR_TIME:
+                frame->type = BMI270_FIFO_FRAME_SENSOR_TIME;
+                frame_size = 1 + BMI270_FIFO_SENSOR_TIME_PAYLOAD;
+                if (remaining >= frame_size) {
+                    frame->value = (uint32_t)p[1] | ((uint32_t)p[2] << 8) | ((uint32_t)p[3] << 16);
+                }
+                break;
+            case BMI270_FIFO_HEAD_CONFIG_CHANGE:
+                frame->type = BMI270_FIFO_FRAME_CONFIG_CHANGE;
+                frame_size = 1 + BMI270_FIFO_CONFIG_PAYLOAD;
+                break;
+            default:
+                return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (remaining < frame_size) {
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+
+    parser->offset += frame_size;
+    return ESP_OK;
+}
@@ -0,0 +1,393 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_fifo_stream.c
+ * @brief BMI270 FIFO Stream Engine Implementation
+ *
+ * Statistics are updated in a private working copy by the drain task and
+ * published once per drain under a sequence counter (seqlock), so readers
+ * never block the acquisition path.
+ */
+
+#include <string.h>
+#include "bmi270_fifo_stream.h"
+#include "bmi270_batch_pool.h"
+#include "bmi270_defs.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BMI270_FIFO_STREAM";
+
+// Forward declarations from bmi270_spi.c
+extern esp_err_t bmi270_read_burst(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data, size_t length);
+
+// INT_STATUS_1 (0x1D) .. FIFO_LENGTH_1 (0x25) in one burst
+#define STREAM_STATUS_READ_LEN  (BMI270_REG_FIFO_LENGTH_1 - BMI270_REG_INT_STATUS_1 + 1)
+#define STREAM_STATUS_IDX_LEN   (BMI270_REG_FIFO_LENGTH_0 - BMI270_REG_INT_STATUS_1)
+
+// Snapshot retries before giving up (publishing takes a few µs)
+#define STATS_SNAPSHOT_RETRIES  100
+
+/* ====== Statistics Helpers ====== */
+
+/**
+ * @brief Publish working statistics (seqlock writer)
+ */
+static void stream_publish_stats(bmi270_fifo_stream_t *stream) {
+    atomic_fetch_add_explicit(&stream->stats_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&stream->stats_published, &stream->stats_work, sizeof(bmi270_fifo_stats_t));
+    atomic_thread_fence(memory_order_release);
+    atomic_fetch_add_explicit(&stream->stats_seq, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Histogram bin for a latency value (log2 µs)
+ */
+static int stream_latency_bin(uint32_t latency_us) {
+    if (latency_us == 0) {
+        return 0;
+    }
+    int bin = 31 - __builtin_clz(latency_us);
+    return (bin < BMI270_FIFO_STATS_LATENCY_BINS) ? bin : BMI270_FIFO_STATS_LATENCY_BINS - 1;
+}
+
+/**
+ * @brief Record per-drain size, fill level and latency
+ */
+static void stream_record_drain(bmi270_fifo_stream_t *stream, uint16_t fifo_length,
+                                bool has_latency, uint32_t latency_us) {
+    bmi270_fifo_stats_t *stats = &stream->stats_work;
+
+    stats->drains++;
+    stats->bytes_total += fifo_length;
+    if (fifo_length > stats->bytes_max) {
+        stats->bytes_max = fifo_length;
+    }
+
+    int bytes_bin = fifo_length / BMI270_FIFO_STATS_BYTES_BIN_SIZE;
+    if (bytes_bin >= BMI270_FIFO_STATS_BYTES_BINS) {
+        bytes_bin = BMI270_FIFO_STATS_BYTES_BINS - 1;
+    }
+    stats->bytes_hist[bytes_bin]++;
+
+    if (stream->config.watermark > 0) {
+        uint32_t fill_pct = (uint32_t)fifo_length * 100 / stream->config.watermark;
+        uint32_t fill_bin = fill_pct / BMI270_FIFO_STATS_FILL_BIN_PCT;
+        if (fill_bin >= BMI270_FIFO_STATS_FILL_BINS) {
+            fill_bin = BMI270_FIFO_STATS_FILL_BINS - 1;
+        }
+        stats->fill_hist[fill_bin]++;
+    }
+
+    if (has_latency) {
+        stats->latency_hist[stream_latency_bin(latency_us)]++;
+        if (latency_us > stats->latency_max_us) {
+            stats->latency_max_us = latency_us;
+        }
+    }
+}
+
+/* ====== Stream Functions ====== */
+
+/**
+ * @brief Initialize FIFO stream
+ */
+esp_err_t bmi270_fifo_stream_init(bmi270_fifo_stream_t *stream, bmi270_dev_t *dev,
+                                  const bmi270_fifo_stream_config_t *config) {
+    if (stream == NULL || dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_stream_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    stream->dev = dev;
+    stream->config = *config;
+    atomic_init(&stream->stats_seq, 0);
+
+    bmi270_fifo_config_t fifo_config = {
+        .acc_enable = true,
+        .gyr_enable = true,
+        .aux_enable = config->aux_enable,
+        .header_enable = true,
+        .stop_on_full = false,
+        .watermark = config->watermark,
+    };
+    esp_err_t ret = bmi270_fifo_configure(dev, &fifo_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = bmi270_fifo_flush(dev);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = bmi270_enable_fifo_watermark_interrupt(dev, config->int_pin);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "FIFO stream initialized: watermark=%u bytes (%u frames), INT%d",
+             config->watermark, config->watermark / BMI270_FIFO_FRAME_ACC_GYR_SIZE,
+             config->int_pin + 1);
+    return ESP_OK;
+}
+
+/**
+ * @brief Record a watermark interrupt (ISR safe)
+ */
+void IRAM_ATTR bmi270_fifo_stream_notify_from_isr(bmi270_fifo_stream_t *stream) {
+    if (stream == NULL) {
+        return;
+    }
+    // Single 32-bit stores; the drain task pairs them through isr_count
+    stream->isr_time_us = (uint32_t)esp_timer_get_time();
+    stream->isr_count = stream->isr_count + 1;
+}
+
+/**
+ * @brief Read FIFO data of known length, parse it and invoke the callback
+ */
+static esp_err_t stream_drain_frames(bmi270_fifo_stream_t *stream, uint16_t fifo_length,
+                                     bool has_latency, uint32_t event_time_us) {
+    bmi270_fifo_stats_t *stats = &stream->stats_work;
+    bmi270_fifo_batch_t *batch = &stream->batch;
+    uint8_t *buffer = stream->buffer;
+
+    if (fifo_length > BMI270_FIFO_SIZE) {
+        fifo_length = BMI270_FIFO_SIZE;
+    }
+
+    // Lend a pool buffer if one is free; never wait for one
+    bmi270_batch_buf_t *lent = NULL;
+    if (fifo_length > 0 && stream->config.pool != NULL) {
+        lent = bmi270_batch_pool_acquire(stream->config.pool);
+        if (lent != NULL) {
+            batch = &lent->batch;
+            buffer = lent->raw;
+        }
+    }
+
+    batch->sample_count = 0;
+    batch->aux_count = 0;
+    batch->fifo_length = fifo_length;
+    batch->lost_frames = 0;
+    batch->sync_lost = false;
+    batch->raw = buffer;
+    batch->owner = lent;
+
+    if (fifo_length == 0) {
+        stats->empty_drains++;
+        stream_publish_stats(stream);
+        return ESP_OK;
+    }
+
+    // FIFO data burst
+    esp_err_t ret = bmi270_fifo_read(stream->dev, buffer, fifo_length);
+    if (ret != ESP_OK) {
+        bmi270_batch_release(batch);
+        stats->drain_errors++;
+        stream_publish_stats(stream);
+        return ret;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    stream_record_drain(stream, fifo_length, has_latency, (uint32_t)now_us - event_time_us);
+
+    // Parse frames into the batch
+    bmi270_fifo_parser_t parser;
+    bmi270_fifo_frame_t frame;
+    bmi270_spike_filter_t *spike_filter = stream->config.spike_filter;
+    uint16_t spike_steps = 1;   // Sample periods since the previous sample (skip frames widen it)
+    bmi270_fifo_parser_init(&parser, buffer, fifo_length);
+    while ((ret = bmi270_fifo_parser_next(&parser, &frame)) == ESP_OK) {
+        switch (frame.type) {
+            case BMI270_FIFO_FRAME_SENSOR:
+                stats->sensor_frames++;
+                if (frame.has_aux && batch->aux_count < BMI270_FIFO_MAX_AUX_SAMPLES) {
+                    // AUX payload precedes ACC/GYR in the frame; index points at that sample
+                    bmi270_fifo_aux_sample_t *aux = &batch->aux_samples[batch->aux_count++];
+                    memcpy(aux->data, frame.aux, sizeof(aux->data));
+                    aux->sample_index = batch->sample_count;
+                    stats->aux_frames++;
+                }
+                if (frame.has_acc && frame.has_gyr && batch->sample_count < BMI270_FIFO_MAX_SAMPLES) {
+                    bmi270_fifo_sample_t *sample = &batch->samples[batch->sample_count++];
+                    sample->gyr = frame.gyr;
+                    sample->acc = frame.acc;
+                    if (spike_filter != NULL &&
+                        bmi270_spike_process(spike_filter, &sample->gyr, &sample->acc, spike_steps) > 0) {
+                        stats->spike_rejected++;
+                    }
+                    spike_steps = 1;
+                }
+                break;
+            case BMI270_FIFO_FRAME_SKIP:
+                stats->skip_frames++;
+                batch->lost_frames += frame.value;
+                spike_steps += frame.value;
+                break;
+            case BMI270_FIFO_FRAME_SENSOR_TIME:
+                stats->sensor_time_frames++;
+                break;
+            case BMI270_FIFO_FRAME_CONFIG_CHANGE:
+                stats->config_frames++;
+                break;
+        }
+    }
+
+    if (batch->lost_frames > 0) {
+        stats->overflow_events++;
+        stats->lost_frames += batch->lost_frames;
+    }
+
+    if (batch->sample_count == 0) {
+        stats->empty_drains++;
+    }
+
+    esp_err_t flush_ret = ESP_OK;
+    if (ret == ESP_ERR_INVALID_RESPONSE) {
+        // Frame sync lost: remaining bytes cannot be trusted
+        stats->sync_losses++;
+        batch->sync_lost = true;
+        ESP_LOGW(TAG, "FIFO frame sync lost at byte %u/%u, flushing", parser.offset, fifo_length);
+        flush_ret = bmi270_fifo_flush(stream->dev);
+        if (flush_ret != ESP_OK) {
+            // One retry; without the flush the next drain starts mid-frame
+            flush_ret = bmi270_fifo_flush(stream->dev);
+        }
+        if (flush_ret != ESP_OK) {
+            stats->drain_errors++;
+            ESP_LOGE(TAG, "Failed to flush FIFO after sync loss: %s", esp_err_to_name(flush_ret));
+        }
+        bmi270_spike_reset(spike_filter);
+    }
+
+    batch->sequence = stats->drains - 1;
+    batch->drain_time_us = now_us;
+
+    stream_publish_stats(stream);
+
+    if (stream->config.callback != NULL) {
+        stream->config.callback(batch, stream->config.user_ctx);
+    }
+
+    // Drop the engine's reference; consumers that retained the batch keep it alive
+    bmi270_batch_release(batch);
+    return flush_ret;
+}
+
+/**
+ * @brief Drain FIFO, parse the batch and invoke the callback
+ */
+esp_err_t bmi270_fifo_stream_drain(bmi270_fifo_stream_t *stream) {
+    if (stream == NULL || stream->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_stream_drain");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bmi270_fifo_stats_t *stats = &stream->stats_work;
+
+    // Latch the ISR record before touching the bus
+    uint32_t isr_count = stream->isr_count;
+    uint32_t isr_time_us = stream->isr_time_us;
+    bool has_latency = (isr_count != stream->isr_count_seen);
+    stats->watermark_events += isr_count - stream->isr_count_seen;
+    stream->isr_count_seen = isr_count;
+
+    // Transaction 1: INT_STATUS_1 (clears latched INT) + FIFO_LENGTH
+    uint8_t status[STREAM_STATUS_READ_LEN];
+    esp_err_t ret = bmi270_read_burst(stream->dev, BMI270_REG_INT_STATUS_1, status, sizeof(status));
+    if (ret != ESP_OK) {
+        stats->drain_errors++;
+        stream_publish_stats(stream);
+        ESP_LOGE(TAG, "Failed to read FIFO status");
+        return ret;
+    }
+
+    uint16_t fifo_length = (uint16_t)((status[STREAM_STATUS_IDX_LEN + 1] << 8) |
+                                      status[STREAM_STATUS_IDX_LEN]) & BMI270_FIFO_LENGTH_MASK;
+
+    // Transaction 2: FIFO data burst
+    return stream_drain_frames(stream, fifo_length, has_latency, isr_time_us);
+}
+
+/**
+ * @brief Drain FIFO whose length the caller has already read
+ */
+esp_err_t bmi270_fifo_stream_drain_length(bmi270_fifo_stream_t *stream, uint16_t fifo_length,
+                                          uint32_t event_time_us) {
+    if (stream == NULL || stream->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_stream_drain_length");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stream->stats_work.watermark_events++;
+    return stream_drain_frames(stream, fifo_length & BMI270_FIFO_LENGTH_MASK, true, event_time_us);
+}
+
+/**
+ * @brief Get a consistent statistics snapshot (seqlock reader)
+ */
+esp_err_t bmi270_fifo_stream_get_stats(bmi270_fifo_stream_t *stream, bmi270_fifo_stats_t *snapshot) {
+    if (stream == NULL || snapshot == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_fifo_stream_get_stats");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < STATS_SNAPSHOT_RETRIES; i++) {
+        unsigned seq_begin = atomic_load_explicit(&stream->stats_seq, memory_order_acquire);
+        if (seq_begin & 1) {
+            continue;  // Publisher active
+        }
+        memcpy(snapshot, &stream->stats_published, sizeof(bmi270_fifo_stats_t));
+        atomic_thread_fence(memory_order_acquire);
+        unsigned seq_end = atomic_load_explicit(&stream->stats_seq, memory_order_relaxed);
+        if (seq_begin == seq_end) {
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_TIMEOUT;
+}
+
+/**
+ * @brief Reset statistics
+ */
+void bmi270_fifo_stream_reset_stats(bmi270_fifo_stream_t *stream) {
+    if (stream == NULL) {
+        return;
+    }
+    memset(&stream->stats_work, 0, sizeof(bmi270_fifo_stats_t));
+    stream_publish_stats(stream);
+}
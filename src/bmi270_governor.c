@@ -0,0 +1,305 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_governor.c
+ * @brief BMI270 Deadline-Aware Load Governor Implementation
+ */
+
+#include <string.h>
+#include "bmi270_governor.h"
+#include "bmi270_batch_pool.h"
+#include "bmi270_defs.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BMI270_GOVERNOR";
+
+// Cost estimates lose 1/16 per batch, so a one-off spike stops blocking a stage after a while
+#define GOVERNOR_ESTIMATE_DECAY_SHIFT   4
+
+// ISR timestamps older than this many periods are stale (missed notify)
+#define GOVERNOR_ISR_STALE_PERIODS      4
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Time spent since the watermark that produced this batch [µs]
+ */
+static uint32_t governor_lateness(bmi270_governor_t *gov, const bmi270_fifo_batch_t *batch, int64_t now_us) {
+    const bmi270_fifo_stream_t *stream = gov->stream;
+    uint32_t late_us = 0;
+
+    // Watermark ISR timestamp (lower 32 bits, wraps)
+    uint32_t isr_count = stream->isr_count;
+    if (isr_count != gov->isr_count_seen) {
+        gov->isr_count_seen = isr_count;
+        uint32_t since_isr = (uint32_t)now_us - stream->isr_time_us;
+        if (since_isr < GOVERNOR_ISR_STALE_PERIODS * gov->period_us) {
+            late_us = since_isr;
+        }
+    }
+
+    // Frames above the watermark were produced after it fired
+    uint16_t watermark = stream->config.watermark;
+    if (batch->fifo_length > watermark) {
+        uint32_t extra_frames = (uint32_t)(batch->fifo_length - watermark) / gov->frame_size;
+        uint32_t fill_us = (uint32_t)((uint64_t)extra_frames * 1000000ULL / gov->config.odr_hz);
+        if (fill_us > late_us) {
+            late_us = fill_us;
+        }
+    }
+    return late_us;
+}
+
+/**
+ * @brief Run one stage and update its estimate
+ */
+static void governor_run_stage(bmi270_governor_t *gov, uint8_t index,
+                               const bmi270_fifo_batch_t *batch, bool deferred) {
+    bmi270_governor_stage_t *stage = &gov->stages[index];
+    bmi270_governor_stage_stats_t *stats = &gov->stats.stages[index];
+
+    int64_t start_us = esp_timer_get_time();
+    stage->config.fn(batch, deferred, stage->config.ctx);
+    uint32_t run_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    if (deferred) {
+        stats->replayed++;
+    } else {
+        stats->runs++;
+    }
+    if (run_us > stats->max_us) {
+        stats->max_us = run_us;
+    }
+    if (run_us > stats->estimate_us) {
+        stats->estimate_us = run_us;
+    }
+}
+
+/**
+ * @brief Skip a stage for this batch: queue it if deferrable, shed otherwise
+ */
+static void governor_skip_stage(bmi270_governor_t *gov, uint8_t index, const bmi270_fifo_batch_t *batch) {
+    bmi270_governor_stage_t *stage = &gov->stages[index];
+    bmi270_governor_stage_stats_t *stats = &gov->stats.stages[index];
+
+    gov->stats.shed_by_class[stage->config.cls]++;
+
+    // At the retained limit a stage may only trade its own oldest batch for this one
+    const bmi270_fifo_batch_t *kept = NULL;
+    if (stage->config.deferrable && (gov->retained < gov->retained_limit || stage->queued > 0)) {
+        kept = bmi270_batch_retain(batch);
+    }
+    if (kept == NULL) {
+        stats->shed++;
+        return;
+    }
+
+    if (stage->queued == BMI270_GOVERNOR_MAX_DEFERRED || gov->retained >= gov->retained_limit) {
+        // Oldest work is the least useful: drop it to make room
+        bmi270_batch_release(stage->queue[0]);
+        memmove(&stage->queue[0], &stage->queue[1], (BMI270_GOVERNOR_MAX_DEFERRED - 1) * sizeof(stage->queue[0]));
+        stage->queued--;
+        gov->retained--;
+        stats->deferred_dropped++;
+    }
+    stage->queue[stage->queued++] = kept;
+    gov->retained++;
+    stats->deferred++;
+}
+
+/**
+ * @brief Replay deferred batches of classes above the cut, in class order, while they fit
+ */
+static void governor_replay(bmi270_governor_t *gov, int64_t start_us, uint32_t budget_us,
+                            bmi270_governor_class_t cut) {
+    for (uint8_t i = 0; i < gov->stage_count && gov->stages[i].config.cls < cut; i++) {
+        bmi270_governor_stage_t *stage = &gov->stages[i];
+        while (stage->queued > 0) {
+            uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+            if (elapsed_us + gov->stats.stages[i].estimate_us > budget_us) {
+                // Keep the class order: nothing after this stage runs either
+                return;
+            }
+            const bmi270_fifo_batch_t *batch = stage->queue[0];
+            stage->queued--;
+            gov->retained--;
+            memmove(&stage->queue[0], &stage->queue[1], stage->queued * sizeof(stage->queue[0]));
+            governor_run_stage(gov, i, batch, true);
+            bmi270_batch_release(batch);
+        }
+    }
+}
+
+/* ====== Governor Functions ====== */
+
+esp_err_t bmi270_governor_init(bmi270_governor_t *gov, const bmi270_fifo_stream_t *stream,
+                               const bmi270_governor_config_t *config) {
+    if (gov == NULL || stream == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_governor_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint8_t frame_size = stream->config.aux_enable ? BMI270_FIFO_FRAME_ACC_GYR_AUX_SIZE
+                                                   : BMI270_FIFO_FRAME_ACC_GYR_SIZE;
+    if (config->odr_hz == 0 || config->budget_percent > 100 || stream->config.watermark < frame_size) {
+        ESP_LOGE(TAG, "Invalid governor config: ODR %lu Hz, budget %u%%, watermark %u bytes",
+                 (unsigned long)config->odr_hz, config->budget_percent, stream->config.watermark);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(gov, 0, sizeof(*gov));
+    gov->stream = stream;
+    gov->config = *config;
+    if (gov->config.budget_percent == 0) {
+        gov->config.budget_percent = BMI270_GOVERNOR_DEFAULT_BUDGET;
+    }
+    gov->frame_size = frame_size;
+    gov->watermark_frames = (uint16_t)(stream->config.watermark / frame_size);
+    gov->period_us = (uint32_t)((uint64_t)gov->watermark_frames * 1000000ULL / config->odr_hz);
+    gov->budget_us = gov->period_us * gov->config.budget_percent / 100;
+    gov->isr_count_seen = stream->isr_count;
+    gov->stats.budget_us = gov->budget_us;
+
+    // Every held batch pins a pool buffer; keep one free for the next drain
+    uint8_t pool_count = (stream->config.pool != NULL) ? stream->config.pool->count : 0;
+    gov->retained_limit = config->max_retained;
+    if (gov->retained_limit == 0 && pool_count > 0) {
+        gov->retained_limit = pool_count - 1;
+    }
+
+    ESP_LOGI(TAG, "Governor: %u frames @ %lu Hz = %lu us per batch, budget %lu us (%u%%), retain %u",
+             gov->watermark_frames, (unsigned long)config->odr_hz, (unsigned long)gov->period_us,
+             (unsigned long)gov->budget_us, gov->config.budget_percent, gov->retained_limit);
+    return ESP_OK;
+}
+
+esp_err_t bmi270_governor_add_stage(bmi270_governor_t *gov, const bmi270_governor_stage_config_t *stage) {
+    if (gov == NULL || stage == NULL || stage->fn == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_governor_add_stage");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (stage->cls >= BMI270_GOVERNOR_CLASS_COUNT) {
+        ESP_LOGE(TAG, "Invalid stage class %d", stage->cls);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (gov->stage_count == BMI270_GOVERNOR_MAX_STAGES) {
+        ESP_LOGE(TAG, "Too many stages (max %d)", BMI270_GOVERNOR_MAX_STAGES);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Insert after the last stage of the same or a higher-priority class
+    uint8_t pos = gov->stage_count;
+    while (pos > 0 && gov->stages[pos - 1].config.cls > stage->cls) {
+        gov->stages[pos] = gov->stages[pos - 1];
+        gov->stats.stages[pos] = gov->stats.stages[pos - 1];
+        pos--;
+    }
+    memset(&gov->stages[pos], 0, sizeof(gov->stages[pos]));
+    memset(&gov->stats.stages[pos], 0, sizeof(gov->stats.stages[pos]));
+    gov->stages[pos].config = *stage;
+    gov->stage_count++;
+    gov->stats.stage_count = gov->stage_count;
+    return ESP_OK;
+}
+
+void bmi270_governor_batch_cb(const bmi270_fifo_batch_t *batch, void *user_ctx) {
+    bmi270_governor_t *gov = user_ctx;
+    if (gov == NULL || batch == NULL) {
+        return;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    uint32_t late_us = governor_lateness(gov, batch, start_us);
+    uint32_t budget_us = (late_us < gov->budget_us) ? gov->budget_us - late_us : 0;
+
+    gov->stats.batches++;
+    // Deferred samples from before a resync are stale, and the stream needs their buffers
+    if (batch->sync_lost) {
+        bmi270_governor_flush(gov);
+    }
+    if (budget_us < gov->budget_us / 2) {
+        gov->stats.late_batches++;
+    }
+    for (uint8_t i = 0; i < gov->stage_count; i++) {
+        gov->stats.stages[i].estimate_us -= gov->stats.stages[i].estimate_us >> GOVERNOR_ESTIMATE_DECAY_SHIFT;
+    }
+
+    // Stages are sorted by class; the first class that does not fit cuts all lower ones
+    bmi270_governor_class_t cut = BMI270_GOVERNOR_CLASS_COUNT;
+    for (uint8_t i = 0; i < gov->stage_count; i++) {
+        bmi270_governor_class_t cls = gov->stages[i].config.cls;
+        if (cls != BMI270_GOVERNOR_CRITICAL) {
+            uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+            if (cls >= cut || elapsed_us + gov->stats.stages[i].estimate_us > budget_us) {
+                if (cls < cut) {
+                    cut = cls;
+                }
+                governor_skip_stage(gov, i, batch);
+                continue;
+            }
+        }
+        governor_run_stage(gov, i, batch, false);
+    }
+
+    // Telemetry being shed must not starve deferred logging
+    governor_replay(gov, start_us, budget_us, cut);
+    if (cut != BMI270_GOVERNOR_CLASS_COUNT) {
+        gov->stats.shed_batches++;
+    }
+
+    uint32_t total_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (total_us > budget_us) {
+        gov->stats.overruns++;
+    }
+    if (total_us > gov->stats.max_callback_us) {
+        gov->stats.max_callback_us = total_us;
+    }
+}
+
+void bmi270_governor_flush(bmi270_governor_t *gov) {
+    if (gov == NULL) {
+        return;
+    }
+    for (uint8_t i = 0; i < gov->stage_count; i++) {
+        bmi270_governor_stage_t *stage = &gov->stages[i];
+        for (uint8_t q = 0; q < stage->queued; q++) {
+            bmi270_batch_release(stage->queue[q]);
+        }
+        gov->stats.stages[i].deferred_dropped += stage->queued;
+        stage->queued = 0;
+    }
+    gov->retained = 0;
+}
+
+esp_err_t bmi270_governor_get_stats(const bmi270_governor_t *gov, bmi270_governor_stats_t *stats) {
+    if (gov == NULL || stats == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_governor_get_stats");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *stats = gov->stats;
+    return ESP_OK;
+}
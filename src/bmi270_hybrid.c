@@ -0,0 +1,341 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_hybrid.c
+ * @brief BMI270 Hybrid Data-Ready + FIFO Acquisition Implementation
+ *
+ * The latest sample and the statistics are published under sequence
+ * counters (seqlock), so the rate loop and monitoring tasks never block
+ * the service task.
+ */
+
+#include <string.h>
+#include "bmi270_hybrid.h"
+#include "bmi270_defs.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BMI270_HYBRID";
+
+// Forward declarations from bmi270_spi.c
+extern esp_err_t bmi270_read_burst(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data, size_t length);
+
+// ACC_X_LSB (0x0C) .. FIFO_LENGTH_1 (0x25) in one burst
+#define HYBRID_READ_LEN         (BMI270_REG_FIFO_LENGTH_1 - BMI270_REG_ACC_X_LSB + 1)
+#define HYBRID_IDX_ACC          (BMI270_REG_ACC_X_LSB - BMI270_REG_ACC_X_LSB)
+#define HYBRID_IDX_GYR          (BMI270_REG_GYR_X_LSB - BMI270_REG_ACC_X_LSB)
+#define HYBRID_IDX_SENSORTIME   (BMI270_REG_SENSORTIME_0 - BMI270_REG_ACC_X_LSB)
+#define HYBRID_IDX_INT_STATUS_0 (BMI270_REG_INT_STATUS_0 - BMI270_REG_ACC_X_LSB)
+#define HYBRID_IDX_INT_STATUS_1 (BMI270_REG_INT_STATUS_1 - BMI270_REG_ACC_X_LSB)
+#define HYBRID_IDX_FIFO_LENGTH  (BMI270_REG_FIFO_LENGTH_0 - BMI270_REG_ACC_X_LSB)
+
+// Sensor time: 24-bit counter, 39.0625µs/LSB
+#define HYBRID_SENSORTIME_MASK  0x00FFFFFFU
+#define HYBRID_SENSORTIME_HZ    25600U
+
+// Snapshot retries before giving up (publishing takes a few µs)
+#define SNAPSHOT_RETRIES        100
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Decode three little-endian int16 axes
+ */
+static void hybrid_decode_axes(const uint8_t *data, bmi270_raw_data_t *raw) {
+    raw->x = (int16_t)((data[1] << 8) | data[0]);
+    raw->y = (int16_t)((data[3] << 8) | data[2]);
+    raw->z = (int16_t)((data[5] << 8) | data[4]);
+}
+
+/**
+ * @brief Histogram bin for a latency value (log2 µs)
+ */
+static int hybrid_latency_bin(uint32_t latency_us) {
+    if (latency_us == 0) {
+        return 0;
+    }
+    int bin = 31 - __builtin_clz(latency_us);
+    return (bin < BMI270_FIFO_STATS_LATENCY_BINS) ? bin : BMI270_FIFO_STATS_LATENCY_BINS - 1;
+}
+
+/**
+ * @brief Sample periods since the previous filtered sample, from the sensor time
+ */
+static uint16_t hybrid_sample_steps(bmi270_hybrid_t *hybrid, uint32_t sensor_time) {
+    const bmi270_spike_filter_t *filter = hybrid->config.spike_filter;
+    uint32_t elapsed = (sensor_time - hybrid->spike_sensor_time) & HYBRID_SENSORTIME_MASK;
+    bool first = (hybrid->stats_work.samples == 0);
+
+    hybrid->spike_sensor_time = sensor_time;
+    if (first) {
+        return 1;
+    }
+    // Round to whole sample periods
+    uint32_t period = HYBRID_SENSORTIME_HZ / filter->config.sample_rate_hz;
+    uint32_t steps = (period > 0) ? (elapsed + period / 2) / period : 1;
+    if (steps < 1) {
+        steps = 1;
+    }
+    return (steps > UINT16_MAX) ? UINT16_MAX : (uint16_t)steps;
+}
+
+/**
+ * @brief Publish the latest-sample slot (seqlock writer)
+ */
+static void hybrid_publish_sample(bmi270_hybrid_t *hybrid, const bmi270_hybrid_sample_t *sample) {
+    atomic_fetch_add_explicit(&hybrid->latest_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&hybrid->latest, sample, sizeof(bmi270_hybrid_sample_t));
+    atomic_thread_fence(memory_order_release);
+    atomic_fetch_add_explicit(&hybrid->latest_seq, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Publish working statistics (seqlock writer)
+ */
+static void hybrid_publish_stats(bmi270_hybrid_t *hybrid) {
+    atomic_fetch_add_explicit(&hybrid->stats_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&hybrid->stats_published, &hybrid->stats_work, sizeof(bmi270_hybrid_stats_t));
+    atomic_thread_fence(memory_order_release);
+    atomic_fetch_add_explicit(&hybrid->stats_seq, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Copy a seqlock-protected object (seqlock reader)
+ */
+static esp_err_t hybrid_read_seqlock(atomic_uint *seq, const void *src, void *dst, size_t size) {
+    for (int i = 0; i < SNAPSHOT_RETRIES; i++) {
+        unsigned seq_begin = atomic_load_explicit(seq, memory_order_acquire);
+        if (seq_begin & 1) {
+            continue;  // Publisher active
+        }
+        memcpy(dst, src, size);
+        atomic_thread_fence(memory_order_acquire);
+        unsigned seq_end = atomic_load_explicit(seq, memory_order_relaxed);
+        if (seq_begin == seq_end) {
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+/* ====== Hybrid Acquisition Functions ====== */
+
+/**
+ * @brief Initialize hybrid acquisition
+ */
+esp_err_t bmi270_hybrid_init(bmi270_hybrid_t *hybrid, bmi270_dev_t *dev,
+                             const bmi270_hybrid_config_t *config) {
+    if (hybrid == NULL || dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_hybrid_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (config->history_watermark < BMI270_FIFO_FRAME_ACC_GYR_SIZE ||
+        config->history_watermark > BMI270_FIFO_SIZE) {
+        ESP_LOGE(TAG, "Invalid history watermark: %u bytes", config->history_watermark);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(hybrid, 0, sizeof(*hybrid));
+    hybrid->dev = dev;
+    hybrid->config = *config;
+    atomic_init(&hybrid->latest_seq, 0);
+    atomic_init(&hybrid->stats_seq, 0);
+
+    // History path: FIFO setup and flush are shared with the stream engine
+    bmi270_fifo_stream_config_t stream_config = {
+        .watermark = config->history_watermark,
+        .int_pin = config->int_pin,
+        .callback = config->history_callback,
+        .user_ctx = config->user_ctx,
+    };
+    esp_err_t ret = bmi270_fifo_stream_init(&hybrid->history, dev, &stream_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // The watermark is polled through FIFO_LENGTH; only data-ready drives the pin
+    ret = bmi270_disable_fifo_watermark_interrupt(dev, config->int_pin);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = bmi270_enable_data_ready_interrupt(dev, config->int_pin);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Hybrid acquisition initialized: DRDY on INT%d, history watermark=%u bytes (%u frames)",
+             config->int_pin + 1, config->history_watermark,
+             config->history_watermark / BMI270_FIFO_FRAME_ACC_GYR_SIZE);
+    return ESP_OK;
+}
+
+/**
+ * @brief Record a data-ready interrupt (ISR safe)
+ */
+void IRAM_ATTR bmi270_hybrid_notify_from_isr(bmi270_hybrid_t *hybrid) {
+    if (hybrid == NULL) {
+        return;
+    }
+    // Single 32-bit stores; the service task pairs them through isr_count
+    hybrid->isr_time_us = (uint32_t)esp_timer_get_time();
+    hybrid->isr_count = hybrid->isr_count + 1;
+}
+
+/**
+ * @brief Service one data-ready event
+ */
+esp_err_t bmi270_hybrid_service(bmi270_hybrid_t *hybrid) {
+    if (hybrid == NULL || hybrid->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_hybrid_service");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bmi270_hybrid_stats_t *stats = &hybrid->stats_work;
+
+    // Latch the ISR record before touching the bus
+    uint32_t isr_count = hybrid->isr_count;
+    uint32_t isr_time_us = hybrid->isr_time_us;
+    uint32_t new_events = isr_count - hybrid->isr_count_seen;
+    hybrid->isr_count_seen = isr_count;
+    stats->drdy_events += new_events;
+    if (new_events > 1) {
+        stats->missed_drdy += new_events - 1;
+    }
+
+    // Transaction 1: data registers + sensor time + INT_STATUS_0/1 + FIFO_LENGTH
+    uint8_t data[HYBRID_READ_LEN];
+    esp_err_t ret = bmi270_read_burst(hybrid->dev, BMI270_REG_ACC_X_LSB, data, sizeof(data));
+    if (ret != ESP_OK) {
+        stats->bus_errors++;
+        hybrid_publish_stats(hybrid);
+        ESP_LOGE(TAG, "Failed to read data registers");
+        return ret;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    uint8_t int_status_1 = data[HYBRID_IDX_INT_STATUS_1];
+
+    if (int_status_1 & (BMI270_INT_STATUS_ACC_DRDY | BMI270_INT_STATUS_GYR_DRDY)) {
+        // Latest-sample path
+        uint32_t latency_us = (new_events > 0) ? (uint32_t)now_us - isr_time_us : 0;
+
+        bmi270_hybrid_sample_t sample;
+        hybrid_decode_axes(&data[HYBRID_IDX_ACC], &sample.acc);
+        hybrid_decode_axes(&data[HYBRID_IDX_GYR], &sample.gyr);
+        sample.sensor_time = (uint32_t)data[HYBRID_IDX_SENSORTIME] |
+                             ((uint32_t)data[HYBRID_IDX_SENSORTIME + 1] << 8) |
+                             ((uint32_t)data[HYBRID_IDX_SENSORTIME + 2] << 16);
+        sample.int_status = (uint16_t)data[HYBRID_IDX_INT_STATUS_0] | ((uint16_t)int_status_1 << 8);
+        sample.sequence = stats->samples;
+        sample.drdy_time_us = now_us - latency_us;
+        sample.read_time_us = now_us;
+
+        if (hybrid->config.spike_filter != NULL) {
+            uint16_t steps = hybrid_sample_steps(hybrid, sample.sensor_time);
+            if (bmi270_spike_process(hybrid->config.spike_filter, &sample.gyr, &sample.acc, steps) > 0) {
+                stats->spike_rejected++;
+            }
+        }
+
+        hybrid_publish_sample(hybrid, &sample);
+        stats->samples++;
+
+        if (new_events > 0) {
+            stats->latency_hist[hybrid_latency_bin(latency_us)]++;
+            if (latency_us > stats->latency_max_us) {
+                stats->latency_max_us = latency_us;
+            }
+        }
+
+        if (hybrid->config.sample_callback != NULL) {
+            hybrid->config.sample_callback(&sample, hybrid->config.user_ctx);
+        }
+    } else {
+        stats->stale_reads++;
+    }
+
+    // History path: only after the latest sample is out
+    uint16_t fifo_length = (uint16_t)((data[HYBRID_IDX_FIFO_LENGTH + 1] << 8) |
+                                      data[HYBRID_IDX_FIFO_LENGTH]) & BMI270_FIFO_LENGTH_MASK;
+    if (fifo_length >= hybrid->config.history_watermark) {
+        // Transaction 2: FIFO data burst
+        stats->history_drains++;
+        ret = bmi270_fifo_stream_drain_length(&hybrid->history, fifo_length, isr_time_us);
+    }
+
+    hybrid_publish_stats(hybrid);
+    return ret;
+}
+
+/**
+ * @brief Copy the latest sample (seqlock reader)
+ */
+esp_err_t bmi270_hybrid_get_latest(bmi270_hybrid_t *hybrid, bmi270_hybrid_sample_t *sample) {
+    if (hybrid == NULL || sample == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_hybrid_get_latest");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (atomic_load_explicit(&hybrid->latest_seq, memory_order_acquire) == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    return hybrid_read_seqlock(&hybrid->latest_seq, &hybrid->latest, sample, sizeof(*sample));
+}
+
+/**
+ * @brief Get latest-sample path statistics snapshot (seqlock reader)
+ */
+esp_err_t bmi270_hybrid_get_stats(bmi270_hybrid_t *hybrid, bmi270_hybrid_stats_t *snapshot) {
+    if (hybrid == NULL || snapshot == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_hybrid_get_stats");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return hybrid_read_seqlock(&hybrid->stats_seq, &hybrid->stats_published, snapshot, sizeof(*snapshot));
+}
+
+/**
+ * @brief Get history path statistics snapshot
+ */
+esp_err_t bmi270_hybrid_get_history_stats(bmi270_hybrid_t *hybrid, bmi270_fifo_stats_t *snapshot) {
+    if (hybrid == NULL || snapshot == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_hybrid_get_history_stats");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return bmi270_fifo_stream_get_stats(&hybrid->history, snapshot);
+}
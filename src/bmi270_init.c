@@ -70,6 +70,10 @@ esp_err_t bmi270_soft_reset(bmi270_dev_t *dev) {
         return ret;
     }
 
+    // Sensor is back in low-power mode: use low-power access timing until
+    // bmi270_init() completes again (matters when re-initializing)
+    dev->init_complete = false;
+
     // Wait for reset to complete (2ms minimum)
     ESP_LOGI(TAG, "Waiting %d µs for reset to complete...", BMI270_DELAY_SOFT_RESET_US);
     esp_rom_delay_us(BMI270_DELAY_SOFT_RESET_US);
@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_internal.h
+ * @brief Helpers shared between driver sources (not part of the public API)
+ */
+
+#ifndef BMI270_INTERNAL_H
+#define BMI270_INTERNAL_H
+
+#include <stdint.h>
+
+/* ====== Scale Factors (bmi270_data.c) ====== */
+
+/**
+ * @brief Accelerometer sensitivity for a range setting
+ *
+ * @param[in] range ACC_RANGE value (unknown values fall back to ±2g)
+ * @return LSB per g
+ */
+float bmi270_get_accel_scale(uint8_t range);
+
+/**
+ * @brief Gyroscope sensitivity for a range setting
+ *
+ * @param[in] range GYR_RANGE value (unknown values fall back to ±2000°/s)
+ * @return LSB per °/s
+ */
+float bmi270_get_gyro_scale(uint8_t range);
+
+#endif // BMI270_INTERNAL_H
@@ -38,6 +38,48 @@ static const char *TAG = "BMI270_INT";
 // Forward declarations from bmi270_spi.c
 extern esp_err_t bmi270_read_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data);
 extern esp_err_t bmi270_write_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t data);
+extern esp_err_t bmi270_read_burst(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data, size_t length);
+extern esp_err_t bmi270_write_burst(bmi270_dev_t *dev, uint8_t reg_addr, const uint8_t *data, size_t length);
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Set or clear bits in an interrupt mapping register (read-modify-write)
+ */
+static esp_err_t bmi270_update_int_map(bmi270_dev_t *dev, uint8_t reg_addr,
+                                       uint8_t mask, bool enable) {
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_update_int_map");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t map_data;
+    esp_err_t ret = bmi270_read_register(dev, reg_addr, &map_data);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read interrupt map register 0x%02X", reg_addr);
+        return ret;
+    }
+
+    if (enable) {
+        map_data |= mask;
+    } else {
+        map_data &= ~mask;
+    }
+
+    ret = bmi270_write_register(dev, reg_addr, map_data);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write interrupt map register 0x%02X", reg_addr);
+        return ret;
+    }
+
+    ESP_LOGD(TAG, "Interrupt map 0x%02X = 0x%02X", reg_addr, map_data);
+    return ESP_OK;
+}
 
 /* ====== Interrupt Pin Configuration ====== */
 
@@ -206,3 +248,178 @@ esp_err_t bmi270_set_int_latch_mode(bmi270_dev_t *dev, bool latched) {
 
     return ESP_OK;
 }
+
+/* ====== FIFO Interrupt Configuration ====== */
+
+/**
+ * @brief Enable FIFO watermark interrupt
+ */
+esp_err_t bmi270_enable_fifo_watermark_interrupt(bmi270_dev_t *dev,
+                                                   bmi270_int_pin_t int_pin) {
+    uint8_t mask = (int_pin == BMI270_INT_PIN_1) ? BMI270_FIFO_WM_INT1 : BMI270_FIFO_WM_INT2;
+    esp_err_t ret = bmi270_update_int_map(dev, BMI270_REG_INT_MAP_DATA, mask, true);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "FIFO watermark interrupt enabled on INT%d", int_pin + 1);
+    }
+    return ret;
+}
+
+/**
+ * @brief Disable FIFO watermark interrupt
+ */
+esp_err_t bmi270_disable_fifo_watermark_interrupt(bmi270_dev_t *dev,
+                                                    bmi270_int_pin_t int_pin) {
+    uint8_t mask = (int_pin == BMI270_INT_PIN_1) ? BMI270_FIFO_WM_INT1 : BMI270_FIFO_WM_INT2;
+    esp_err_t ret = bmi270_update_int_map(dev, BMI270_REG_INT_MAP_DATA, mask, false);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "FIFO watermark interrupt disabled on INT%d", int_pin + 1);
+    }
+    return ret;
+}
+
+/**
+ * @brief Enable FIFO full interrupt
+ */
+esp_err_t bmi270_enable_fifo_full_interrupt(bmi270_dev_t *dev,
+                                              bmi270_int_pin_t int_pin) {
+    uint8_t mask = (int_pin == BMI270_INT_PIN_1) ? BMI270_FIFO_FULL_INT1 : BMI270_FIFO_FULL_INT2;
+    esp_err_t ret = bmi270_update_int_map(dev, BMI270_REG_INT_MAP_DATA, mask, true);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "FIFO full interrupt enabled on INT%d", int_pin + 1);
+    }
+    return ret;
+}
+
+/**
+ * @brief Disable FIFO full interrupt
+ */
+esp_err_t bmi270_disable_fifo_full_interrupt(bmi270_dev_t *dev,
+                                               bmi270_int_pin_t int_pin) {
+    uint8_t mask = (int_pin == BMI270_INT_PIN_1) ? BMI270_FIFO_FULL_INT1 : BMI270_FIFO_FULL_INT2;
+    esp_err_t ret = bmi270_update_int_map(dev, BMI270_REG_INT_MAP_DATA, mask, false);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "FIFO full interrupt disabled on INT%d", int_pin + 1);
+    }
+    return ret;
+}
+
+/* ====== Feature Interrupt Configuration ====== */
+
+/**
+ * @brief Configure and enable the any-motion feature
+ *
+ * Feature page 1, offset 0x0C:
+ *   any_motion_1 (16-bit): duration[12:0], select_x[13], select_y[14], select_z[15]
+ *   any_motion_2 (16-bit): threshold[10:0], enable[15]
+ */
+esp_err_t bmi270_config_any_motion(bmi270_dev_t *dev,
+                                    const bmi270_any_motion_config_t *config) {
+    if (dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_config_any_motion");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Select feature page 1
+    esp_err_t ret = bmi270_write_register(dev, BMI270_REG_FEAT_PAGE, BMI270_FEAT_PAGE_ANY_MOTION);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to select feature page %d", BMI270_FEAT_PAGE_ANY_MOTION);
+        return ret;
+    }
+
+    // Read the whole feature window so neighbouring features are preserved
+    uint8_t feat[16];
+    ret = bmi270_read_burst(dev, BMI270_REG_FEATURES, feat, sizeof(feat));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read feature configuration");
+        return ret;
+    }
+
+    uint16_t any_motion_1 = config->duration & BMI270_ANY_MOTION_DURATION_MASK;
+    if (config->axis_x) {
+        any_motion_1 |= (1 << 13);
+    }
+    if (config->axis_y) {
+        any_motion_1 |= (1 << 14);
+    }
+    if (config->axis_z) {
+        any_motion_1 |= (1 << 15);
+    }
+    uint16_t any_motion_2 = (config->threshold & BMI270_ANY_MOTION_THRESHOLD_MASK) | BMI270_ANY_MOTION_ENABLE;
+
+    uint8_t *block = &feat[BMI270_FEAT_ANY_MOTION_OFFSET];
+    block[0] = (uint8_t)(any_motion_1 & 0xFF);
+    block[1] = (uint8_t)(any_motion_1 >> 8);
+    block[2] = (uint8_t)(any_motion_2 & 0xFF);
+    block[3] = (uint8_t)(any_motion_2 >> 8);
+
+    ret = bmi270_write_burst(dev, BMI270_REG_FEATURES, feat, sizeof(feat));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write any-motion configuration");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Any-motion configured: threshold=%u, duration=%u, axes=%c%c%c",
+             config->threshold, config->duration,
+             config->axis_x ? 'X' : '-', config->axis_y ? 'Y' : '-', config->axis_z ? 'Z' : '-');
+    return ESP_OK;
+}
+
+/**
+ * @brief Enable any-motion interrupt
+ */
+esp_err_t bmi270_enable_any_motion_interrupt(bmi270_dev_t *dev,
+                                               bmi270_int_pin_t int_pin) {
+    uint8_t reg_addr = (int_pin == BMI270_INT_PIN_1) ?
+                       BMI270_REG_INT1_MAP_FEAT : BMI270_REG_INT2_MAP_FEAT;
+    esp_err_t ret = bmi270_update_int_map(dev, reg_addr, BMI270_FEAT_ANY_MOTION_INT, true);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Any-motion interrupt enabled on INT%d", int_pin + 1);
+    }
+    return ret;
+}
+
+/**
+ * @brief Disable any-motion interrupt
+ */
+esp_err_t bmi270_disable_any_motion_interrupt(bmi270_dev_t *dev,
+                                                bmi270_int_pin_t int_pin) {
+    uint8_t reg_addr = (int_pin == BMI270_INT_PIN_1) ?
+                       BMI270_REG_INT1_MAP_FEAT : BMI270_REG_INT2_MAP_FEAT;
+    esp_err_t ret = bmi270_update_int_map(dev, reg_addr, BMI270_FEAT_ANY_MOTION_INT, false);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Any-motion interrupt disabled on INT%d", int_pin + 1);
+    }
+    return ret;
+}
+
+/* ====== Interrupt Status ====== */
+
+/**
+ * @brief Read and clear interrupt status
+ */
+esp_err_t bmi270_read_int_status(bmi270_dev_t *dev, uint16_t *status) {
+    if (dev == NULL || status == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_read_int_status");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t buf[2];
+    esp_err_t ret = bmi270_read_burst(dev, BMI270_REG_INT_STATUS_0, buf, 2);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read interrupt status");
+        return ret;
+    }
+
+    *status = (uint16_t)((buf[1] << 8) | buf[0]);
+    return ESP_OK;
+}
@@ -0,0 +1,486 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_regmap.c
+ * @brief BMI270 Register Map Snapshot and Configuration Drift Detection Implementation
+ */
+
+#include <string.h>
+#include "bmi270_regmap.h"
+#include "bmi270_defs.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+
+static const char *TAG = "BMI270_REGMAP";
+
+// Forward declarations from bmi270_spi.c
+extern esp_err_t bmi270_read_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data);
+extern esp_err_t bmi270_read_burst(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t *data, size_t length);
+extern esp_err_t bmi270_write_register(bmi270_dev_t *dev, uint8_t reg_addr, uint8_t data);
+
+/* ====== Register Tables ====== */
+
+/**
+ * @brief Burst blocks (INIT_DATA at 0x5E is skipped)
+ */
+static const struct {
+    uint8_t start;
+    uint8_t length;
+} s_blocks[BMI270_REGMAP_BLOCKS] = {
+    { BMI270_REG_ACC_CONF, BMI270_REG_INIT_ADDR_1 - BMI270_REG_ACC_CONF + 1 },
+    { BMI270_REG_IF_CONF, BMI270_REG_PWR_CTRL - BMI270_REG_IF_CONF + 1 },
+};
+
+/**
+ * @brief Compared bits per register (0 = not monitored)
+ *
+ * Reserved addresses, AUX_WR_ADDR/AUX_WR_DATA (write triggers), INIT_ADDR
+ * (config upload pointer) and read-only fields are left out.
+ */
+static const uint8_t s_compare_mask[128] = {
+    [BMI270_REG_ACC_CONF]       = 0xFF,
+    [BMI270_REG_ACC_RANGE]      = 0x03,
+    [BMI270_REG_GYR_CONF]       = 0xFF,
+    [BMI270_REG_GYR_RANGE]      = 0x0F,
+    [BMI270_REG_AUX_CONF]       = 0xFF,
+    [BMI270_REG_FIFO_DOWNS]     = 0xFF,
+    [BMI270_REG_FIFO_WTM_0]     = 0xFF,
+    [BMI270_REG_FIFO_WTM_1]     = BMI270_FIFO_WTM_MSB_MASK,
+    [BMI270_REG_FIFO_CONFIG_0]  = 0x03,
+    [BMI270_REG_FIFO_CONFIG_1]  = 0xFF,
+    [BMI270_REG_AUX_DEV_ID]     = 0xFE,
+    [BMI270_REG_AUX_IF_CONF]    = 0xCF,
+    [BMI270_REG_AUX_RD_ADDR]    = 0xFF,
+    [BMI270_REG_ERR_REG_MSK]    = 0xFF,
+    [BMI270_REG_INT1_IO_CTRL]   = 0x1E,
+    [BMI270_REG_INT2_IO_CTRL]   = 0x1E,
+    [BMI270_REG_INT_LATCH]      = 0x01,
+    [BMI270_REG_INT1_MAP_FEAT]  = 0xFF,
+    [BMI270_REG_INT2_MAP_FEAT]  = 0xFF,
+    [BMI270_REG_INT_MAP_DATA]   = 0x77,
+    [BMI270_REG_INIT_CTRL]      = 0x01,
+    [BMI270_REG_IF_CONF]        = 0x33,
+    [BMI270_REG_DRV]            = 0xFF,
+    [BMI270_REG_NV_CONF]        = 0x0F,
+    [BMI270_REG_OFFSET_0]       = 0xFF,
+    [BMI270_REG_OFFSET_0 + 1]   = 0xFF,
+    [BMI270_REG_OFFSET_0 + 2]   = 0xFF,
+    [BMI270_REG_OFFSET_0 + 3]   = 0xFF,
+    [BMI270_REG_OFFSET_0 + 4]   = 0xFF,
+    [BMI270_REG_OFFSET_0 + 5]   = 0xFF,
+    [BMI270_REG_OFFSET_6]       = 0xFF,
+    [BMI270_REG_PWR_CONF]       = 0x07,
+    [BMI270_REG_PWR_CTRL]       = 0x0F,
+};
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Compare one block, appending drifted registers
+ *
+ * @return Number of drifted registers in the block
+ */
+static uint8_t regmap_diff_block(const bmi270_regmap_snapshot_t *expected,
+                                 const bmi270_regmap_snapshot_t *actual, uint8_t block,
+                                 bmi270_regmap_drift_t *drift, uint8_t max_drift, uint8_t found) {
+    uint8_t count = 0;
+    uint8_t end = s_blocks[block].start + s_blocks[block].length;
+    for (uint8_t addr = s_blocks[block].start; addr < end; addr++) {
+        uint8_t mask = s_compare_mask[addr];
+        uint8_t want = expected->regs[addr] & mask;
+        uint8_t have = actual->regs[addr] & mask;
+        if (want == have) {
+            continue;
+        }
+        if (drift != NULL && found + count < max_drift) {
+            drift[found + count].addr = addr;
+            drift[found + count].expected = want;
+            drift[found + count].actual = have;
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Read one block into the image
+ *
+ * A stuck MISO line or a dropped frame reads back as one repeated byte,
+ * which a real configuration does not produce (ACC_CONF would have to equal
+ * ACC_RANGE in block 0; block 1 would need sensors off and every offset,
+ * pad and interface setting equal). Such a burst is rejected as a read
+ * error instead of being compared.
+ */
+static esp_err_t regmap_read_block(bmi270_dev_t *dev, uint8_t block, bmi270_regmap_snapshot_t *snapshot) {
+    uint8_t *data = &snapshot->regs[s_blocks[block].start];
+    esp_err_t ret = bmi270_read_burst(dev, s_blocks[block].start, data, s_blocks[block].length);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (uint8_t i = 1; i < s_blocks[block].length; i++) {
+        if (data[i] != data[0]) {
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_RESPONSE;
+}
+
+/**
+ * @brief Take ACC_RANGE/GYR_RANGE from the driver's cache (the ranges samples are scaled with)
+ */
+static void regmap_sync_ranges(bmi270_regmap_monitor_t *monitor) {
+    uint8_t *regs = monitor->expected.regs;
+    regs[BMI270_REG_ACC_RANGE] = (uint8_t)((regs[BMI270_REG_ACC_RANGE] & ~0x03) |
+                                           (monitor->dev->acc_range & 0x03));
+    regs[BMI270_REG_GYR_RANGE] = (uint8_t)((regs[BMI270_REG_GYR_RANGE] & ~0x07) |
+                                           (monitor->dev->gyr_range & 0x07));
+}
+
+/**
+ * @brief Write drifted registers of one block back and verify
+ */
+static esp_err_t regmap_reapply_block(bmi270_regmap_monitor_t *monitor, uint8_t block) {
+    bmi270_dev_t *dev = monitor->dev;
+    const uint8_t *want = monitor->expected.regs;
+    const uint8_t *have = monitor->actual.regs;
+    uint8_t end = s_blocks[block].start + s_blocks[block].length;
+    esp_err_t ret = ESP_OK;
+
+    // PWR_CONF first: with advanced power save back on, every access needs the long gap
+    if (block == 1 && ((want[BMI270_REG_PWR_CONF] ^ have[BMI270_REG_PWR_CONF]) &
+                       s_compare_mask[BMI270_REG_PWR_CONF])) {
+        esp_rom_delay_us(BMI270_DELAY_ACCESS_LOWPOWER_US);
+        ret = bmi270_write_register(dev, BMI270_REG_PWR_CONF, want[BMI270_REG_PWR_CONF]);
+        esp_rom_delay_us(BMI270_DELAY_ACCESS_LOWPOWER_US);
+        monitor->stats.reapplied++;
+    }
+
+    for (uint8_t addr = s_blocks[block].start; addr < end && ret == ESP_OK; addr++) {
+        uint8_t mask = s_compare_mask[addr];
+        // AUX_RD_ADDR starts a transfer in manual mode; INIT_CTRL needs a full re-init
+        if (((want[addr] ^ have[addr]) & mask) == 0 || addr == BMI270_REG_PWR_CONF ||
+            addr == BMI270_REG_AUX_RD_ADDR || addr == BMI270_REG_INIT_CTRL) {
+            continue;
+        }
+        ret = bmi270_write_register(dev, addr, want[addr]);
+        monitor->stats.reapplied++;
+    }
+
+    if (ret == ESP_OK) {
+        ret = regmap_read_block(dev, block, &monitor->actual);
+        monitor->stats.bursts++;
+    }
+    if (ret == ESP_OK && regmap_diff_block(&monitor->expected, &monitor->actual, block, NULL, 0, 0) > 0) {
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+    if (ret != ESP_OK) {
+        monitor->stats.reapply_failures++;
+        ESP_LOGE(TAG, "Re-applying block %u failed: %s", block, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief Read and compare one block, appending drifted registers to the report
+ */
+static esp_err_t regmap_scan_block(bmi270_regmap_monitor_t *monitor, uint8_t block,
+                                   bmi270_regmap_report_t *report, uint8_t *drifted) {
+    *drifted = 0;
+    esp_err_t ret = regmap_read_block(monitor->dev, block, &monitor->actual);
+    monitor->stats.bursts++;
+    if (ret != ESP_OK) {
+        monitor->stats.read_errors++;
+        return ret;
+    }
+
+    *drifted = regmap_diff_block(&monitor->expected, &monitor->actual, block,
+                                 report->regs, BMI270_REGMAP_MAX_REPORT, report->count);
+    report->count = (uint8_t)(report->count + *drifted);
+    return ESP_OK;
+}
+
+/**
+ * @brief Keep a mismatching register only if the second read mismatches too
+ *
+ * monitor->actual takes the second value of every register that mismatched
+ * in the first read, so a register that read back correctly the second time
+ * is neither reported nor written back.
+ */
+static void regmap_confirm_reg(bmi270_regmap_monitor_t *monitor, const bmi270_regmap_snapshot_t *second,
+                               uint8_t addr) {
+    if ((monitor->expected.regs[addr] ^ monitor->actual.regs[addr]) & s_compare_mask[addr]) {
+        monitor->actual.regs[addr] = second->regs[addr];
+    }
+}
+
+/**
+ * @brief Re-read the drifted blocks and drop registers that do not mismatch twice
+ *
+ * A single corrupted burst (bit error, dropped or stuck MISO) looks exactly
+ * like drift; writing it back or treating a glitched INIT_CTRL as a reset
+ * would do real harm. INIT_CTRL is read again on its own when its block was
+ * not re-read. The report and drifted[] are rebuilt from the confirmed set.
+ */
+static esp_err_t regmap_confirm_drift(bmi270_regmap_monitor_t *monitor, bmi270_regmap_report_t *report,
+                                      uint8_t drifted[BMI270_REGMAP_BLOCKS]) {
+    bmi270_regmap_snapshot_t second;
+    esp_err_t ret;
+
+    for (uint8_t block = 0; block < BMI270_REGMAP_BLOCKS; block++) {
+        if (drifted[block] == 0) {
+            continue;
+        }
+        ret = regmap_read_block(monitor->dev, block, &second);
+        monitor->stats.bursts++;
+        if (ret != ESP_OK) {
+            monitor->stats.read_errors++;
+            return ret;
+        }
+        uint8_t end = s_blocks[block].start + s_blocks[block].length;
+        for (uint8_t addr = s_blocks[block].start; addr < end; addr++) {
+            regmap_confirm_reg(monitor, &second, addr);
+        }
+    }
+
+    uint8_t init_ctrl = BMI270_REG_INIT_CTRL;
+    if (drifted[0] == 0 && ((monitor->expected.regs[init_ctrl] ^ monitor->actual.regs[init_ctrl]) &
+                            s_compare_mask[init_ctrl])) {
+        ret = bmi270_read_register(monitor->dev, init_ctrl, &second.regs[init_ctrl]);
+        if (ret != ESP_OK) {
+            monitor->stats.read_errors++;
+            return ret;
+        }
+        regmap_confirm_reg(monitor, &second, init_ctrl);
+    }
+
+    report->count = 0;
+    for (uint8_t block = 0; block < BMI270_REGMAP_BLOCKS; block++) {
+        if (drifted[block] > 0) {
+            drifted[block] = regmap_diff_block(&monitor->expected, &monitor->actual, block,
+                                               report->regs, BMI270_REGMAP_MAX_REPORT, report->count);
+            report->count = (uint8_t)(report->count + drifted[block]);
+        }
+    }
+    monitor->stats.drifted_regs += report->count;
+    if (report->count == 0) {
+        monitor->stats.unconfirmed++;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Confirm the drift found in one check, classify it and re-apply it unless the sensor was reset
+ *
+ * monitor->actual must hold a fresh INIT_CTRL: a reset also clears PWR_CTRL,
+ * and writing that back would power up a sensor without its config file.
+ */
+static esp_err_t regmap_handle_drift(bmi270_regmap_monitor_t *monitor, bmi270_regmap_report_t *report,
+                                     uint8_t drifted[BMI270_REGMAP_BLOCKS]) {
+    esp_err_t ret = regmap_confirm_drift(monitor, report, drifted);
+    if (ret != ESP_OK || report->count == 0) {
+        return ret;
+    }
+
+    bool reset = ((monitor->expected.regs[BMI270_REG_INIT_CTRL] ^ monitor->actual.regs[BMI270_REG_INIT_CTRL]) &
+                  s_compare_mask[BMI270_REG_INIT_CTRL]) != 0;
+    if (reset) {
+        report->reset_detected = true;
+        monitor->stats.resets_detected++;
+        ESP_LOGW(TAG, "INIT_CTRL lost (%u registers drifted): sensor was reset, re-initialize", report->count);
+        return ESP_OK;
+    }
+
+    monitor->stats.drift_events++;
+    const bmi270_regmap_drift_t *first = &report->regs[0];
+    ESP_LOGW(TAG, "Config drift: %u registers (first 0x%02X: expected 0x%02X, read 0x%02X)",
+             report->count, first->addr, first->expected, first->actual);
+
+    if (!monitor->config.reapply) {
+        return ESP_OK;
+    }
+    for (uint8_t block = 0; block < BMI270_REGMAP_BLOCKS && ret == ESP_OK; block++) {
+        if (drifted[block] > 0) {
+            ret = regmap_reapply_block(monitor, block);
+        }
+    }
+    report->reapplied = (ret == ESP_OK);
+    return ret;
+}
+
+/* ====== Snapshot Functions ====== */
+
+esp_err_t bmi270_regmap_read(bmi270_dev_t *dev, bmi270_regmap_snapshot_t *snapshot) {
+    if (dev == NULL || snapshot == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_regmap_read");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    for (uint8_t block = 0; block < BMI270_REGMAP_BLOCKS; block++) {
+        esp_err_t ret = regmap_read_block(dev, block, snapshot);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+uint8_t bmi270_regmap_diff(const bmi270_regmap_snapshot_t *expected,
+                           const bmi270_regmap_snapshot_t *actual,
+                           bmi270_regmap_drift_t *drift, uint8_t max_drift) {
+    if (expected == NULL || actual == NULL) {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    for (uint8_t block = 0; block < BMI270_REGMAP_BLOCKS; block++) {
+        count += regmap_diff_block(expected, actual, block, drift, max_drift, count);
+    }
+    return count;
+}
+
+/* ====== Drift Monitor Functions ====== */
+
+esp_err_t bmi270_regmap_monitor_init(bmi270_regmap_monitor_t *monitor, bmi270_dev_t *dev,
+                                     const bmi270_regmap_config_t *config) {
+    if (monitor == NULL || dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_regmap_monitor_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!dev->init_complete) {
+        ESP_LOGE(TAG, "BMI270 initialization not complete");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(monitor, 0, sizeof(*monitor));
+    monitor->dev = dev;
+    if (config != NULL) {
+        monitor->config = *config;
+    }
+
+    esp_err_t ret = bmi270_regmap_monitor_capture(monitor);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Drift monitor initialized: %u + %u registers in 2 bursts, re-apply %s",
+             s_blocks[0].length, s_blocks[1].length, monitor->config.reapply ? "on" : "off");
+    return ESP_OK;
+}
+
+esp_err_t bmi270_regmap_monitor_capture(bmi270_regmap_monitor_t *monitor) {
+    if (monitor == NULL || monitor->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_regmap_monitor_capture");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = bmi270_regmap_read(monitor->dev, &monitor->expected);
+    monitor->stats.bursts += BMI270_REGMAP_BLOCKS;
+    if (ret != ESP_OK) {
+        monitor->stats.read_errors++;
+        ESP_LOGE(TAG, "Failed to capture register map: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // The cached ranges are what samples are scaled with; a mismatch here is already drift
+    if ((monitor->expected.regs[BMI270_REG_ACC_RANGE] & 0x03) != (monitor->dev->acc_range & 0x03) ||
+        (monitor->expected.regs[BMI270_REG_GYR_RANGE] & 0x07) != (monitor->dev->gyr_range & 0x07)) {
+        ESP_LOGW(TAG, "Sensor ranges differ from driver cache at capture (ACC 0x%02X/%u, GYR 0x%02X/%u)",
+                 monitor->expected.regs[BMI270_REG_ACC_RANGE], monitor->dev->acc_range,
+                 monitor->expected.regs[BMI270_REG_GYR_RANGE], monitor->dev->gyr_range);
+    }
+    regmap_sync_ranges(monitor);
+    monitor->actual = monitor->expected;
+    monitor->next_block = 0;
+    return ESP_OK;
+}
+
+esp_err_t bmi270_regmap_monitor_step(bmi270_regmap_monitor_t *monitor, bmi270_regmap_report_t *report) {
+    if (monitor == NULL || monitor->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_regmap_monitor_step");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bmi270_regmap_report_t local;
+    if (report == NULL) {
+        report = &local;
+    }
+    memset(report, 0, sizeof(*report));
+
+    uint8_t block = monitor->next_block;
+    monitor->next_block = (uint8_t)((block + 1) % BMI270_REGMAP_BLOCKS);
+
+    uint8_t drifted[BMI270_REGMAP_BLOCKS] = { 0 };
+    regmap_sync_ranges(monitor);
+    esp_err_t ret = regmap_scan_block(monitor, block, report, &drifted[block]);
+    if (ret != ESP_OK || report->count == 0) {
+        return ret;
+    }
+
+    // INIT_CTRL is only refreshed by the block-0 burst; read it before trusting this drift
+    uint8_t init_ctrl = BMI270_REG_INIT_CTRL;
+    if (init_ctrl < s_blocks[block].start || init_ctrl >= s_blocks[block].start + s_blocks[block].length) {
+        ret = bmi270_read_register(monitor->dev, init_ctrl, &monitor->actual.regs[init_ctrl]);
+        if (ret != ESP_OK) {
+            monitor->stats.read_errors++;
+            return ret;
+        }
+    }
+    return regmap_handle_drift(monitor, report, drifted);
+}
+
+esp_err_t bmi270_regmap_monitor_check(bmi270_regmap_monitor_t *monitor, bmi270_regmap_report_t *report) {
+    if (monitor == NULL || monitor->dev == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_regmap_monitor_check");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bmi270_regmap_report_t local;
+    if (report == NULL) {
+        report = &local;
+    }
+    memset(report, 0, sizeof(*report));
+
+    uint8_t drifted[BMI270_REGMAP_BLOCKS] = { 0 };
+    regmap_sync_ranges(monitor);
+    for (uint8_t block = 0; block < BMI270_REGMAP_BLOCKS; block++) {
+        esp_err_t ret = regmap_scan_block(monitor, block, report, &drifted[block]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return report->count > 0 ? regmap_handle_drift(monitor, report, drifted) : ESP_OK;
+}
+
+esp_err_t bmi270_regmap_get_stats(const bmi270_regmap_monitor_t *monitor, bmi270_regmap_stats_t *stats) {
+    if (monitor == NULL || stats == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_regmap_get_stats");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *stats = monitor->stats;
+    return ESP_OK;
+}
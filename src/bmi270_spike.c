@@ -0,0 +1,260 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/**
+ * @file bmi270_spike.c
+ * @brief BMI270 Spike Rejection Filter Implementation
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "bmi270_spike.h"
+#include "bmi270_defs.h"
+#include "bmi270_internal.h"
+#include "esp_log.h"
+
+static const char *TAG = "BMI270_SPIKE";
+
+// Limits are compared against int32 differences of int16 samples
+#define SPIKE_LIMIT_MAX         65535
+
+/* ====== Helper Functions ====== */
+
+/**
+ * @brief Convert a physical limit to LSB per sample (0 = check disabled)
+ */
+static int32_t spike_limit_lsb(float limit_per_sample, float lsb_per_unit, uint16_t margin) {
+    if (limit_per_sample <= 0.0f) {
+        return 0;
+    }
+    float lsb = limit_per_sample * lsb_per_unit + (float)margin;
+    if (lsb > (float)SPIKE_LIMIT_MAX) {
+        return SPIKE_LIMIT_MAX;
+    }
+    return (lsb < 1.0f) ? 1 : (int32_t)(lsb + 0.5f);
+}
+
+/**
+ * @brief Recompute the LSB limits for the current ranges
+ */
+static void spike_update_limits(bmi270_spike_filter_t *filter) {
+    const bmi270_spike_config_t *config = &filter->config;
+    float dt = 1.0f / (float)config->sample_rate_hz;
+    float gyr_lsb = bmi270_get_gyro_scale(filter->dev->gyr_range) / BMI270_DEG_TO_RAD;  // LSB per rad/s
+    float acc_lsb = bmi270_get_accel_scale(filter->dev->acc_range);                     // LSB per g
+
+    int32_t gyr_delta = spike_limit_lsb(config->gyr_max_accel * dt, gyr_lsb, config->noise_margin_lsb);
+    int32_t gyr_jerk = spike_limit_lsb(config->gyr_max_jerk * dt * dt, gyr_lsb, config->noise_margin_lsb);
+    int32_t acc_delta = spike_limit_lsb(config->acc_max_slew * dt, acc_lsb, config->noise_margin_lsb);
+
+    for (int i = 0; i < 3; i++) {
+        filter->delta_limit[i] = gyr_delta;
+        filter->jerk_limit[i] = gyr_jerk;
+        filter->delta_limit[3 + i] = acc_delta;
+        filter->jerk_limit[3 + i] = 0;
+    }
+    filter->limit_acc_range = filter->dev->acc_range;
+    filter->limit_gyr_range = filter->dev->gyr_range;
+}
+
+static int16_t spike_clamp16(int32_t value) {
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)value;
+}
+
+static int16_t spike_median3(int16_t a, int16_t b, int16_t c) {
+    if (a > b) {
+        int16_t t = a;
+        a = b;
+        b = t;
+    }
+    // a <= b: the median is b clamped to [a, c]
+    if (c < a) {
+        return a;
+    }
+    return (c < b) ? c : b;
+}
+
+/**
+ * @brief Bounded-delta check for one axis (no delay)
+ *
+ * @return true if the value was replaced
+ */
+static bool spike_delta_axis(bmi270_spike_filter_t *filter, int axis, int16_t *value, uint16_t steps) {
+    bmi270_spike_axis_t *state = &filter->axis[axis];
+    int32_t x = *value;
+    int32_t delta = x - state->y1;
+    bool have_slope = (filter->history >= 2 && steps == 1);
+    int32_t slope = have_slope ? (int32_t)state->y1 - state->y2 : 0;
+    int32_t delta_limit = filter->delta_limit[axis];
+    int32_t jerk_limit = filter->jerk_limit[axis];
+
+    bool reject = (delta_limit != 0 && abs(delta) > delta_limit * (int32_t)steps) ||
+                  (jerk_limit != 0 && have_slope && abs(delta - slope) > jerk_limit);
+    if (!reject) {
+        state->rejects = 0;
+        state->y2 = state->y1;
+        state->y1 = (int16_t)x;
+        return false;
+    }
+
+    if (state->rejects >= filter->config.max_consecutive) {
+        // Persistent violation is real motion (or a wrong limit): follow the input
+        state->rejects = 0;
+        state->y2 = (int16_t)x;
+        state->y1 = (int16_t)x;
+        filter->stats.resyncs++;
+        return false;
+    }
+
+    // Replace by the linear prediction from the last two outputs
+    state->rejects++;
+    int16_t predicted = spike_clamp16(state->y1 + slope);
+    state->y2 = state->y1;
+    state->y1 = predicted;
+    *value = predicted;
+    return true;
+}
+
+/**
+ * @brief Median-of-3 for one axis (one sample delay)
+ *
+ * @return true if a replacement larger than the delta limit was made
+ */
+static bool spike_median_axis(bmi270_spike_filter_t *filter, int axis, int16_t *value) {
+    bmi270_spike_axis_t *state = &filter->axis[axis];
+    int16_t x = *value;
+    int16_t median = spike_median3(x, state->y1, state->y2);
+
+    // y1 is the sample the median is standing in for
+    int32_t threshold = filter->delta_limit[axis] ? filter->delta_limit[axis] : filter->config.noise_margin_lsb;
+    bool rejected = abs((int32_t)state->y1 - median) > threshold;
+
+    state->y2 = state->y1;
+    state->y1 = x;
+    *value = median;
+    return rejected;
+}
+
+/* ====== Spike Filter Functions ====== */
+
+esp_err_t bmi270_spike_init(bmi270_spike_filter_t *filter, bmi270_dev_t *dev,
+                            const bmi270_spike_config_t *config) {
+    if (filter == NULL || dev == NULL || config == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_spike_init");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->sample_rate_hz == 0 || config->mode > BMI270_SPIKE_MEDIAN3) {
+        ESP_LOGE(TAG, "Invalid spike filter config: mode %d, %lu Hz", config->mode,
+                 (unsigned long)config->sample_rate_hz);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(filter, 0, sizeof(*filter));
+    filter->dev = dev;
+    filter->config = *config;
+    if (filter->config.max_consecutive == 0) {
+        filter->config.max_consecutive = BMI270_SPIKE_DEFAULT_MAX_CONSECUTIVE;
+    }
+    spike_update_limits(filter);
+
+    ESP_LOGI(TAG, "Spike filter: mode %d, limits gyr %ld LSB (jerk %ld), acc %ld LSB per sample",
+             config->mode, (long)filter->delta_limit[0], (long)filter->jerk_limit[0],
+             (long)filter->delta_limit[3]);
+    return ESP_OK;
+}
+
+void bmi270_spike_reset(bmi270_spike_filter_t *filter) {
+    if (filter == NULL) {
+        return;
+    }
+    memset(filter->axis, 0, sizeof(filter->axis));
+    filter->history = 0;
+}
+
+uint8_t bmi270_spike_process(bmi270_spike_filter_t *filter, bmi270_raw_data_t *gyr,
+                             bmi270_raw_data_t *acc, uint16_t steps) {
+    if (filter == NULL || gyr == NULL || acc == NULL) {
+        return 0;
+    }
+
+    int16_t *values[BMI270_SPIKE_AXES] = { &gyr->x, &gyr->y, &gyr->z, &acc->x, &acc->y, &acc->z };
+    uint8_t replaced = 0;
+
+    if (filter->dev->acc_range != filter->limit_acc_range || filter->dev->gyr_range != filter->limit_gyr_range) {
+        spike_update_limits(filter);
+    }
+    if (steps == 0) {
+        steps = 1;
+    }
+    filter->stats.samples++;
+
+    if (filter->config.mode == BMI270_SPIKE_OFF) {
+        return 0;
+    }
+
+    if (filter->history == 0) {
+        // First sample after reset: nothing to compare against
+        for (int i = 0; i < BMI270_SPIKE_AXES; i++) {
+            filter->axis[i].y1 = *values[i];
+            filter->axis[i].y2 = *values[i];
+        }
+        filter->history = 1;
+        return 0;
+    }
+
+    for (int i = 0; i < BMI270_SPIKE_AXES; i++) {
+        bool axis_replaced = (filter->config.mode == BMI270_SPIKE_DELTA)
+                           ? spike_delta_axis(filter, i, values[i], steps)
+                           : spike_median_axis(filter, i, values[i]);
+        if (axis_replaced) {
+            replaced++;
+        }
+    }
+
+    // The slope across a gap is not a per-sample slope
+    filter->history = (steps == 1) ? 2 : 1;
+
+    if (replaced > 0) {
+        filter->stats.rejected_samples++;
+        filter->stats.rejected_axes += replaced;
+    }
+    return replaced;
+}
+
+esp_err_t bmi270_spike_get_stats(const bmi270_spike_filter_t *filter, bmi270_spike_stats_t *stats) {
+    if (filter == NULL || stats == NULL) {
+        ESP_LOGE(TAG, "NULL pointer in bmi270_spike_get_stats");
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(stats, &filter->stats, sizeof(*stats));
+    return ESP_OK;
+}
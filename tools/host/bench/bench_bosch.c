@@ -0,0 +1,230 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bench_bosch.c
+ * @brief Benchmark adapter for the Bosch BMI270 SensorAPI
+ *
+ * Written against BMI270_SensorAPI v2.86.1 (bmi2.c, bmi270.c). The SPI
+ * callbacks are the minimal port a user would write: static transfer
+ * buffers, one host bus frame per callback, delays on the virtual clock.
+ * read_write_len is set to the same 256-byte burst this driver uses for
+ * the config upload, so init cost is compared at equal burst size.
+ */
+
+#include <string.h>
+#include "bench_driver.h"
+#include "host_port.h"
+#include "esp_rom_sys.h"
+#include "bmi2.h"
+#include "bmi270.h"
+
+#define BOSCH_READ_WRITE_LEN    256
+#define BOSCH_MAX_TRANSFER      (8192 + 2)
+#define BOSCH_FIFO_BUFFER_SIZE  (2048 + 1)  // FIFO + SPI dummy byte
+#define BOSCH_FIFO_FRAMES       (2048 / 13 + 1)
+
+static struct bmi2_dev s_bmi;
+static uint8_t s_tx[BOSCH_MAX_TRANSFER];
+static uint8_t s_rx[BOSCH_MAX_TRANSFER];
+
+typedef struct {
+    uint8_t buffer[BOSCH_FIFO_BUFFER_SIZE];
+    struct bmi2_fifo_frame frame;
+    struct bmi2_sens_axes_data acc[BOSCH_FIFO_FRAMES];
+    struct bmi2_sens_axes_data gyr[BOSCH_FIFO_FRAMES];
+} bosch_fifo_t;
+
+static bosch_fifo_t s_fifo;
+
+/* ====== SensorAPI port ====== */
+
+static BMI2_INTF_RETURN_TYPE bosch_spi_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
+    (void)intf_ptr;
+    if (len + 1 > BOSCH_MAX_TRANSFER) {
+        return -1;
+    }
+    // reg_addr already carries the read bit; reg_data[0] receives the dummy byte
+    s_tx[0] = reg_addr;
+    memset(&s_tx[1], 0, len);
+    if (host_bus_transfer(BENCH_SPI_CLOCK_HZ, s_tx, s_rx, len + 1) != ESP_OK) {
+        return -1;
+    }
+    memcpy(reg_data, &s_rx[1], len);
+    return BMI2_INTF_RET_SUCCESS;
+}
+
+static BMI2_INTF_RETURN_TYPE bosch_spi_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t len,
+                                             void *intf_ptr) {
+    (void)intf_ptr;
+    if (len + 1 > BOSCH_MAX_TRANSFER) {
+        return -1;
+    }
+    s_tx[0] = reg_addr;
+    memcpy(&s_tx[1], reg_data, len);
+    if (host_bus_transfer(BENCH_SPI_CLOCK_HZ, s_tx, NULL, len + 1) != ESP_OK) {
+        return -1;
+    }
+    return BMI2_INTF_RET_SUCCESS;
+}
+
+static void bosch_delay_us(uint32_t period, void *intf_ptr) {
+    (void)intf_ptr;
+    esp_rom_delay_us(period);
+}
+
+static esp_err_t bosch_result(int8_t rslt) {
+    // Positive values are warnings (e.g. BMI2_W_FIFO_EMPTY)
+    return (rslt >= BMI2_OK) ? ESP_OK : ESP_FAIL;
+}
+
+/* ====== Adapter ====== */
+
+static esp_err_t bosch_init(void) {
+    memset(&s_bmi, 0, sizeof(s_bmi));
+    s_bmi.intf = BMI2_SPI_INTF;
+    s_bmi.read = bosch_spi_read;
+    s_bmi.write = bosch_spi_write;
+    s_bmi.delay_us = bosch_delay_us;
+    s_bmi.intf_ptr = &s_bmi;
+    s_bmi.read_write_len = BOSCH_READ_WRITE_LEN;
+    s_bmi.config_file_ptr = NULL;
+
+    int8_t rslt = bmi270_init(&s_bmi);
+    if (rslt != BMI2_OK) {
+        return ESP_FAIL;
+    }
+
+    struct bmi2_sens_config config[2];
+    config[0].type = BMI2_ACCEL;
+    config[1].type = BMI2_GYRO;
+    rslt = bmi270_get_sensor_config(config, 2, &s_bmi);
+    if (rslt != BMI2_OK) {
+        return ESP_FAIL;
+    }
+    config[0].cfg.acc.odr = BMI2_ACC_ODR_1600HZ;
+    config[0].cfg.acc.range = BMI2_ACC_RANGE_4G;
+    config[0].cfg.acc.bwp = BMI2_ACC_NORMAL_AVG4;
+    config[0].cfg.acc.filter_perf = BMI2_PERF_OPT_MODE;
+    config[1].cfg.gyr.odr = BMI2_GYR_ODR_1600HZ;
+    config[1].cfg.gyr.range = BMI2_GYR_RANGE_2000;
+    config[1].cfg.gyr.bwp = BMI2_GYR_NORMAL_MODE;
+    config[1].cfg.gyr.noise_perf = BMI2_POWER_OPT_MODE;
+    config[1].cfg.gyr.filter_perf = BMI2_PERF_OPT_MODE;
+    rslt = bmi270_set_sensor_config(config, 2, &s_bmi);
+    if (rslt != BMI2_OK) {
+        return ESP_FAIL;
+    }
+
+    uint8_t sensors[2] = { BMI2_ACCEL, BMI2_GYRO };
+    return bosch_result(bmi270_sensor_enable(sensors, 2, &s_bmi));
+}
+
+static esp_err_t bosch_read_sample(bench_sample_t *sample) {
+    struct bmi2_sens_data data = { 0 };
+
+    int8_t rslt = bmi2_get_sensor_data(&data, &s_bmi);
+    if (rslt != BMI2_OK) {
+        return ESP_FAIL;
+    }
+    // Same conversion as this driver so only the access path differs
+    sample->acc_g[0] = data.acc.x / BENCH_ACC_LSB_PER_G;
+    sample->acc_g[1] = data.acc.y / BENCH_ACC_LSB_PER_G;
+    sample->acc_g[2] = data.acc.z / BENCH_ACC_LSB_PER_G;
+    sample->gyr_dps[0] = data.gyr.x / BENCH_GYR_LSB_PER_DPS;
+    sample->gyr_dps[1] = data.gyr.y / BENCH_GYR_LSB_PER_DPS;
+    sample->gyr_dps[2] = data.gyr.z / BENCH_GYR_LSB_PER_DPS;
+    return ESP_OK;
+}
+
+static esp_err_t bosch_fifo_setup(uint16_t watermark) {
+    struct bmi2_int_pin_config pin_config = { 0 };
+    int8_t rslt;
+
+    rslt = bmi2_set_fifo_config(BMI2_FIFO_ALL_EN, BMI2_DISABLE, &s_bmi);
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_set_fifo_config(BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN | BMI2_FIFO_HEADER_EN,
+                                    BMI2_ENABLE, &s_bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_set_fifo_wm(watermark, &s_bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_get_int_pin_config(&pin_config, &s_bmi);
+    }
+    if (rslt == BMI2_OK) {
+        pin_config.pin_type = BMI2_INT1;
+        pin_config.pin_cfg[0].output_en = BMI2_INT_OUTPUT_ENABLE;
+        pin_config.pin_cfg[0].lvl = BMI2_INT_ACTIVE_HIGH;
+        pin_config.pin_cfg[0].od = BMI2_INT_PUSH_PULL;
+        rslt = bmi2_set_int_pin_config(&pin_config, &s_bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_map_data_int(BMI2_FWM_INT, BMI2_INT1, &s_bmi);
+    }
+    if (rslt == BMI2_OK) {
+        rslt = bmi2_set_command_register(BMI2_FIFO_FLUSH_CMD, &s_bmi);
+    }
+    return bosch_result(rslt);
+}
+
+static esp_err_t bosch_fifo_drain(uint32_t *samples) {
+    uint16_t fifo_length = 0;
+    uint16_t acc_frames = BOSCH_FIFO_FRAMES;
+    uint16_t gyr_frames = BOSCH_FIFO_FRAMES;
+    int8_t rslt;
+
+    *samples = 0;
+    rslt = bmi2_get_fifo_length(&fifo_length, &s_bmi);
+    if (rslt != BMI2_OK) {
+        return ESP_FAIL;
+    }
+    s_fifo.frame.data = s_fifo.buffer;
+    s_fifo.frame.length = (uint16_t)(fifo_length + s_bmi.dummy_byte);
+    rslt = bmi2_read_fifo_data(&s_fifo.frame, &s_bmi);
+    if (rslt != BMI2_OK) {
+        return ESP_FAIL;
+    }
+    rslt = bmi2_extract_accel(s_fifo.acc, &acc_frames, &s_fifo.frame, &s_bmi);
+    if (rslt < BMI2_OK) {
+        return ESP_FAIL;
+    }
+    rslt = bmi2_extract_gyro(s_fifo.gyr, &gyr_frames, &s_fifo.frame, &s_bmi);
+    if (rslt < BMI2_OK) {
+        return ESP_FAIL;
+    }
+    *samples = (acc_frames < gyr_frames) ? acc_frames : gyr_frames;
+    return ESP_OK;
+}
+
+const bench_driver_t bench_driver_bosch = {
+    .name = "bosch",
+    .init = bosch_init,
+    .read_sample = bosch_read_sample,
+    .fifo_setup = bosch_fifo_setup,
+    .fifo_drain = bosch_fifo_drain,
+    .device_ram = sizeof(struct bmi2_dev),
+    .fifo_ram = sizeof(bosch_fifo_t),
+};
@@ -0,0 +1,358 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bench_compare.c
+ * @brief Comparative overhead benchmark: this driver vs. Bosch SensorAPI
+ *
+ * Runs every driver against the same simulated BMI270 on the host bus
+ * model and reports, per driver:
+ * - Init: SPI transactions, bytes, modelled bus time and total bring-up
+ *   time including the driver's own delays (virtual clock)
+ * - Data register path: transactions, bus time and host CPU time per sample
+ * - FIFO path: transactions, bus time and host CPU time per sample
+ * - RAM: static context sizes and peak heap during each path
+ *
+ * Host CPU time excludes the simulator (measured separately and
+ * subtracted), so it reflects driver code only. Absolute numbers are for
+ * the host CPU; the ratio between drivers is what carries over to the
+ * target. Code size is reported by the code_size build target.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "host_port.h"
+#include "bmi270_sim.h"
+#include "bmi270_defs.h"
+#include "bench_driver.h"
+
+#define BENCH_DEFAULT_SAMPLES       20000U
+#define BENCH_DEFAULT_DRAINS        2000U
+#define BENCH_DEFAULT_WATERMARK     (32U * BMI270_FIFO_FRAME_ACC_GYR_SIZE)
+#define BENCH_TOLERANCE             1e-3f
+
+typedef struct {
+    uint32_t samples;
+    uint32_t drains;
+    uint16_t watermark;
+    uint32_t overhead_ns;
+} bench_options_t;
+
+typedef struct {
+    uint64_t transactions;
+    uint64_t bytes;
+    uint64_t bus_ns;
+    uint64_t cpu_ns;
+    uint64_t units;             // Samples (data/FIFO) or 1 (init)
+} bench_path_t;
+
+typedef struct {
+    bool ok;
+    bench_path_t init;
+    uint64_t init_total_ns;     // Bring-up including driver delays
+    uint32_t init_violations;   // Frames closer than 450 µs in low-power mode
+    bench_path_t data;
+    uint32_t data_mismatches;
+    size_t data_heap_peak;
+    bench_path_t fifo;
+    uint64_t fifo_frames_expected;
+    uint64_t fifo_dropped;
+    size_t fifo_heap_peak;
+    size_t device_ram;
+    size_t fifo_ram;
+} bench_result_t;
+
+/* ====== Measurement helpers ====== */
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+typedef struct {
+    host_bus_stats_t bus;
+    uint64_t cpu_ns;
+} bench_mark_t;
+
+static void bench_mark(bench_mark_t *mark) {
+    host_bus_get_stats(&mark->bus);
+    mark->cpu_ns = thread_cpu_ns();
+}
+
+static void bench_accumulate(bench_path_t *path, const bench_mark_t *start, uint64_t units) {
+    bench_mark_t end;
+    bench_mark(&end);
+    uint64_t backend = end.bus.backend_cpu_ns - start->bus.backend_cpu_ns;
+    uint64_t cpu = end.cpu_ns - start->cpu_ns;
+
+    path->transactions += end.bus.transactions - start->bus.transactions;
+    path->bytes += end.bus.bytes - start->bus.bytes;
+    path->bus_ns += end.bus.bus_time_ns - start->bus.bus_time_ns;
+    path->cpu_ns += (cpu > backend) ? cpu - backend : 0;
+    path->units += units;
+}
+
+static bool bench_sample_matches(const bmi270_sim_t *sim, const bench_sample_t *sample) {
+    for (int i = 0; i < 3; i++) {
+        int16_t acc = (int16_t)(sim->regs[BMI270_REG_ACC_X_LSB + 2 * i] |
+                                (sim->regs[BMI270_REG_ACC_X_MSB + 2 * i] << 8));
+        int16_t gyr = (int16_t)(sim->regs[BMI270_REG_GYR_X_LSB + 2 * i] |
+                                (sim->regs[BMI270_REG_GYR_X_MSB + 2 * i] << 8));
+        if (fabsf(sample->acc_g[i] - acc / BENCH_ACC_LSB_PER_G) > BENCH_TOLERANCE ||
+            fabsf(sample->gyr_dps[i] - gyr / BENCH_GYR_LSB_PER_DPS) > BENCH_TOLERANCE * 100.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ====== Benchmark ====== */
+
+static bench_result_t bench_run(const bench_driver_t *driver, const bench_options_t *options) {
+    bench_result_t result = { .device_ram = driver->device_ram, .fifo_ram = driver->fifo_ram };
+    bench_mark_t mark;
+    host_heap_stats_t heap;
+    esp_err_t ret;
+
+    static bmi270_sim_t sim;
+    host_port_reset();
+    host_bus_set_timing(&(host_bus_timing_t){
+        .overhead_ns = options->overhead_ns,
+        .default_clock_hz = BENCH_SPI_CLOCK_HZ,
+    });
+    host_bus_set_cpu_accounting(true);
+    bmi270_sim_init(&sim, NULL);
+    bmi270_sim_attach(&sim);
+
+    // Init
+    bench_mark(&mark);
+    ret = driver->init();
+    bench_accumulate(&result.init, &mark, 1);
+    result.init_total_ns = host_clock_now_ns();
+    result.init_violations = sim.stats.lowpower_violations;
+    if (ret != ESP_OK ||
+        sim.regs[BMI270_REG_INTERNAL_STATUS] != BMI270_INTERNAL_STATUS_MSG_INIT_OK) {
+        fprintf(stderr, "%s: init failed (%s, INTERNAL_STATUS=0x%02X)\n", driver->name,
+                esp_err_to_name(ret), sim.regs[BMI270_REG_INTERNAL_STATUS]);
+        return result;
+    }
+
+    // Data register path: one read per ODR tick
+    uint64_t period_ns = bmi270_sim_sample_period_ns(&sim);
+    host_heap_reset_stats();
+    for (uint32_t i = 0; i < options->samples; i++) {
+        bench_sample_t sample;
+        host_clock_advance_ns(period_ns);
+        bench_mark(&mark);
+        ret = driver->read_sample(&sample);
+        bench_accumulate(&result.data, &mark, 1);
+        if (ret != ESP_OK) {
+            fprintf(stderr, "%s: read_sample failed (%s)\n", driver->name, esp_err_to_name(ret));
+            return result;
+        }
+        if (!bench_sample_matches(&sim, &sample)) {
+            result.data_mismatches++;
+        }
+    }
+    host_heap_get_stats(&heap);
+    result.data_heap_peak = heap.peak_bytes - heap.current_bytes;
+
+    // FIFO path: drain whenever the watermark is reached
+    ret = driver->fifo_setup(options->watermark);
+    if (ret != ESP_OK) {
+        fprintf(stderr, "%s: fifo_setup failed (%s)\n", driver->name, esp_err_to_name(ret));
+        return result;
+    }
+    uint64_t frames_before = sim.stats.fifo_frames;
+    uint64_t dropped_before = sim.stats.fifo_dropped_frames;
+    host_heap_reset_stats();
+    for (uint32_t i = 0; i < options->drains; i++) {
+        uint32_t samples = 0;
+        do {
+            host_clock_advance_ns(period_ns);
+            bmi270_sim_update(&sim);
+        } while (!bmi270_sim_watermark_reached(&sim));
+
+        bench_mark(&mark);
+        ret = driver->fifo_drain(&samples);
+        bench_accumulate(&result.fifo, &mark, samples);
+        if (ret != ESP_OK) {
+            fprintf(stderr, "%s: fifo_drain failed (%s)\n", driver->name, esp_err_to_name(ret));
+            return result;
+        }
+    }
+    host_heap_get_stats(&heap);
+    result.fifo_heap_peak = heap.peak_bytes - heap.current_bytes;
+    result.fifo_frames_expected = sim.stats.fifo_frames - frames_before - sim.fifo_length /
+                                  BMI270_FIFO_FRAME_ACC_GYR_SIZE;
+    result.fifo_dropped = sim.stats.fifo_dropped_frames - dropped_before;
+
+    result.ok = true;
+    return result;
+}
+
+/* ====== Report ====== */
+
+static double per_unit(uint64_t value, uint64_t units) {
+    return units ? (double)value / (double)units : 0.0;
+}
+
+static void print_row(const char *label, const bench_result_t *results, size_t count,
+                      double (*get)(const bench_result_t *), const char *format) {
+    printf("%-38s", label);
+    for (size_t i = 0; i < count; i++) {
+        if (results[i].ok) {
+            printf(format, get(&results[i]));
+        } else {
+            printf("%14s", "failed");
+        }
+    }
+    printf("\n");
+}
+
+#define BENCH_GETTER(name, expr) \
+    static double get_##name(const bench_result_t *r) { return (double)(expr); }
+
+BENCH_GETTER(init_trans, r->init.transactions)
+BENCH_GETTER(init_bytes, r->init.bytes)
+BENCH_GETTER(init_bus_us, r->init.bus_ns / 1000.0)
+BENCH_GETTER(init_total_ms, r->init_total_ns / 1e6)
+BENCH_GETTER(init_violations, r->init_violations)
+BENCH_GETTER(data_trans, per_unit(r->data.transactions, r->data.units))
+BENCH_GETTER(data_bytes, per_unit(r->data.bytes, r->data.units))
+BENCH_GETTER(data_bus_us, per_unit(r->data.bus_ns, r->data.units) / 1000.0)
+BENCH_GETTER(data_cpu_ns, per_unit(r->data.cpu_ns, r->data.units))
+BENCH_GETTER(data_mismatch, r->data_mismatches)
+BENCH_GETTER(data_heap, r->data_heap_peak)
+BENCH_GETTER(fifo_trans, per_unit(r->fifo.transactions, r->fifo.units))
+BENCH_GETTER(fifo_bytes, per_unit(r->fifo.bytes, r->fifo.units))
+BENCH_GETTER(fifo_bus_us, per_unit(r->fifo.bus_ns, r->fifo.units) / 1000.0)
+BENCH_GETTER(fifo_cpu_ns, per_unit(r->fifo.cpu_ns, r->fifo.units))
+BENCH_GETTER(fifo_samples, r->fifo.units)
+BENCH_GETTER(fifo_expected, r->fifo_frames_expected)
+BENCH_GETTER(fifo_heap, r->fifo_heap_peak)
+BENCH_GETTER(device_ram, r->device_ram)
+BENCH_GETTER(fifo_ram, r->fifo_ram)
+
+static void print_report(const bench_driver_t *const *drivers, const bench_result_t *results,
+                         size_t count, const bench_options_t *options) {
+    printf("BMI270 driver overhead benchmark (host, simulated sensor)\n");
+    printf("SPI %u Hz, %u ns per-transaction overhead, %u samples, %u drains, watermark %u bytes\n\n",
+           BENCH_SPI_CLOCK_HZ, options->overhead_ns, options->samples, options->drains,
+           options->watermark);
+
+    printf("%-38s", "");
+    for (size_t i = 0; i < count; i++) {
+        printf("%14s", drivers[i]->name);
+    }
+    printf("\n");
+
+    printf("[init]\n");
+    print_row("  transactions", results, count, get_init_trans, "%14.0f");
+    print_row("  bytes", results, count, get_init_bytes, "%14.0f");
+    print_row("  modelled bus time [us]", results, count, get_init_bus_us, "%14.1f");
+    print_row("  bring-up incl. delays [ms]", results, count, get_init_total_ms, "%14.2f");
+    print_row("  low-power timing violations", results, count, get_init_violations, "%14.0f");
+    printf("[data registers, per sample]\n");
+    print_row("  transactions", results, count, get_data_trans, "%14.2f");
+    print_row("  bytes", results, count, get_data_bytes, "%14.2f");
+    print_row("  modelled bus time [us]", results, count, get_data_bus_us, "%14.2f");
+    print_row("  host CPU [ns]", results, count, get_data_cpu_ns, "%14.1f");
+    print_row("  value mismatches", results, count, get_data_mismatch, "%14.0f");
+    print_row("  peak heap [bytes]", results, count, get_data_heap, "%14.0f");
+    printf("[FIFO, per sample]\n");
+    print_row("  transactions", results, count, get_fifo_trans, "%14.3f");
+    print_row("  bytes", results, count, get_fifo_bytes, "%14.2f");
+    print_row("  modelled bus time [us]", results, count, get_fifo_bus_us, "%14.3f");
+    print_row("  host CPU [ns]", results, count, get_fifo_cpu_ns, "%14.1f");
+    print_row("  samples decoded", results, count, get_fifo_samples, "%14.0f");
+    print_row("  samples produced by sensor", results, count, get_fifo_expected, "%14.0f");
+    print_row("  peak heap [bytes]", results, count, get_fifo_heap, "%14.0f");
+    printf("[static RAM]\n");
+    print_row("  device context [bytes]", results, count, get_device_ram, "%14.0f");
+    print_row("  FIFO path [bytes]", results, count, get_fifo_ram, "%14.0f");
+}
+
+/* ====== Main ====== */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [--samples N] [--drains N] [--watermark BYTES] [--overhead-ns NS]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    bench_options_t options = {
+        .samples = BENCH_DEFAULT_SAMPLES,
+        .drains = BENCH_DEFAULT_DRAINS,
+        .watermark = BENCH_DEFAULT_WATERMARK,
+        .overhead_ns = HOST_BUS_DEFAULT_OVERHEAD_NS,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--samples") == 0) {
+            options.samples = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--drains") == 0) {
+            options.drains = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--watermark") == 0) {
+            options.watermark = (uint16_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--overhead-ns") == 0) {
+            options.overhead_ns = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.watermark == 0 || options.watermark >= BMI270_FIFO_SIZE) {
+        fprintf(stderr, "watermark must be 1..%d bytes\n", BMI270_FIFO_SIZE - 1);
+        return 2;
+    }
+
+    const bench_driver_t *drivers[] = {
+        &bench_driver_stampfly,
+#ifdef BENCH_HAVE_BOSCH
+        &bench_driver_bosch,
+#endif
+    };
+    size_t count = sizeof(drivers) / sizeof(drivers[0]);
+    bench_result_t results[sizeof(drivers) / sizeof(drivers[0])];
+    int status = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        results[i] = bench_run(drivers[i], &options);
+        if (!results[i].ok || results[i].data_mismatches > 0) {
+            status = 1;
+        }
+    }
+
+    print_report(drivers, results, count, &options);
+#ifndef BENCH_HAVE_BOSCH
+    printf("\nBosch SensorAPI not built (configure with -DBMI270_BOSCH_SENSORAPI_DIR=<path>)\n");
+#endif
+    return status;
+}
@@ -0,0 +1,94 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bench_driver.h
+ * @brief Driver adapter interface for the comparative benchmark
+ *
+ * Each driver under comparison implements the same four operations on top
+ * of the host bus (host_bus_transfer() directly or via the spi_master
+ * shim), so that all bus activity is charged by the same model.
+ */
+
+#ifndef BENCH_DRIVER_H
+#define BENCH_DRIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_SPI_CLOCK_HZ      10000000    ///< Same clock as the StampFly examples
+#define BENCH_ACC_LSB_PER_G     8192.0f     ///< ±4 g
+#define BENCH_GYR_LSB_PER_DPS   16.4f       ///< ±2000 °/s
+
+/**
+ * @brief One converted sample (data register path)
+ */
+typedef struct {
+    float acc_g[3];                 ///< Acceleration [g]
+    float gyr_dps[3];               ///< Angular velocity [°/s]
+} bench_sample_t;
+
+/**
+ * @brief Driver adapter
+ *
+ * All drivers are brought up with the same configuration:
+ * ACC 1600 Hz ±4 g, GYR 1600 Hz ±2000 °/s, performance filter mode.
+ */
+typedef struct {
+    const char *name;
+    /// Full bring-up: bus setup, reset, config upload, sensor configuration
+    esp_err_t (*init)(void);
+    /// Read and convert one sample from the data registers
+    esp_err_t (*read_sample)(bench_sample_t *sample);
+    /// Configure a header-mode ACC+GYR FIFO with the given watermark [bytes]
+    esp_err_t (*fifo_setup)(uint16_t watermark);
+    /// Read and decode the FIFO; returns the number of ACC+GYR samples
+    esp_err_t (*fifo_drain)(uint32_t *samples);
+    /// Static RAM of the device context [bytes]
+    size_t device_ram;
+    /// Static RAM needed for the FIFO path (buffers, decoded frames) [bytes]
+    size_t fifo_ram;
+} bench_driver_t;
+
+/**
+ * @brief This driver
+ */
+extern const bench_driver_t bench_driver_stampfly;
+
+/**
+ * @brief Bosch BMI270 SensorAPI (only when built with BMI270_BOSCH_SENSORAPI_DIR)
+ */
+extern const bench_driver_t bench_driver_bosch;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_DRIVER_H
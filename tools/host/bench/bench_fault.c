@@ -0,0 +1,766 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bench_fault.c
+ * @brief Fault injection benchmark: detection and recovery latency
+ *
+ * Runs the FIFO stream (ACC+GYR 1600 Hz, watermark drains) behind the
+ * fault-injecting bus backend, with the supervision a flight application
+ * would add on top of the driver:
+ * - periodic CHIP_ID health check (one retry before giving up)
+ * - data stall watchdog (no samples for stall_ms)
+ * - register drift monitor, one block every regmap_ms (drift is written
+ *   back; a lost INIT_CTRL means the sensor was reset)
+ * - full re-initialization when either fires or a (re)init fails
+ *
+ * The simulated sensor encodes the ODR tick index and a check word in
+ * every sample, so the benchmark knows whether each delivered sample is
+ * intact and in sequence. Samples delivered while the sensor's range
+ * registers differ from the driver's cached ranges count as mis-scaled.
+ * For every scheduled fault it records:
+ * - detection latency: fault to the first signal from the driver or the
+ *   supervisor (error return, sync loss, reported frame loss, health
+ *   check, watchdog, register monitor)
+ * - recovery latency: fault to the first drain that delivers intact,
+ *   in-sequence samples again
+ * - outcome: masked (no visible effect), detected, silent (corrupt,
+ *   mis-scaled or missing samples delivered before any signal), unrecovered (still
+ *   open when the next fault or the end of the run arrived)
+ *
+ * The register monitor is also checked against the simulator's register
+ * file: drift or a reset reported while the sensor still held the expected
+ * configuration came from a corrupted read (bit error, drop, stuck), and
+ * any such false alarm makes the run exit with status 1.
+ *
+ * Everything runs on the virtual clock, so a run is reproducible from its
+ * seed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "host_port.h"
+#include "bmi270_sim.h"
+#include "bmi270_defs.h"
+#include "bus_fault.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_fifo_stream.h"
+#include "bmi270_regmap.h"
+
+#define FAULT_MAX_EVENTS            4096
+#define FAULT_DEFAULT_SEED          1
+#define FAULT_DEFAULT_DURATION_S    120
+#define FAULT_DEFAULT_SPACING_MS    400
+#define FAULT_DEFAULT_HEALTH_MS     100
+#define FAULT_DEFAULT_STALL_MS      50
+#define FAULT_DEFAULT_REGMAP_MS     10
+#define FAULT_DEFAULT_INTERVAL_MS   2000
+#define FAULT_WARMUP_US             500000ULL
+#define FAULT_REINIT_RETRY_US       10000ULL
+#define FAULT_WATERMARK             (32U * BMI270_FIFO_FRAME_ACC_GYR_SIZE)
+#define FAULT_LATENCY_BINS          24          // log2 µs
+
+/**
+ * @brief How a fault was first noticed
+ */
+typedef enum {
+    DETECT_NONE = 0,
+    DETECT_DRAIN_ERROR,         ///< bmi270_fifo_stream_drain() returned an error
+    DETECT_SYNC_LOST,           ///< Batch reported frame sync loss
+    DETECT_FRAME_LOSS,          ///< Batch reported dropped frames (skip frame)
+    DETECT_HEALTH_CHECK,        ///< CHIP_ID read failed or mismatched
+    DETECT_STALL,               ///< No samples within stall_ms
+    DETECT_INIT_ERROR,          ///< Re-initialization failed
+    DETECT_REG_DRIFT,           ///< Register monitor found drift (written back)
+    DETECT_REG_RESET,           ///< Register monitor found INIT_CTRL lost
+    DETECT_COUNT,
+} detect_source_t;
+
+static const char *const s_detect_names[DETECT_COUNT] = {
+    "-", "drain_error", "sync_lost", "frame_loss", "health_check", "stall", "init_error",
+    "reg_drift", "reg_reset",
+};
+
+typedef enum {
+    OUTCOME_PENDING = 0,
+    OUTCOME_MASKED,
+    OUTCOME_DETECTED,
+    OUTCOME_SILENT,
+    OUTCOME_UNRECOVERED,
+} outcome_t;
+
+/**
+ * @brief Per-event measurement
+ */
+typedef struct {
+    outcome_t outcome;
+    detect_source_t source;
+    uint64_t detect_us;         ///< 0 = not detected
+    uint64_t silent_us;         ///< First corrupt/unreported-gap delivery (0 = none)
+    uint64_t recover_us;        ///< 0 = not recovered
+} fault_result_t;
+
+typedef struct {
+    uint64_t seed;
+    uint32_t duration_s;
+    uint32_t spacing_ms;
+    uint32_t health_ms;
+    uint32_t stall_ms;
+    uint32_t regmap_ms;         ///< Register monitor step interval (0 = off)
+    bool custom_profile;
+    bus_fault_profile_t profile;
+    const char *csv_path;
+} fault_options_t;
+
+/**
+ * @brief Application under test: driver + supervisor
+ */
+typedef struct {
+    bmi270_dev_t dev;
+    bmi270_fifo_stream_t stream;
+    bmi270_regmap_monitor_t monitor;
+    bool up;
+    uint64_t last_health_us;
+    uint64_t last_regmap_us;
+    uint64_t last_sample_us;
+    uint64_t next_init_us;
+    uint32_t reinits;
+    // Sample sequence tracking
+    bool have_last;
+    uint32_t last_index;
+    bool discontinuity_reported;
+    // Signals raised during the current step
+    detect_source_t signal;
+    bool batch_clean;           ///< Last batch delivered intact, in-sequence samples
+    bool batch_corrupt;         ///< Last batch delivered corrupt or unreported-gap samples
+    // Totals
+    uint64_t samples_valid;
+    uint64_t samples_corrupt;
+    uint64_t samples_misscaled;
+    uint64_t unreported_gaps;
+    bmi270_regmap_stats_t regmap_total;     ///< Monitor counters of earlier bring-ups
+    uint32_t false_drift;       ///< Drift reported while the sensor held its configuration
+    uint32_t false_resets;      ///< Resets reported while the sensor held its configuration
+} fault_app_t;
+
+static bmi270_sim_t s_sim;
+static bus_fault_t s_fault;
+static bus_fault_event_t s_events[FAULT_MAX_EVENTS];
+static fault_result_t s_results[FAULT_MAX_EVENTS];
+static fault_app_t s_app;
+
+/* ====== Sample encoding ====== */
+
+static uint64_t fault_check_word(uint32_t index) {
+    uint64_t state = index;
+    return bus_fault_rand(&state);
+}
+
+/**
+ * @brief Sample source: tick index in ACC X/Y, check word in ACC Z and GYR
+ */
+static void fault_sample_source(void *ctx, uint64_t sample_index, int16_t acc[3], int16_t gyr[3]) {
+    (void)ctx;
+    uint32_t index = (uint32_t)(sample_index & 0x3FFFFFFF);
+    uint64_t check = fault_check_word(index);
+
+    acc[0] = (int16_t)(index & 0x7FFF);
+    acc[1] = (int16_t)((index >> 15) & 0x7FFF);
+    acc[2] = (int16_t)(check & 0xFFFF);
+    gyr[0] = (int16_t)((check >> 16) & 0xFFFF);
+    gyr[1] = (int16_t)((check >> 32) & 0xFFFF);
+    gyr[2] = (int16_t)((check >> 48) & 0xFFFF);
+}
+
+static bool fault_sample_decode(const bmi270_fifo_sample_t *sample, uint32_t *index) {
+    if (sample->acc.x < 0 || sample->acc.y < 0) {
+        return false;
+    }
+    uint32_t decoded = (uint32_t)sample->acc.x | ((uint32_t)sample->acc.y << 15);
+    uint64_t check = fault_check_word(decoded);
+
+    if (sample->acc.z != (int16_t)(check & 0xFFFF) ||
+        sample->gyr.x != (int16_t)((check >> 16) & 0xFFFF) ||
+        sample->gyr.y != (int16_t)((check >> 32) & 0xFFFF) ||
+        sample->gyr.z != (int16_t)((check >> 48) & 0xFFFF)) {
+        return false;
+    }
+    *index = decoded;
+    return true;
+}
+
+/* ====== Application ====== */
+
+static void fault_signal(fault_app_t *app, detect_source_t source) {
+    if (app->signal == DETECT_NONE) {
+        app->signal = source;
+    }
+}
+
+static void fault_batch_cb(const bmi270_fifo_batch_t *batch, void *user_ctx) {
+    fault_app_t *app = (fault_app_t *)user_ctx;
+
+    if (batch->sync_lost) {
+        fault_signal(app, DETECT_SYNC_LOST);
+        app->discontinuity_reported = true;
+    }
+    if (batch->lost_frames > 0) {
+        fault_signal(app, DETECT_FRAME_LOSS);
+        app->discontinuity_reported = true;
+    }
+
+    // The driver scales with its cached ranges; an upset range register goes unnoticed in the data
+    bool misscaled = (s_sim.regs[BMI270_REG_ACC_RANGE] & 0x03) != app->dev.acc_range ||
+                     (s_sim.regs[BMI270_REG_GYR_RANGE] & 0x07) != app->dev.gyr_range;
+    bool clean = (batch->sample_count > 0);
+    for (uint16_t i = 0; i < batch->sample_count; i++) {
+        uint32_t index;
+        if (!fault_sample_decode(&batch->samples[i], &index)) {
+            app->samples_corrupt++;
+            clean = false;
+            continue;
+        }
+        if (app->have_last && index != app->last_index + 1) {
+            if (!app->discontinuity_reported) {
+                app->unreported_gaps++;
+                clean = false;
+            }
+        }
+        app->discontinuity_reported = false;
+        app->have_last = true;
+        app->last_index = index;
+        app->last_sample_us = (uint64_t)esp_timer_get_time();
+        if (misscaled) {
+            app->samples_misscaled++;
+            clean = false;
+            continue;
+        }
+        app->samples_valid++;
+    }
+    app->batch_clean = clean;
+    app->batch_corrupt = (batch->sample_count > 0 && !clean);
+}
+
+static void fault_app_collect_regmap(fault_app_t *app) {
+    const bmi270_regmap_stats_t *stats = &app->monitor.stats;
+    app->regmap_total.bursts += stats->bursts;
+    app->regmap_total.read_errors += stats->read_errors;
+    app->regmap_total.drift_events += stats->drift_events;
+    app->regmap_total.drifted_regs += stats->drifted_regs;
+    app->regmap_total.unconfirmed += stats->unconfirmed;
+    app->regmap_total.resets_detected += stats->resets_detected;
+    app->regmap_total.reapplied += stats->reapplied;
+    app->regmap_total.reapply_failures += stats->reapply_failures;
+    memset(&app->monitor.stats, 0, sizeof(app->monitor.stats));
+}
+
+static esp_err_t fault_app_bringup(fault_app_t *app, const fault_options_t *options) {
+    esp_err_t ret = bmi270_init(&app->dev);
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_range(&app->dev, BMI270_ACC_RANGE_4G);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_range(&app->dev, BMI270_GYR_RANGE_2000DPS);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_config(&app->dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_config(&app->dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK) {
+        bmi270_fifo_stream_config_t config = {
+            .watermark = FAULT_WATERMARK,
+            .int_pin = BMI270_INT_PIN_1,
+            .aux_enable = false,
+            .callback = fault_batch_cb,
+            .user_ctx = app,
+        };
+        ret = bmi270_fifo_stream_init(&app->stream, &app->dev, &config);
+    }
+    if (ret == ESP_OK && options->regmap_ms > 0) {
+        bmi270_regmap_config_t regmap_config = { .reapply = true };
+        fault_app_collect_regmap(app);
+        ret = bmi270_regmap_monitor_init(&app->monitor, &app->dev, &regmap_config);
+    }
+
+    uint64_t now_us = (uint64_t)esp_timer_get_time();
+    app->up = (ret == ESP_OK);
+    app->discontinuity_reported = true;
+    app->last_health_us = now_us;
+    app->last_regmap_us = now_us;
+    app->last_sample_us = now_us;
+    if (!app->up) {
+        app->next_init_us = now_us + FAULT_REINIT_RETRY_US;
+        fault_signal(app, DETECT_INIT_ERROR);
+    }
+    return ret;
+}
+
+static void fault_app_restart(fault_app_t *app, detect_source_t source) {
+    fault_signal(app, source);
+    app->up = false;
+    app->next_init_us = 0;
+}
+
+static bool fault_app_chip_id_ok(fault_app_t *app) {
+    uint8_t chip_id = 0;
+    return bmi270_read_register(&app->dev, BMI270_REG_CHIP_ID, &chip_id) == ESP_OK &&
+           chip_id == BMI270_CHIP_ID;
+}
+
+/**
+ * @brief One ODR tick of application time
+ */
+static void fault_app_step(fault_app_t *app, const fault_options_t *options) {
+    uint64_t now_us = (uint64_t)esp_timer_get_time();
+
+    if (!app->up) {
+        if (now_us >= app->next_init_us) {
+            app->reinits++;
+            fault_app_bringup(app, options);
+        }
+        return;
+    }
+
+    // Watermark interrupt
+    if (bmi270_sim_watermark_reached(&s_sim)) {
+        bmi270_fifo_stream_notify_from_isr(&app->stream);
+        if (bmi270_fifo_stream_drain(&app->stream) != ESP_OK) {
+            fault_signal(app, DETECT_DRAIN_ERROR);
+        }
+    }
+
+    now_us = (uint64_t)esp_timer_get_time();
+    if (options->regmap_ms > 0 && now_us - app->last_regmap_us >= options->regmap_ms * 1000ULL) {
+        app->last_regmap_us = now_us;
+        // Ground truth: anything reported while the simulated sensor still holds the
+        // expected configuration (and no upset/reset lands during the step) came from
+        // a corrupted read
+        bmi270_regmap_snapshot_t truth;
+        memcpy(truth.regs, s_sim.regs, sizeof(truth.regs));
+        bool held = bmi270_regmap_diff(&app->monitor.expected, &truth, NULL, 0) == 0;
+        uint64_t upsets = s_fault.stats.corrupted[BUS_FAULT_REG_UPSET] + s_fault.stats.corrupted[BUS_FAULT_RESET];
+
+        bmi270_regmap_report_t report;
+        bmi270_regmap_monitor_step(&app->monitor, &report);
+        held = held && upsets == s_fault.stats.corrupted[BUS_FAULT_REG_UPSET] +
+                                 s_fault.stats.corrupted[BUS_FAULT_RESET];
+        if (held && report.reset_detected) {
+            app->false_resets++;
+        } else if (held && report.count > 0) {
+            app->false_drift++;
+        }
+        // Bus errors are left to the health check; drift has been written back already
+        if (report.reset_detected) {
+            fault_app_restart(app, DETECT_REG_RESET);
+            return;
+        }
+        if (report.count > 0) {
+            fault_signal(app, DETECT_REG_DRIFT);
+        }
+    }
+    if (now_us - app->last_health_us >= options->health_ms * 1000ULL) {
+        app->last_health_us = now_us;
+        if (!fault_app_chip_id_ok(app)) {
+            // One retry before treating it as a lost sensor
+            fault_signal(app, DETECT_HEALTH_CHECK);
+            if (!fault_app_chip_id_ok(app)) {
+                fault_app_restart(app, DETECT_HEALTH_CHECK);
+                return;
+            }
+        }
+    }
+    if (now_us - app->last_sample_us >= options->stall_ms * 1000ULL) {
+        fault_app_restart(app, DETECT_STALL);
+    }
+}
+
+/* ====== Event bookkeeping ====== */
+
+static void fault_track(size_t *open, size_t *next_open, uint64_t now_us) {
+    fault_app_t *app = &s_app;
+
+    // Open newly applied events; an event still open is superseded. Events the
+    // injector superseded before they hit a frame are never applied: pass over them
+    while (*next_open < s_fault.event_count &&
+           (s_events[*next_open].applied_us != 0 || s_events[*next_open].skipped)) {
+        if (s_events[*next_open].skipped) {
+            (*next_open)++;
+            continue;
+        }
+        if (*open != SIZE_MAX && s_results[*open].outcome == OUTCOME_PENDING) {
+            s_results[*open].outcome = OUTCOME_UNRECOVERED;
+        }
+        *open = (*next_open)++;
+        app->batch_clean = false;
+        app->batch_corrupt = false;
+    }
+
+    if (*open == SIZE_MAX) {
+        app->signal = DETECT_NONE;
+        return;
+    }
+
+    fault_result_t *result = &s_results[*open];
+    const bus_fault_event_t *event = &s_events[*open];
+    bool complete = (event->applied >= event->count);
+
+    if (result->outcome == OUTCOME_PENDING) {
+        if (app->signal != DETECT_NONE && result->detect_us == 0) {
+            result->detect_us = now_us;
+            result->source = app->signal;
+        }
+        if (app->batch_corrupt && result->silent_us == 0 && result->detect_us == 0) {
+            result->silent_us = now_us;
+        }
+        if (app->batch_clean && complete && app->up) {
+            bool anomaly = (result->detect_us != 0 || result->silent_us != 0);
+            result->recover_us = now_us;
+            result->outcome = !anomaly ? OUTCOME_MASKED
+                            : (result->silent_us != 0) ? OUTCOME_SILENT : OUTCOME_DETECTED;
+            *open = SIZE_MAX;
+        }
+    }
+
+    app->signal = DETECT_NONE;
+    app->batch_clean = false;
+    app->batch_corrupt = false;
+}
+
+/* ====== Report ====== */
+
+static int fault_latency_bin(uint64_t latency_us) {
+    if (latency_us == 0) {
+        return 0;
+    }
+    int bin = 63 - __builtin_clzll(latency_us);
+    return (bin < FAULT_LATENCY_BINS) ? bin : FAULT_LATENCY_BINS - 1;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t va = *(const uint64_t *)a;
+    uint64_t vb = *(const uint64_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+static uint64_t percentile(const uint64_t *sorted, size_t count, double p) {
+    if (count == 0) {
+        return 0;
+    }
+    size_t index = (size_t)(p * (double)(count - 1) + 0.5);
+    return sorted[index];
+}
+
+static void print_distribution(const char *label, uint64_t *values, size_t count) {
+    qsort(values, count, sizeof(values[0]), cmp_u64);
+    printf("    %-10s n=%-5zu p50=%-9llu p90=%-9llu p99=%-9llu max=%-9llu [us]\n", label, count,
+           (unsigned long long)percentile(values, count, 0.50),
+           (unsigned long long)percentile(values, count, 0.90),
+           (unsigned long long)percentile(values, count, 0.99),
+           (unsigned long long)(count ? values[count - 1] : 0));
+}
+
+static void print_histogram(const uint64_t *values, size_t count) {
+    uint32_t hist[FAULT_LATENCY_BINS] = {0};
+    uint32_t peak = 0;
+    for (size_t i = 0; i < count; i++) {
+        int bin = fault_latency_bin(values[i]);
+        if (++hist[bin] > peak) {
+            peak = hist[bin];
+        }
+    }
+    for (int bin = 0; bin < FAULT_LATENCY_BINS; bin++) {
+        if (hist[bin] == 0) {
+            continue;
+        }
+        int bar = (int)((hist[bin] * 40U + peak - 1) / peak);
+        printf("    %8llu-%-8llu %5u %.*s\n", (unsigned long long)(1ULL << bin),
+               (unsigned long long)((2ULL << bin) - 1), hist[bin], bar,
+               "########################################");
+    }
+}
+
+static void fault_report(size_t event_count, const fault_options_t *options) {
+    static uint64_t detect[FAULT_MAX_EVENTS];
+    static uint64_t recover[FAULT_MAX_EVENTS];
+    static uint64_t recover_all[FAULT_MAX_EVENTS];
+    size_t recover_all_count = 0;
+
+    printf("BMI270 fault injection benchmark (host, simulated sensor)\n");
+    printf("seed %llu, %u s, %zu faults, health check %u ms, stall watchdog %u ms, "
+           "register monitor %u ms, re-inits %u\n",
+           (unsigned long long)options->seed, options->duration_s, event_count, options->health_ms,
+           options->stall_ms, options->regmap_ms, s_app.reinits);
+    printf("samples: %llu intact, %llu corrupt delivered, %llu mis-scaled, %llu unreported gaps\n",
+           (unsigned long long)s_app.samples_valid, (unsigned long long)s_app.samples_corrupt,
+           (unsigned long long)s_app.samples_misscaled, (unsigned long long)s_app.unreported_gaps);
+    fault_app_collect_regmap(&s_app);
+    const bmi270_regmap_stats_t *regmap = &s_app.regmap_total;
+    printf("register monitor: %u bursts, %u drift events (%u registers, %u written back, %u failed), "
+           "%u resets, %u unconfirmed\n",
+           regmap->bursts, regmap->drift_events, regmap->drifted_regs, regmap->reapplied,
+           regmap->reapply_failures, regmap->resets_detected, regmap->unconfirmed);
+    printf("false alarms from corrupted reads: %u drift, %u resets\n\n", s_app.false_drift,
+           s_app.false_resets);
+
+    printf("%-10s %6s %7s %7s %9s %7s %11s  first detection\n",
+           "type", "events", "applied", "masked", "detected", "silent", "unrecovered");
+    for (int type = 0; type < BUS_FAULT_TYPE_COUNT; type++) {
+        uint32_t counts[OUTCOME_UNRECOVERED + 1] = {0};
+        uint32_t sources[DETECT_COUNT] = {0};
+        uint32_t events = 0;
+        uint32_t applied = 0;
+        for (size_t i = 0; i < event_count; i++) {
+            if (s_events[i].type != (bus_fault_type_t)type) {
+                continue;
+            }
+            events++;
+            if (s_events[i].applied_us != 0) {
+                applied++;
+                counts[s_results[i].outcome]++;
+                sources[s_results[i].source]++;
+            }
+        }
+        if (events == 0) {
+            continue;
+        }
+        printf("%-10s %6u %7u %7u %9u %7u %11u  ", bus_fault_type_name(type), events, applied,
+               counts[OUTCOME_MASKED], counts[OUTCOME_DETECTED], counts[OUTCOME_SILENT],
+               counts[OUTCOME_UNRECOVERED] + counts[OUTCOME_PENDING]);
+        for (int source = DETECT_NONE + 1; source < DETECT_COUNT; source++) {
+            if (sources[source] > 0) {
+                printf("%s:%u ", s_detect_names[source], sources[source]);
+            }
+        }
+        printf("\n");
+    }
+
+    printf("\nLatency from fault to detection / recovery\n");
+    for (int type = 0; type < BUS_FAULT_TYPE_COUNT; type++) {
+        size_t detect_count = 0;
+        size_t recover_count = 0;
+        for (size_t i = 0; i < event_count; i++) {
+            const fault_result_t *result = &s_results[i];
+            if (s_events[i].type != (bus_fault_type_t)type || s_events[i].applied_us == 0 ||
+                result->outcome == OUTCOME_MASKED || result->outcome == OUTCOME_PENDING ||
+                result->outcome == OUTCOME_UNRECOVERED) {
+                continue;
+            }
+            if (result->detect_us != 0) {
+                detect[detect_count++] = result->detect_us - s_events[i].applied_us;
+            }
+            recover[recover_count++] = result->recover_us - s_events[i].applied_us;
+            recover_all[recover_all_count++] = result->recover_us - s_events[i].applied_us;
+        }
+        if (recover_count == 0) {
+            continue;
+        }
+        printf("  %s\n", bus_fault_type_name(type));
+        print_distribution("detection", detect, detect_count);
+        print_distribution("recovery", recover, recover_count);
+    }
+
+    if (recover_all_count > 0) {
+        printf("\nRecovery latency histogram, all types [us]\n");
+        print_histogram(recover_all, recover_all_count);
+    }
+}
+
+static void fault_write_csv(const char *path, size_t event_count) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return;
+    }
+    static const char *const outcome_names[] = {
+        "pending", "masked", "detected", "silent", "unrecovered",
+    };
+    fprintf(file, "index,type,time_us,count,param,applied_us,outcome,detected_by,"
+                  "detect_latency_us,recover_latency_us\n");
+    for (size_t i = 0; i < event_count; i++) {
+        const bus_fault_event_t *event = &s_events[i];
+        const fault_result_t *result = &s_results[i];
+        fprintf(file, "%zu,%s,%llu,%u,%u,%llu,%s,%s,%lld,%lld\n", i, bus_fault_type_name(event->type),
+                (unsigned long long)event->time_us, event->count, event->param,
+                (unsigned long long)event->applied_us,
+                event->skipped ? "skipped" : outcome_names[result->outcome],
+                s_detect_names[result->source],
+                result->detect_us ? (long long)(result->detect_us - event->applied_us) : -1LL,
+                result->recover_us ? (long long)(result->recover_us - event->applied_us) : -1LL);
+    }
+    fclose(file);
+}
+
+/* ====== Main ====== */
+
+static bool parse_fault_spec(const char *spec, bus_fault_profile_t *profile) {
+    char name[16];
+    unsigned interval = FAULT_DEFAULT_INTERVAL_MS;
+    unsigned count = 1;
+    unsigned param = 0;
+
+    int fields = sscanf(spec, "%15[a-z_]:%u:%u:%i", name, &interval, &count, (int *)&param);
+    if (fields < 1) {
+        return false;
+    }
+    for (int type = 0; type < BUS_FAULT_TYPE_COUNT; type++) {
+        if (strcmp(name, bus_fault_type_name(type)) == 0) {
+            bus_fault_rate_t *rate = &profile->rate[type];
+            rate->mean_interval_ms = interval;
+            if (fields >= 3) {
+                rate->count = (uint16_t)count;
+            }
+            if (fields >= 4) {
+                rate->param = param;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [--seed N] [--duration-s S] [--spacing-ms MS] [--health-ms MS]\n"
+            "          [--stall-ms MS] [--regmap-ms MS] [--fault TYPE[:INTERVAL_MS[:COUNT[:PARAM]]]]...\n"
+            "          [--csv FILE]\n"
+            "types: bit_error drop stuck delay timeout chip_id reg_upset reset\n"
+            "       (default: all, %u ms mean interval)\n",
+            prog, FAULT_DEFAULT_INTERVAL_MS);
+}
+
+int main(int argc, char **argv) {
+    fault_options_t options = {
+        .seed = FAULT_DEFAULT_SEED,
+        .duration_s = FAULT_DEFAULT_DURATION_S,
+        .spacing_ms = FAULT_DEFAULT_SPACING_MS,
+        .health_ms = FAULT_DEFAULT_HEALTH_MS,
+        .stall_ms = FAULT_DEFAULT_STALL_MS,
+        .regmap_ms = FAULT_DEFAULT_REGMAP_MS,
+        .profile.rate = {
+            [BUS_FAULT_BIT_ERROR] = { 0, 1, 0 },
+            [BUS_FAULT_DROP]      = { 0, 1, 0 },
+            [BUS_FAULT_STUCK]     = { 0, 2, 0x00 },
+            [BUS_FAULT_DELAY]     = { 0, 1, 30000 },
+            [BUS_FAULT_TIMEOUT]   = { 0, 1, 1000 },
+            [BUS_FAULT_CHIP_ID]   = { 0, 1, 0x00 },
+            [BUS_FAULT_REG_UPSET] = { 0, 1, (BMI270_REG_ACC_RANGE << 8) | 0x02 },  // ±8 g reset value
+            [BUS_FAULT_RESET]     = { 0, 1, 0 },
+        },
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+            options.seed = strtoull(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--duration-s") == 0) {
+            options.duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--spacing-ms") == 0) {
+            options.spacing_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--health-ms") == 0) {
+            options.health_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--stall-ms") == 0) {
+            options.stall_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--regmap-ms") == 0) {
+            options.regmap_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--fault") == 0) {
+            options.custom_profile = true;
+            if (!parse_fault_spec(argv[++i], &options.profile)) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (i + 1 < argc && strcmp(argv[i], "--csv") == 0) {
+            options.csv_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!options.custom_profile) {
+        for (int type = 0; type < BUS_FAULT_TYPE_COUNT; type++) {
+            options.profile.rate[type].mean_interval_ms = FAULT_DEFAULT_INTERVAL_MS;
+        }
+    }
+
+    // Board: simulator behind the fault injector
+    host_port_reset();
+    bmi270_sim_config_t sim_config = { .source = fault_sample_source };
+    bmi270_sim_init(&s_sim, &sim_config);
+    bmi270_sim_attach(&s_sim);
+
+    bmi270_config_t config = {
+        .gpio_mosi = 14,
+        .gpio_miso = 43,
+        .gpio_sclk = 44,
+        .gpio_cs = 46,
+        .spi_clock_hz = 10000000,
+        .spi_host = SPI2_HOST,
+        .gpio_other_cs = 12,
+    };
+    if (bmi270_spi_init(&s_app.dev, &config) != ESP_OK || fault_app_bringup(&s_app, &options) != ESP_OK) {
+        fprintf(stderr, "bring-up failed\n");
+        return 1;
+    }
+
+    options.profile.min_spacing_ms = options.spacing_ms;
+    options.profile.start_us = (uint64_t)esp_timer_get_time() + FAULT_WARMUP_US;
+    options.profile.duration_us = (uint64_t)options.duration_s * 1000000ULL;
+    size_t event_count = bus_fault_schedule_generate(&options.profile, options.seed, s_events,
+                                                     FAULT_MAX_EVENTS);
+    bus_fault_init(&s_fault, s_events, event_count, options.seed);
+    bus_fault_attach(&s_fault);
+
+    // Run until the schedule has passed plus time for the last recovery
+    uint64_t end_us = options.profile.start_us + options.profile.duration_us + options.spacing_ms * 1000ULL;
+    uint64_t period_ns = bmi270_sim_sample_period_ns(&s_sim);
+    size_t open = SIZE_MAX;
+    size_t next_open = 0;
+    s_app.signal = DETECT_NONE;
+
+    while ((uint64_t)esp_timer_get_time() < end_us) {
+        host_clock_advance_ns(period_ns);
+        bmi270_sim_update(&s_sim);
+        fault_app_step(&s_app, &options);
+        fault_track(&open, &next_open, (uint64_t)esp_timer_get_time());
+    }
+    if (open != SIZE_MAX && s_results[open].outcome == OUTCOME_PENDING) {
+        s_results[open].outcome = OUTCOME_UNRECOVERED;
+    }
+
+    fault_report(event_count, &options);
+    if (options.csv_path != NULL) {
+        fault_write_csv(options.csv_path, event_count);
+    }
+    // Bit errors, dropped and stuck frames must never be written back or taken for a reset
+    if (s_app.false_drift > 0 || s_app.false_resets > 0) {
+        fprintf(stderr, "FAIL: register monitor acted on corrupted reads\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,349 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bench_governor.c
+ * @brief Load governor benchmark: critical deadline under an overloaded batch callback
+ *
+ * Runs the FIFO stream (ACC+GYR 1600 Hz, 32-frame watermark = 20 ms) with
+ * four stages in the batch callback. Their cost is spent on the virtual
+ * clock and models a flight task:
+ * - attitude (CRITICAL): 40 us per sample
+ * - sdlog (LOGGING, deferrable): 100 us per sample, plus a 30 ms flash
+ *   erase every 64 writes
+ * - metrics (METRICS): 60 us per sample
+ * - telemetry (TELEMETRY): 0.5 ms + 450 us per sample (slow radio link)
+ *
+ * Together they need more than one sample period per sample, so calling
+ * them straight from the callback falls further behind with every batch
+ * until the FIFO overflows. The same load is then run through the
+ * governor, with a small batch pool for the deferred log writes.
+ *
+ * The simulated sensor encodes the ODR tick index in every sample, and
+ * the attitude stage measures the age of the oldest sample it is handed.
+ * The critical deadline is two watermark periods (one to reach the
+ * watermark, one for the callback).
+ *
+ * Everything runs on the virtual clock, so every run gives the same result.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_port.h"
+#include "bmi270_sim.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_fifo_stream.h"
+#include "bmi270_batch_pool.h"
+#include "bmi270_governor.h"
+
+#define GOV_DEFAULT_DURATION_S      60
+#define GOV_DEFAULT_POOL_BUFFERS    4
+#define GOV_ODR_HZ                  1600
+#define GOV_WATERMARK               (32U * BMI270_FIFO_FRAME_ACC_GYR_SIZE)
+#define GOV_RING_SIZE               1024U       // Sample times kept (> FIFO capacity in frames)
+
+// Stage costs
+#define GOV_ATTITUDE_US_PER_SAMPLE  40
+#define GOV_SDLOG_US_PER_SAMPLE     100
+#define GOV_SDLOG_ERASE_US          30000
+#define GOV_SDLOG_ERASE_EVERY       64
+#define GOV_METRICS_US_PER_SAMPLE   60
+#define GOV_TELEMETRY_US            500
+#define GOV_TELEMETRY_US_PER_SAMPLE 450
+
+static const char *const s_class_names[BMI270_GOVERNOR_CLASS_COUNT] = {
+    "critical", "logging", "metrics", "telemetry",
+};
+
+/**
+ * @brief One run: board, stream and what the stages observed
+ */
+typedef struct {
+    bmi270_sim_t sim;
+    bmi270_dev_t dev;
+    bmi270_fifo_stream_t stream;
+    bmi270_batch_pool_t pool;
+    bmi270_batch_buf_t pool_buffers[BMI270_BATCH_POOL_MAX_BUFFERS];
+    bmi270_governor_t gov;
+    uint64_t sample_time_ns[GOV_RING_SIZE];     ///< Production time per ODR tick (ring)
+    uint64_t period_us;                         ///< Watermark period
+    // Observed by the stages
+    uint32_t critical_batches;
+    uint32_t critical_misses;
+    uint64_t critical_max_age_us;
+    uint32_t sdlog_writes;
+    uint32_t sdlog_erases;
+    uint32_t telemetry_sent;
+    // Stream counters at the end of the run
+    bmi270_fifo_stats_t fifo;
+} gov_run_t;
+
+static gov_run_t s_runs[2];
+
+/* ====== Sensor ====== */
+
+/**
+ * @brief Sample source: tick index in ACC X/Y, production time kept in the ring
+ */
+static void gov_sample_source(void *ctx, uint64_t sample_index, int16_t acc[3], int16_t gyr[3]) {
+    gov_run_t *run = ctx;
+    uint32_t index = (uint32_t)(sample_index & 0x3FFFFFFF);
+
+    run->sample_time_ns[index % GOV_RING_SIZE] = run->sim.next_sample_ns;
+    acc[0] = (int16_t)(index & 0x7FFF);
+    acc[1] = (int16_t)((index >> 15) & 0x7FFF);
+    acc[2] = 8192;
+    gyr[0] = gyr[1] = gyr[2] = 0;
+}
+
+/* ====== Stages ====== */
+
+static void gov_spend_us(uint64_t us) {
+    host_clock_advance_ns(us * 1000ULL);
+}
+
+static void gov_attitude_stage(const bmi270_fifo_batch_t *batch, bool deferred, void *ctx) {
+    gov_run_t *run = ctx;
+    (void)deferred;
+
+    if (batch->sample_count > 0) {
+        const bmi270_fifo_sample_t *oldest = &batch->samples[0];
+        uint32_t index = (uint32_t)oldest->acc.x | ((uint32_t)oldest->acc.y << 15);
+        uint64_t age_us = (host_clock_now_ns() - run->sample_time_ns[index % GOV_RING_SIZE]) / 1000ULL;
+        run->critical_batches++;
+        if (age_us > 2 * run->period_us) {
+            run->critical_misses++;
+        }
+        if (age_us > run->critical_max_age_us) {
+            run->critical_max_age_us = age_us;
+        }
+    }
+    gov_spend_us((uint64_t)GOV_ATTITUDE_US_PER_SAMPLE * batch->sample_count);
+}
+
+static void gov_sdlog_stage(const bmi270_fifo_batch_t *batch, bool deferred, void *ctx) {
+    gov_run_t *run = ctx;
+    (void)deferred;
+
+    gov_spend_us((uint64_t)GOV_SDLOG_US_PER_SAMPLE * batch->sample_count);
+    if (++run->sdlog_writes % GOV_SDLOG_ERASE_EVERY == 0) {
+        run->sdlog_erases++;
+        gov_spend_us(GOV_SDLOG_ERASE_US);
+    }
+}
+
+static void gov_metrics_stage(const bmi270_fifo_batch_t *batch, bool deferred, void *ctx) {
+    (void)deferred;
+    (void)ctx;
+    gov_spend_us((uint64_t)GOV_METRICS_US_PER_SAMPLE * batch->sample_count);
+}
+
+static void gov_telemetry_stage(const bmi270_fifo_batch_t *batch, bool deferred, void *ctx) {
+    gov_run_t *run = ctx;
+    (void)deferred;
+
+    run->telemetry_sent++;
+    gov_spend_us(GOV_TELEMETRY_US + (uint64_t)GOV_TELEMETRY_US_PER_SAMPLE * batch->sample_count);
+}
+
+/**
+ * @brief Without the governor: every stage, every batch
+ */
+static void gov_direct_cb(const bmi270_fifo_batch_t *batch, void *user_ctx) {
+    gov_attitude_stage(batch, false, user_ctx);
+    gov_sdlog_stage(batch, false, user_ctx);
+    gov_metrics_stage(batch, false, user_ctx);
+    gov_telemetry_stage(batch, false, user_ctx);
+}
+
+/* ====== Run ====== */
+
+static esp_err_t gov_run(gov_run_t *run, bool governed, uint32_t duration_s, uint8_t pool_buffers) {
+    memset(run, 0, sizeof(*run));
+    host_port_reset();
+    bmi270_sim_config_t sim_config = { .source = gov_sample_source, .source_ctx = run };
+    bmi270_sim_init(&run->sim, &sim_config);
+    bmi270_sim_attach(&run->sim);
+
+    bmi270_config_t config = {
+        .gpio_mosi = 14,
+        .gpio_miso = 43,
+        .gpio_sclk = 44,
+        .gpio_cs = 46,
+        .spi_clock_hz = 10000000,
+        .spi_host = SPI2_HOST,
+        .gpio_other_cs = 12,
+    };
+    esp_err_t ret = bmi270_spi_init(&run->dev, &config);
+    if (ret == ESP_OK) {
+        ret = bmi270_init(&run->dev);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_config(&run->dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_config(&run->dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK && governed) {
+        ret = bmi270_batch_pool_init(&run->pool, run->pool_buffers, pool_buffers);
+    }
+    if (ret == ESP_OK) {
+        bmi270_fifo_stream_config_t stream_config = {
+            .watermark = GOV_WATERMARK,
+            .int_pin = BMI270_INT_PIN_1,
+            .callback = governed ? bmi270_governor_batch_cb : gov_direct_cb,
+            .user_ctx = governed ? (void *)&run->gov : (void *)run,
+            .pool = governed ? &run->pool : NULL,
+        };
+        ret = bmi270_fifo_stream_init(&run->stream, &run->dev, &stream_config);
+    }
+    if (ret == ESP_OK && governed) {
+        bmi270_governor_config_t governor_config = { .odr_hz = GOV_ODR_HZ };
+        ret = bmi270_governor_init(&run->gov, &run->stream, &governor_config);
+        // Registered out of order on purpose: the governor sorts by class
+        const bmi270_governor_stage_config_t stages[] = {
+            { "telemetry", BMI270_GOVERNOR_TELEMETRY, gov_telemetry_stage, run, false },
+            { "attitude", BMI270_GOVERNOR_CRITICAL, gov_attitude_stage, run, false },
+            { "sdlog", BMI270_GOVERNOR_LOGGING, gov_sdlog_stage, run, true },
+            { "metrics", BMI270_GOVERNOR_METRICS, gov_metrics_stage, run, false },
+        };
+        for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]) && ret == ESP_OK; i++) {
+            ret = bmi270_governor_add_stage(&run->gov, &stages[i]);
+        }
+    }
+    if (ret != ESP_OK) {
+        fprintf(stderr, "bring-up failed (%s)\n", esp_err_to_name(ret));
+        host_bus_reset();
+        return ret;
+    }
+
+    run->period_us = (uint64_t)(GOV_WATERMARK / BMI270_FIFO_FRAME_ACC_GYR_SIZE) * 1000000ULL / GOV_ODR_HZ;
+    uint64_t period_ns = bmi270_sim_sample_period_ns(&run->sim);
+    uint64_t end_ns = host_clock_now_ns() + (uint64_t)duration_s * 1000000000ULL;
+    while (host_clock_now_ns() < end_ns) {
+        host_clock_advance_ns(period_ns);
+        bmi270_sim_update(&run->sim);
+        if (bmi270_sim_watermark_reached(&run->sim)) {
+            bmi270_fifo_stream_notify_from_isr(&run->stream);
+            bmi270_fifo_stream_drain(&run->stream);
+        }
+    }
+    if (governed) {
+        bmi270_governor_flush(&run->gov);
+    }
+    while (bmi270_fifo_stream_get_stats(&run->stream, &run->fifo) == ESP_ERR_TIMEOUT) {
+    }
+    host_bus_reset();
+    return ESP_OK;
+}
+
+/* ====== Report ====== */
+
+static void print_row(const char *label, uint64_t direct, uint64_t governed) {
+    printf("%-34s %10llu %10llu\n", label, (unsigned long long)direct, (unsigned long long)governed);
+}
+
+static int gov_report(uint32_t duration_s) {
+    const gov_run_t *direct = &s_runs[0];
+    const gov_run_t *governed = &s_runs[1];
+
+    printf("BMI270 load governor benchmark (host, simulated sensor)\n");
+    printf("%u Hz, watermark %u frames = %llu us, %u s, critical deadline %llu us\n", GOV_ODR_HZ,
+           GOV_WATERMARK / BMI270_FIFO_FRAME_ACC_GYR_SIZE, (unsigned long long)direct->period_us,
+           duration_s, (unsigned long long)(2 * direct->period_us));
+    printf("stages: attitude %u us/sample, sdlog %u us/sample + %u us erase every %u writes,\n"
+           "        metrics %u us/sample, telemetry %u us + %u us/sample\n\n",
+           GOV_ATTITUDE_US_PER_SAMPLE, GOV_SDLOG_US_PER_SAMPLE, GOV_SDLOG_ERASE_US, GOV_SDLOG_ERASE_EVERY,
+           GOV_METRICS_US_PER_SAMPLE, GOV_TELEMETRY_US, GOV_TELEMETRY_US_PER_SAMPLE);
+
+    printf("%-34s %10s %10s\n", "", "direct", "governor");
+    print_row("batches", direct->critical_batches, governed->critical_batches);
+    print_row("critical deadline misses", direct->critical_misses, governed->critical_misses);
+    print_row("critical max sample age [us]", direct->critical_max_age_us, governed->critical_max_age_us);
+    print_row("FIFO overflows", direct->fifo.overflow_events, governed->fifo.overflow_events);
+    print_row("lost frames", direct->fifo.lost_frames, governed->fifo.lost_frames);
+    print_row("sdlog writes", direct->sdlog_writes, governed->sdlog_writes);
+    print_row("telemetry batches sent", direct->telemetry_sent, governed->telemetry_sent);
+
+    bmi270_governor_stats_t stats;
+    bmi270_governor_get_stats(&governed->gov, &stats);
+    printf("\ngovernor: budget %u us, %u late batches, %u shed batches, %u overruns, max callback %u us\n",
+           stats.budget_us, stats.late_batches, stats.shed_batches, stats.overruns, stats.max_callback_us);
+    printf("%-10s %-9s %6s %6s %8s %8s %7s %8s %8s\n", "stage", "class", "runs", "shed", "deferred",
+           "replayed", "dropped", "max_us", "estimate");
+    for (uint8_t i = 0; i < stats.stage_count; i++) {
+        const bmi270_governor_stage_stats_t *stage = &stats.stages[i];
+        const bmi270_governor_stage_config_t *config = &governed->gov.stages[i].config;
+        printf("%-10s %-9s %6u %6u %8u %8u %7u %8u %8u\n", config->name, s_class_names[config->cls],
+               stage->runs, stage->shed, stage->deferred, stage->replayed, stage->deferred_dropped,
+               stage->max_us, stage->estimate_us);
+    }
+
+    bmi270_batch_pool_stats_t pool;
+    bmi270_batch_pool_get_stats((bmi270_batch_pool_t *)&governed->pool, &pool);
+    printf("pool: %u buffers (retain limit %u), %u lent, %u exhausted, peak %u in use, %u in use after flush\n",
+           governed->pool.count, governed->gov.retained_limit, pool.lent, pool.exhausted, pool.peak_in_use,
+           pool.in_use);
+    if (pool.in_use != 0) {
+        fprintf(stderr, "pool: buffers still referenced after flush\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* ====== Main ====== */
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [--duration-s S] [--pool N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = GOV_DEFAULT_DURATION_S;
+    uint32_t pool_buffers = GOV_DEFAULT_POOL_BUFFERS;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--duration-s") == 0) {
+            duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--pool") == 0) {
+            pool_buffers = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (pool_buffers == 0 || pool_buffers > BMI270_BATCH_POOL_MAX_BUFFERS) {
+        fprintf(stderr, "--pool: 1 to %u buffers\n", BMI270_BATCH_POOL_MAX_BUFFERS);
+        return 2;
+    }
+
+    if (gov_run(&s_runs[0], false, duration_s, (uint8_t)pool_buffers) != ESP_OK ||
+        gov_run(&s_runs[1], true, duration_s, (uint8_t)pool_buffers) != ESP_OK) {
+        return 1;
+    }
+    return gov_report(duration_s);
+}
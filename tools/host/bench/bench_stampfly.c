@@ -0,0 +1,124 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bench_stampfly.c
+ * @brief Benchmark adapter for this driver
+ */
+
+#include <string.h>
+#include "bench_driver.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_fifo_stream.h"
+
+static bmi270_dev_t s_dev;
+static bmi270_fifo_stream_t s_stream;
+static uint32_t s_batch_samples;
+
+static void stampfly_batch_cb(const bmi270_fifo_batch_t *batch, void *user_ctx) {
+    (void)user_ctx;
+    s_batch_samples += batch->sample_count;
+}
+
+static esp_err_t stampfly_init(void) {
+    bmi270_config_t config = {
+        .gpio_mosi = 14,
+        .gpio_miso = 43,
+        .gpio_sclk = 44,
+        .gpio_cs = 46,
+        .spi_clock_hz = BENCH_SPI_CLOCK_HZ,
+        .spi_host = SPI2_HOST,
+        .gpio_other_cs = 12,
+    };
+    esp_err_t ret;
+
+    memset(&s_dev, 0, sizeof(s_dev));
+    ret = bmi270_spi_init(&s_dev, &config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = bmi270_init(&s_dev);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = bmi270_set_accel_range(&s_dev, BMI270_ACC_RANGE_4G);
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_range(&s_dev, BMI270_GYR_RANGE_2000DPS);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_config(&s_dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_config(&s_dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    return ret;
+}
+
+static esp_err_t stampfly_read_sample(bench_sample_t *sample) {
+    bmi270_gyro_t gyr;
+    bmi270_accel_t acc;
+
+    esp_err_t ret = bmi270_read_gyro_accel_dps(&s_dev, &gyr, &acc);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    sample->acc_g[0] = acc.x;
+    sample->acc_g[1] = acc.y;
+    sample->acc_g[2] = acc.z;
+    sample->gyr_dps[0] = gyr.x;
+    sample->gyr_dps[1] = gyr.y;
+    sample->gyr_dps[2] = gyr.z;
+    return ESP_OK;
+}
+
+static esp_err_t stampfly_fifo_setup(uint16_t watermark) {
+    bmi270_fifo_stream_config_t config = {
+        .watermark = watermark,
+        .int_pin = BMI270_INT_PIN_1,
+        .aux_enable = false,
+        .callback = stampfly_batch_cb,
+        .user_ctx = NULL,
+    };
+    return bmi270_fifo_stream_init(&s_stream, &s_dev, &config);
+}
+
+static esp_err_t stampfly_fifo_drain(uint32_t *samples) {
+    s_batch_samples = 0;
+    esp_err_t ret = bmi270_fifo_stream_drain(&s_stream);
+    *samples = s_batch_samples;
+    return ret;
+}
+
+const bench_driver_t bench_driver_stampfly = {
+    .name = "stampfly",
+    .init = stampfly_init,
+    .read_sample = stampfly_read_sample,
+    .fifo_setup = stampfly_fifo_setup,
+    .fifo_drain = stampfly_fifo_drain,
+    .device_ram = sizeof(bmi270_dev_t),
+    .fifo_ram = sizeof(bmi270_fifo_stream_t),
+};
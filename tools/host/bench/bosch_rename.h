@@ -0,0 +1,52 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bosch_rename.h
+ * @brief Symbol renames for linking the Bosch SensorAPI next to this driver
+ *
+ * Both libraries export bmi270_init() and bmi270_config_file. This header
+ * is force-included (-include) into the Bosch sources and bench_bosch.c
+ * only, so that the Bosch public bmi270_* API is built as bosch_bmi270_*.
+ * It must never reach bench_stampfly.c: the build checks that object for a
+ * plain bmi270_init reference and no bosch_* references.
+ */
+
+#ifndef BOSCH_RENAME_H
+#define BOSCH_RENAME_H
+
+#define bmi270_init                     bosch_bmi270_init
+#define bmi270_config_file              bosch_bmi270_config_file
+#define bmi270_sensor_enable            bosch_bmi270_sensor_enable
+#define bmi270_sensor_disable           bosch_bmi270_sensor_disable
+#define bmi270_set_sensor_config        bosch_bmi270_set_sensor_config
+#define bmi270_get_sensor_config        bosch_bmi270_get_sensor_config
+#define bmi270_get_feature_data         bosch_bmi270_get_feature_data
+#define bmi270_get_sensor_data          bosch_bmi270_get_sensor_data
+#define bmi270_update_gyro_user_gain    bosch_bmi270_update_gyro_user_gain
+#define bmi270_read_gyro_user_gain      bosch_bmi270_read_gyro_user_gain
+#define bmi270_map_feat_int             bosch_bmi270_map_feat_int
+
+#endif // BOSCH_RENAME_H
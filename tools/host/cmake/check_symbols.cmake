@@ -0,0 +1,41 @@
+# BMI270 Driver - Host Tools: object symbol check
+#
+#   cmake -DNM=<nm> -DOBJECTS=<obj;...> -DREQUIRE=<sym;...> -DFORBID=<prefix;...>
+#         -P check_symbols.cmake
+#
+# Fails unless every REQUIRE symbol is referenced by OBJECTS as an undefined
+# symbol and no undefined symbol starts with a FORBID prefix. Used to keep the
+# bench_compare adapters bound to the driver they claim to measure.
+
+if(NOT NM OR NOT OBJECTS)
+    message(FATAL_ERROR "check_symbols: NM and OBJECTS are required")
+endif()
+
+execute_process(
+    COMMAND ${NM} -u ${OBJECTS}
+    OUTPUT_VARIABLE nm_out
+    RESULT_VARIABLE nm_result
+)
+if(NOT nm_result EQUAL 0)
+    message(FATAL_ERROR "check_symbols: ${NM} failed (${nm_result})")
+endif()
+
+# "                 U bmi270_init" -> "bmi270_init"
+string(REGEX MATCHALL "U [A-Za-z_][A-Za-z0-9_]*" refs "${nm_out}")
+list(TRANSFORM refs REPLACE "^U " "")
+
+foreach(sym IN LISTS REQUIRE)
+    list(FIND refs ${sym} idx)
+    if(idx EQUAL -1)
+        message(FATAL_ERROR "check_symbols: ${sym} is not referenced by ${OBJECTS}")
+    endif()
+endforeach()
+
+foreach(prefix IN LISTS FORBID)
+    foreach(sym IN LISTS refs)
+        string(FIND "${sym}" "${prefix}" pos)
+        if(pos EQUAL 0)
+            message(FATAL_ERROR "check_symbols: ${OBJECTS} references ${sym}")
+        endif()
+    endforeach()
+endforeach()
@@ -0,0 +1,260 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bus_fault.c
+ * @brief Fault-injecting bus backend for the host port
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bus_fault.h"
+#include "esp_rom_sys.h"
+
+#define BUS_FAULT_NONE          SIZE_MAX
+#define BUS_FAULT_READ_BIT      0x80
+#define BUS_FAULT_DATA_OFFSET   2           // Command echo + dummy byte precede read data
+#define BUS_FAULT_REG_CMD       0x7E
+#define BUS_FAULT_CMD_RESET     0xB6
+
+static const char *const s_type_names[BUS_FAULT_TYPE_COUNT] = {
+    [BUS_FAULT_BIT_ERROR] = "bit_error",
+    [BUS_FAULT_DROP]      = "drop",
+    [BUS_FAULT_STUCK]     = "stuck",
+    [BUS_FAULT_DELAY]     = "delay",
+    [BUS_FAULT_TIMEOUT]   = "timeout",
+    [BUS_FAULT_CHIP_ID]   = "chip_id",
+    [BUS_FAULT_REG_UPSET] = "reg_upset",
+    [BUS_FAULT_RESET]     = "reset",
+};
+
+const char *bus_fault_type_name(bus_fault_type_t type) {
+    return (type < BUS_FAULT_TYPE_COUNT) ? s_type_names[type] : "unknown";
+}
+
+uint64_t bus_fault_rand(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* ====== Schedule generation ====== */
+
+static double bus_fault_rand_exp(uint64_t *state, double mean) {
+    double u = (double)(bus_fault_rand(state) >> 11) * (1.0 / 9007199254740992.0);
+    return -mean * log(1.0 - u);
+}
+
+static int bus_fault_event_cmp(const void *a, const void *b) {
+    const bus_fault_event_t *ea = a;
+    const bus_fault_event_t *eb = b;
+    if (ea->time_us != eb->time_us) {
+        return (ea->time_us < eb->time_us) ? -1 : 1;
+    }
+    return (int)ea->type - (int)eb->type;
+}
+
+size_t bus_fault_schedule_generate(const bus_fault_profile_t *profile, uint64_t seed,
+                                   bus_fault_event_t *events, size_t capacity) {
+    if (profile == NULL || events == NULL || capacity == 0) {
+        return 0;
+    }
+
+    uint64_t end_us = profile->start_us + profile->duration_us;
+    size_t count = 0;
+
+    for (int type = 0; type < BUS_FAULT_TYPE_COUNT; type++) {
+        const bus_fault_rate_t *rate = &profile->rate[type];
+        if (rate->mean_interval_ms == 0) {
+            continue;
+        }
+        // Independent stream per type so enabling one type does not move the others
+        uint64_t state = seed ^ ((uint64_t)(type + 1) * 0xD1B54A32D192ED03ULL);
+        double time_us = (double)profile->start_us;
+        while (count < capacity) {
+            time_us += bus_fault_rand_exp(&state, rate->mean_interval_ms * 1000.0);
+            if (time_us >= (double)end_us) {
+                break;
+            }
+            events[count++] = (bus_fault_event_t){
+                .time_us = (uint64_t)time_us,
+                .type = (bus_fault_type_t)type,
+                .count = rate->count ? rate->count : 1,
+                .param = rate->param,
+            };
+        }
+    }
+
+    qsort(events, count, sizeof(events[0]), bus_fault_event_cmp);
+
+    // Enforce spacing so that each recovery is observed in isolation
+    uint64_t spacing_us = (uint64_t)profile->min_spacing_ms * 1000ULL;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        bus_fault_event_t event = events[i];
+        if (kept > 0 && event.time_us < events[kept - 1].time_us + spacing_us) {
+            event.time_us = events[kept - 1].time_us + spacing_us;
+        }
+        if (event.time_us >= end_us) {
+            break;
+        }
+        events[kept++] = event;
+    }
+    return kept;
+}
+
+/* ====== Injector ====== */
+
+void bus_fault_init(bus_fault_t *fault, bus_fault_event_t *events, size_t event_count, uint64_t seed) {
+    memset(fault, 0, sizeof(*fault));
+    host_bus_get_backend(&fault->inner, &fault->inner_ctx);
+    fault->events = events;
+    fault->event_count = event_count;
+    fault->rng = seed;
+    for (int type = 0; type < BUS_FAULT_TYPE_COUNT; type++) {
+        fault->active[type] = BUS_FAULT_NONE;
+    }
+    for (size_t i = 0; i < event_count; i++) {
+        events[i].applied_us = 0;
+        events[i].applied = 0;
+        events[i].skipped = false;
+    }
+}
+
+void bus_fault_attach(bus_fault_t *fault) {
+    host_bus_attach(bus_fault_transfer, fault);
+}
+
+static bool bus_fault_eligible(bus_fault_type_t type, const uint8_t *tx, size_t len) {
+    bool read_data = (tx[0] & BUS_FAULT_READ_BIT) && len > BUS_FAULT_DATA_OFFSET;
+
+    switch (type) {
+    case BUS_FAULT_BIT_ERROR:
+    case BUS_FAULT_STUCK:
+        return read_data;
+    case BUS_FAULT_CHIP_ID:
+        return read_data && (tx[0] & ~BUS_FAULT_READ_BIT) == 0x00;
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Claim the active event of a type for this frame
+ *
+ * @return Event, or NULL if no event of this type applies
+ */
+static bus_fault_event_t *bus_fault_claim(bus_fault_t *fault, bus_fault_type_t type,
+                                          const uint8_t *tx, size_t len, uint64_t now_us) {
+    size_t index = fault->active[type];
+    if (index == BUS_FAULT_NONE || !bus_fault_eligible(type, tx, len)) {
+        return NULL;
+    }
+    // MISO faults skip eligible frames at random, so that both short
+    // register reads and long FIFO bursts get hit
+    if ((type == BUS_FAULT_BIT_ERROR || type == BUS_FAULT_STUCK) &&
+        (bus_fault_rand(&fault->rng) & 1) != 0) {
+        return NULL;
+    }
+    bus_fault_event_t *event = &fault->events[index];
+    if (event->applied == 0) {
+        event->applied_us = now_us;
+    }
+    if (++event->applied >= event->count) {
+        fault->active[type] = BUS_FAULT_NONE;
+    }
+    fault->stats.corrupted[type]++;
+    return event;
+}
+
+esp_err_t bus_fault_transfer(void *ctx, const uint8_t *tx, uint8_t *rx, size_t len) {
+    bus_fault_t *fault = (bus_fault_t *)ctx;
+    if (fault == NULL || fault->inner == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint64_t now_us = host_clock_now_ns() / 1000ULL;
+    fault->stats.frames++;
+
+    while (fault->next_event < fault->event_count &&
+           fault->events[fault->next_event].time_us <= now_us) {
+        size_t *active = &fault->active[fault->events[fault->next_event].type];
+        // An event that never found an eligible frame will never be applied
+        if (*active != BUS_FAULT_NONE && fault->events[*active].applied == 0) {
+            fault->events[*active].skipped = true;
+        }
+        *active = fault->next_event;
+        fault->next_event++;
+    }
+
+    bus_fault_event_t *event;
+
+    // Faults inside the sensor, delivered as a write the driver never issued
+    if ((event = bus_fault_claim(fault, BUS_FAULT_REG_UPSET, tx, len, now_us)) != NULL) {
+        uint8_t write[2] = { (uint8_t)((event->param >> 8) & 0x7F), (uint8_t)(event->param & 0xFF) };
+        fault->inner(fault->inner_ctx, write, NULL, sizeof(write));
+    }
+    if (bus_fault_claim(fault, BUS_FAULT_RESET, tx, len, now_us) != NULL) {
+        uint8_t write[2] = { BUS_FAULT_REG_CMD, BUS_FAULT_CMD_RESET };
+        fault->inner(fault->inner_ctx, write, NULL, sizeof(write));
+    }
+
+    // Faults that keep the frame from reaching the sensor
+    if ((event = bus_fault_claim(fault, BUS_FAULT_TIMEOUT, tx, len, now_us)) != NULL) {
+        esp_rom_delay_us(event->param);
+        return ESP_ERR_TIMEOUT;
+    }
+    if (bus_fault_claim(fault, BUS_FAULT_DROP, tx, len, now_us) != NULL) {
+        if (rx != NULL) {
+            memset(rx, 0xFF, len);
+        }
+        return ESP_OK;
+    }
+
+    if ((event = bus_fault_claim(fault, BUS_FAULT_DELAY, tx, len, now_us)) != NULL) {
+        esp_rom_delay_us(event->param);
+    }
+
+    esp_err_t ret = fault->inner(fault->inner_ctx, tx, rx, len);
+    if (ret != ESP_OK || rx == NULL) {
+        return ret;
+    }
+
+    // Faults on the MISO line
+    if ((event = bus_fault_claim(fault, BUS_FAULT_STUCK, tx, len, now_us)) != NULL) {
+        memset(&rx[BUS_FAULT_DATA_OFFSET], (int)(event->param & 0xFF), len - BUS_FAULT_DATA_OFFSET);
+    }
+    if (bus_fault_claim(fault, BUS_FAULT_BIT_ERROR, tx, len, now_us) != NULL) {
+        uint64_t r = bus_fault_rand(&fault->rng);
+        size_t byte = BUS_FAULT_DATA_OFFSET + (size_t)(r % (len - BUS_FAULT_DATA_OFFSET));
+        rx[byte] ^= (uint8_t)(1U << ((r >> 32) & 7));
+    }
+    if ((event = bus_fault_claim(fault, BUS_FAULT_CHIP_ID, tx, len, now_us)) != NULL) {
+        rx[BUS_FAULT_DATA_OFFSET] = (uint8_t)(event->param & 0xFF);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,187 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bus_fault.h
+ * @brief Fault-injecting bus backend for the host port
+ *
+ * Wraps another bus backend (normally the BMI270 simulator) and corrupts
+ * SPI frames according to a seeded schedule, to rehearse the incidents
+ * seen in flight on the shared StampFly SPI bus:
+ * - Bit errors: single MISO bit flips in received data
+ * - Dropped transactions: CS glitch, the sensor never sees the frame and
+ *   MISO floats high (reads return 0xFF)
+ * - Stuck-at bytes: MISO held at a constant level for whole frames
+ * - Delayed completion: bus held by another device (e.g. PMW3901)
+ * - Timeouts: the SPI driver gives up (ESP_ERR_TIMEOUT) after the delay
+ * - Spurious CHIP_ID mismatch: register 0x00 reads back a wrong value
+ * - Register upsets: a configuration register silently falls back (ESD)
+ * - Sensor resets: the sensor restarts from reset values (brown-out)
+ *
+ * The last two happen inside the sensor, not on the bus: they are
+ * delivered to the wrapped backend as an extra write ahead of the frame
+ * that claims them, and the driver's own frame passes unchanged.
+ *
+ * A schedule is a sorted list of events on the virtual clock. An event
+ * becomes active at its time and affects the next 'count' eligible
+ * frames (bit errors and stuck-at bytes hit each eligible frame with
+ * probability 1/2). An event replaced by the next one of its type before
+ * it found an eligible frame is marked skipped. Schedules generated from the same seed and profile are
+ * identical, and the host port is deterministic, so every run with the
+ * same seed reproduces the same faults at the same points.
+ */
+
+#ifndef BUS_FAULT_H
+#define BUS_FAULT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "host_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fault types
+ */
+typedef enum {
+    BUS_FAULT_BIT_ERROR = 0,    ///< Flip one bit of a received data byte (param: unused)
+    BUS_FAULT_DROP,             ///< Frame not delivered; reads return 0xFF
+    BUS_FAULT_STUCK,            ///< Received data stuck at param (0x00 or 0xFF)
+    BUS_FAULT_DELAY,            ///< Completion delayed by param µs
+    BUS_FAULT_TIMEOUT,          ///< Frame not delivered; ESP_ERR_TIMEOUT after param µs
+    BUS_FAULT_CHIP_ID,          ///< CHIP_ID reads return param instead of the sensor value
+    BUS_FAULT_REG_UPSET,        ///< Register (param >> 8) set to (param & 0xFF) inside the sensor
+    BUS_FAULT_RESET,            ///< Sensor soft reset (param: unused)
+    BUS_FAULT_TYPE_COUNT,
+} bus_fault_type_t;
+
+/**
+ * @brief One scheduled fault
+ */
+typedef struct {
+    uint64_t time_us;           ///< Activation time on the virtual clock [µs]
+    bus_fault_type_t type;      ///< Fault type
+    uint16_t count;             ///< Eligible frames affected
+    uint32_t param;             ///< Type specific parameter (see bus_fault_type_t)
+    uint64_t applied_us;        ///< Time the first frame was corrupted (0 = not yet)
+    uint16_t applied;           ///< Frames corrupted so far
+    bool skipped;               ///< Superseded by the next event of its type before hitting a frame
+} bus_fault_event_t;
+
+/**
+ * @brief Per-type generation parameters
+ */
+typedef struct {
+    uint32_t mean_interval_ms;  ///< Mean time between events (0 = disabled)
+    uint16_t count;             ///< Frames affected per event
+    uint32_t param;             ///< Parameter copied into each event
+} bus_fault_rate_t;
+
+/**
+ * @brief Schedule generation profile
+ */
+typedef struct {
+    bus_fault_rate_t rate[BUS_FAULT_TYPE_COUNT];
+    uint32_t min_spacing_ms;    ///< Minimum gap between any two events (isolates recoveries)
+    uint64_t start_us;          ///< No events before this time (e.g. after bring-up)
+    uint64_t duration_us;       ///< Schedule length
+} bus_fault_profile_t;
+
+/**
+ * @brief Injection counters
+ */
+typedef struct {
+    uint64_t frames;                                ///< Frames seen
+    uint64_t corrupted[BUS_FAULT_TYPE_COUNT];       ///< Frames corrupted per type
+} bus_fault_stats_t;
+
+/**
+ * @brief Injector state
+ */
+typedef struct {
+    host_bus_transfer_fn_t inner;   ///< Wrapped backend
+    void *inner_ctx;
+    bus_fault_event_t *events;      ///< Schedule (sorted by time_us)
+    size_t event_count;
+    size_t next_event;              ///< First event not yet activated
+    size_t active[BUS_FAULT_TYPE_COUNT];    ///< Active event index per type (SIZE_MAX = none)
+    uint64_t rng;                   ///< Bit position generator state
+    bus_fault_stats_t stats;
+} bus_fault_t;
+
+/**
+ * @brief Deterministic PRNG step (splitmix64)
+ */
+uint64_t bus_fault_rand(uint64_t *state);
+
+/**
+ * @brief Generate a reproducible schedule
+ *
+ * Event times are exponentially distributed per type and merged in time
+ * order; events closer than min_spacing_ms to the previous one are
+ * pushed back.
+ *
+ * @param profile Generation profile
+ * @param seed PRNG seed
+ * @param events Output array
+ * @param capacity Capacity of events
+ * @return Number of events written
+ */
+size_t bus_fault_schedule_generate(const bus_fault_profile_t *profile, uint64_t seed,
+                                   bus_fault_event_t *events, size_t capacity);
+
+/**
+ * @brief Initialize the injector around the currently attached backend
+ *
+ * @param fault Injector state
+ * @param events Schedule (sorted, owned by the caller; applied fields are updated)
+ * @param event_count Number of events
+ * @param seed Seed for bit positions
+ */
+void bus_fault_init(bus_fault_t *fault, bus_fault_event_t *events, size_t event_count, uint64_t seed);
+
+/**
+ * @brief Attach the injector as the bus backend of the calling thread
+ */
+void bus_fault_attach(bus_fault_t *fault);
+
+/**
+ * @brief Bus backend entry point (host_bus_transfer_fn_t)
+ */
+esp_err_t bus_fault_transfer(void *ctx, const uint8_t *tx, uint8_t *rx, size_t len);
+
+/**
+ * @brief Human readable fault type name
+ */
+const char *bus_fault_type_name(bus_fault_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUS_FAULT_H
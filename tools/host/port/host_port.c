@@ -0,0 +1,183 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file host_port.c
+ * @brief Host port: virtual clock, FreeRTOS/ROM/timer shims, heap and log
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_port.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* ====== Virtual clock ====== */
+
+static __thread uint64_t s_clock_ns;
+
+uint64_t host_clock_now_ns(void) {
+    return s_clock_ns;
+}
+
+void host_clock_advance_ns(uint64_t ns) {
+    s_clock_ns += ns;
+}
+
+void host_clock_advance_us(uint64_t us) {
+    s_clock_ns += us * 1000ULL;
+}
+
+void host_clock_reset(void) {
+    s_clock_ns = 0;
+}
+
+int64_t esp_timer_get_time(void) {
+    return (int64_t)(s_clock_ns / 1000ULL);
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    host_clock_advance_us(us);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    host_clock_advance_us((uint64_t)ticks * portTICK_PERIOD_MS * 1000ULL);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(s_clock_ns / (portTICK_PERIOD_MS * 1000000ULL));
+}
+
+/* ====== GPIO ====== */
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    return (config != NULL) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    (void)gpio_num;
+    (void)level;
+    return ESP_OK;
+}
+
+/* ====== Heap accounting ====== */
+
+// Size header kept in front of each block so heap_caps_free() can account it
+typedef union {
+    size_t size;
+    max_align_t align;
+} heap_header_t;
+
+static __thread host_heap_stats_t s_heap;
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    heap_header_t *header = malloc(sizeof(heap_header_t) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+    s_heap.allocations++;
+    s_heap.current_bytes += size;
+    if (s_heap.current_bytes > s_heap.peak_bytes) {
+        s_heap.peak_bytes = s_heap.current_bytes;
+    }
+    return header + 1;
+}
+
+void heap_caps_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    heap_header_t *header = (heap_header_t *)ptr - 1;
+    s_heap.current_bytes -= header->size;
+    free(header);
+}
+
+void host_heap_get_stats(host_heap_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = s_heap;
+    }
+}
+
+void host_heap_reset_stats(void) {
+    s_heap.allocations = 0;
+    s_heap.peak_bytes = s_heap.current_bytes;
+}
+
+/* ====== Logging ====== */
+
+__thread esp_log_level_t host_log_level = ESP_LOG_WARN;
+
+void host_log_set_level(esp_log_level_t level) {
+    host_log_level = level;
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    (void)tag;
+    host_log_level = level;
+}
+
+void host_log(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = "NEWIDV";
+    va_list args;
+
+    fprintf(stderr, "%c (%llu) %s: ", letters[level],
+            (unsigned long long)(s_clock_ns / 1000000ULL), tag);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK:                    return "ESP_OK";
+    case ESP_FAIL:                  return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:            return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:       return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:     return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:      return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:         return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:     return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:           return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE:  return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:       return "ESP_ERR_INVALID_CRC";
+    default:                        return "UNKNOWN ERROR";
+    }
+}
+
+/* ====== Board ====== */
+
+void host_port_reset(void) {
+    host_clock_reset();
+    host_bus_reset();
+    host_heap_reset_stats();
+}
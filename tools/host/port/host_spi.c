@@ -0,0 +1,213 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file host_spi.c
+ * @brief Host port: SPI master shim and bus model
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_port.h"
+#include "driver/spi_master.h"
+
+#define HOST_SPI_HOST_COUNT     3
+
+struct spi_device_t {
+    spi_host_device_t host;
+    uint32_t clock_hz;
+};
+
+typedef struct {
+    host_bus_transfer_fn_t fn;
+    void *ctx;
+    host_bus_timing_t timing;
+    bool cpu_accounting;
+    host_bus_stats_t stats;
+    bool bus_initialized[HOST_SPI_HOST_COUNT];
+} host_bus_state_t;
+
+#define HOST_BUS_DEFAULT_TIMING {                   \
+        .overhead_ns = HOST_BUS_DEFAULT_OVERHEAD_NS,    \
+        .default_clock_hz = 10000000,                   \
+    }
+
+static __thread host_bus_state_t s_bus = {
+    .timing = HOST_BUS_DEFAULT_TIMING,
+};
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ====== Bus model ====== */
+
+void host_bus_attach(host_bus_transfer_fn_t fn, void *ctx) {
+    s_bus.fn = fn;
+    s_bus.ctx = ctx;
+}
+
+void host_bus_get_backend(host_bus_transfer_fn_t *fn, void **ctx) {
+    if (fn != NULL) {
+        *fn = s_bus.fn;
+    }
+    if (ctx != NULL) {
+        *ctx = s_bus.ctx;
+    }
+}
+
+void host_bus_set_timing(const host_bus_timing_t *timing) {
+    if (timing != NULL) {
+        s_bus.timing = *timing;
+    }
+}
+
+void host_bus_get_timing(host_bus_timing_t *timing) {
+    if (timing != NULL) {
+        *timing = s_bus.timing;
+    }
+}
+
+void host_bus_set_cpu_accounting(bool enable) {
+    s_bus.cpu_accounting = enable;
+}
+
+esp_err_t host_bus_transfer(uint32_t clock_hz, const uint8_t *tx, uint8_t *rx, size_t len) {
+    if (tx == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (clock_hz == 0) {
+        clock_hz = s_bus.timing.default_clock_hz;
+    }
+
+    // Wire time is charged before the backend runs so that the simulated
+    // sensor observes the time at which the frame completes
+    uint64_t wire_ns = ((uint64_t)len * 8ULL * 1000000000ULL + clock_hz - 1) / clock_hz;
+    uint64_t bus_ns = s_bus.timing.overhead_ns + wire_ns;
+    host_clock_advance_ns(bus_ns);
+
+    s_bus.stats.transactions++;
+    if (tx[0] & 0x80) {
+        s_bus.stats.read_transactions++;
+    }
+    s_bus.stats.bytes += len;
+    s_bus.stats.bus_time_ns += bus_ns;
+
+    if (s_bus.fn == NULL) {
+        s_bus.stats.errors++;
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret;
+    if (s_bus.cpu_accounting) {
+        uint64_t start = thread_cpu_ns();
+        ret = s_bus.fn(s_bus.ctx, tx, rx, len);
+        s_bus.stats.backend_cpu_ns += thread_cpu_ns() - start;
+    } else {
+        ret = s_bus.fn(s_bus.ctx, tx, rx, len);
+    }
+
+    if (ret != ESP_OK) {
+        s_bus.stats.errors++;
+    }
+    return ret;
+}
+
+void host_bus_get_stats(host_bus_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = s_bus.stats;
+    }
+}
+
+void host_bus_reset_stats(void) {
+    memset(&s_bus.stats, 0, sizeof(s_bus.stats));
+}
+
+void host_bus_reset(void) {
+    memset(&s_bus, 0, sizeof(s_bus));
+    s_bus.timing = (host_bus_timing_t)HOST_BUS_DEFAULT_TIMING;
+}
+
+/* ====== SPI master shim ====== */
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, int dma_chan) {
+    (void)dma_chan;
+    if (bus_config == NULL || host_id >= HOST_SPI_HOST_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_bus.bus_initialized[host_id]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_bus.bus_initialized[host_id] = true;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id) {
+    if (host_id >= HOST_SPI_HOST_COUNT || !s_bus.bus_initialized[host_id]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_bus.bus_initialized[host_id] = false;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config,
+                             spi_device_handle_t *handle) {
+    if (dev_config == NULL || handle == NULL || host_id >= HOST_SPI_HOST_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_bus.bus_initialized[host_id]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct spi_device_t *device = calloc(1, sizeof(*device));
+    if (device == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    device->host = host_id;
+    device->clock_hz = (uint32_t)dev_config->clock_speed_hz;
+    *handle = device;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle) {
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc) {
+    if (handle == NULL || trans_desc == NULL || trans_desc->tx_buffer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (trans_desc->length == 0 || (trans_desc->length % 8) != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return host_bus_transfer(handle->clock_hz, trans_desc->tx_buffer, trans_desc->rx_buffer,
+                             trans_desc->length / 8);
+}
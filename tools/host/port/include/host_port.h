@@ -0,0 +1,235 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file host_port.h
+ * @brief Host port of the BMI270 driver: virtual clock, bus model and accounting
+ *
+ * The host port lets the unmodified driver sources in src/ run on a Linux
+ * host. ESP-IDF services used by the driver are replaced as follows:
+ * - esp_timer_get_time(), esp_rom_delay_us(), vTaskDelay() and
+ *   xTaskGetTickCount() operate on a virtual clock. Delays advance the
+ *   clock instead of sleeping, so an init sequence that takes 300 ms on
+ *   the target completes instantly but still reports 300 ms.
+ * - spi_device_polling_transmit() is forwarded to host_bus_transfer(),
+ *   which counts the transaction, advances the virtual clock by the
+ *   modelled bus time and passes the frame to the attached backend.
+ * - heap_caps_malloc() is tracked so the heap footprint of a path can be
+ *   measured.
+ *
+ * All state is thread-local: every thread owns an independent simulated
+ * board (clock, bus, backend, counters).
+ */
+
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ====== Virtual clock ====== */
+
+/**
+ * @brief Current virtual time in nanoseconds
+ */
+uint64_t host_clock_now_ns(void);
+
+/**
+ * @brief Advance the virtual clock
+ *
+ * @param ns Nanoseconds to advance
+ */
+void host_clock_advance_ns(uint64_t ns);
+
+/**
+ * @brief Advance the virtual clock (microseconds)
+ */
+void host_clock_advance_us(uint64_t us);
+
+/**
+ * @brief Reset the virtual clock to zero
+ */
+void host_clock_reset(void);
+
+/* ====== Bus model ====== */
+
+/**
+ * @brief Bus backend transfer function
+ *
+ * Called for every full-duplex SPI frame. The first byte of tx is the
+ * command (bit7 = read). rx may be NULL for write-only frames.
+ *
+ * @param ctx User context passed to host_bus_attach()
+ * @param tx Transmitted bytes (length len)
+ * @param rx Received bytes (length len, may be NULL)
+ * @param len Frame length in bytes
+ * @return ESP_OK, or an error code that is returned to the driver
+ */
+typedef esp_err_t (*host_bus_transfer_fn_t)(void *ctx, const uint8_t *tx, uint8_t *rx, size_t len);
+
+/**
+ * @brief Bus timing model
+ *
+ * Modelled time of one transaction = overhead_ns + bits / clock_hz.
+ * overhead_ns covers driver setup, CS assertion and DMA start that the
+ * target pays for every spi_device_polling_transmit() call.
+ */
+typedef struct {
+    uint32_t overhead_ns;               ///< Fixed cost per transaction [ns]
+    uint32_t default_clock_hz;          ///< Clock used when the caller passes 0
+} host_bus_timing_t;
+
+/**
+ * @brief Bus accounting counters
+ */
+typedef struct {
+    uint64_t transactions;              ///< Completed transfers
+    uint64_t read_transactions;         ///< Transfers with bit7 set in the command byte
+    uint64_t bytes;                     ///< Bytes on the wire (including command/dummy)
+    uint64_t bus_time_ns;               ///< Modelled bus time
+    uint64_t backend_cpu_ns;            ///< Host CPU time spent inside the backend
+    uint64_t errors;                    ///< Transfers that returned an error
+} host_bus_stats_t;
+
+/**
+ * @brief Default per-transaction overhead [ns]
+ *
+ * Approximate cost of spi_device_polling_transmit() on ESP32-S3 at
+ * 240 MHz, excluding the clocked bits.
+ */
+#define HOST_BUS_DEFAULT_OVERHEAD_NS    8000U
+
+/**
+ * @brief Attach a bus backend
+ *
+ * @param fn Transfer function (NULL detaches; transfers then fail)
+ * @param ctx User context passed to fn
+ */
+void host_bus_attach(host_bus_transfer_fn_t fn, void *ctx);
+
+/**
+ * @brief Get the attached backend
+ */
+void host_bus_get_backend(host_bus_transfer_fn_t *fn, void **ctx);
+
+/**
+ * @brief Set the bus timing model
+ */
+void host_bus_set_timing(const host_bus_timing_t *timing);
+
+/**
+ * @brief Get the bus timing model
+ */
+void host_bus_get_timing(host_bus_timing_t *timing);
+
+/**
+ * @brief Measure host CPU time spent inside the backend
+ *
+ * When enabled, backend_cpu_ns is accumulated so that benchmarks can
+ * subtract the simulator cost from driver CPU time. Disabled by default
+ * because it adds two clock reads per transaction.
+ */
+void host_bus_set_cpu_accounting(bool enable);
+
+/**
+ * @brief Execute one SPI frame
+ *
+ * Used by the spi_master shim and by alternative drivers under
+ * comparison, so that every driver is charged by the same model.
+ *
+ * @param clock_hz SPI clock (0 = default_clock_hz)
+ * @param tx Transmit buffer
+ * @param rx Receive buffer (may be NULL)
+ * @param len Frame length in bytes
+ * @return esp_err_t Backend result
+ */
+esp_err_t host_bus_transfer(uint32_t clock_hz, const uint8_t *tx, uint8_t *rx, size_t len);
+
+/**
+ * @brief Get bus counters
+ */
+void host_bus_get_stats(host_bus_stats_t *stats);
+
+/**
+ * @brief Reset bus counters
+ */
+void host_bus_reset_stats(void);
+
+/**
+ * @brief Return the bus to its power-on state
+ *
+ * Detaches the backend, frees all SPI hosts so that the driver can call
+ * spi_bus_initialize() again, restores the default timing and clears the
+ * counters.
+ */
+void host_bus_reset(void);
+
+/* ====== Heap accounting ====== */
+
+/**
+ * @brief heap_caps_malloc() accounting
+ */
+typedef struct {
+    uint64_t allocations;               ///< heap_caps_malloc() calls
+    size_t current_bytes;               ///< Currently allocated
+    size_t peak_bytes;                  ///< Peak since last reset
+} host_heap_stats_t;
+
+/**
+ * @brief Get heap counters
+ */
+void host_heap_get_stats(host_heap_stats_t *stats);
+
+/**
+ * @brief Reset allocation count and peak (current is kept)
+ */
+void host_heap_reset_stats(void);
+
+/* ====== Logging ====== */
+
+/**
+ * @brief Set the log level for the calling thread (default ESP_LOG_WARN)
+ */
+void host_log_set_level(esp_log_level_t level);
+
+/* ====== Board ====== */
+
+/**
+ * @brief Reset clock, counters and backend of the calling thread
+ */
+void host_port_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_PORT_H
@@ -0,0 +1,547 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_sim.c
+ * @brief Register-level BMI270 simulator for the host port
+ */
+
+#include <math.h>
+#include <string.h>
+#include "bmi270_sim.h"
+#include "bmi270_defs.h"
+#include "host_port.h"
+
+#define SIM_DEFAULT_INIT_LATENCY_US     20000U
+#define SIM_SENSORTIME_MASK             0xFFFFFFU
+#define SIM_CATCHUP_MAX_SAMPLES         1024U
+#define SIM_STATUS_CMD_RDY              (1 << 4)
+#define SIM_STATUS_DRDY_GYR             (1 << 6)
+#define SIM_STATUS_DRDY_ACC             (1 << 7)
+#define SIM_PWR_CONF_ADV_POWER_SAVE     (1 << 0)
+#define SIM_FIFO_TIME_EN                (1 << 1)
+
+/* ====== Helpers ====== */
+
+static void sim_apply_reset_values(bmi270_sim_t *sim) {
+    memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[BMI270_REG_CHIP_ID] = BMI270_CHIP_ID;
+    sim->regs[BMI270_REG_STATUS] = SIM_STATUS_CMD_RDY;
+    sim->regs[BMI270_REG_ACC_CONF] = 0xA8;
+    sim->regs[BMI270_REG_ACC_RANGE] = 0x02;
+    sim->regs[BMI270_REG_GYR_CONF] = 0xA9;
+    sim->regs[BMI270_REG_AUX_CONF] = 0x46;
+    sim->regs[BMI270_REG_FIFO_DOWNS] = 0x88;
+    sim->regs[BMI270_REG_FIFO_WTM_1] = 0x02;
+    sim->regs[BMI270_REG_FIFO_CONFIG_0] = SIM_FIFO_TIME_EN;
+    sim->regs[BMI270_REG_FIFO_CONFIG_1] = BMI270_FIFO_HEADER_EN;
+    sim->regs[BMI270_REG_AUX_DEV_ID] = 0x20;
+    sim->regs[BMI270_REG_AUX_IF_CONF] = 0x83;
+    sim->regs[BMI270_REG_PWR_CONF] = 0x03;
+
+    memset(sim->config_written, 0, sizeof(sim->config_written));
+    memset(sim->features, 0, sizeof(sim->features));
+    sim->config_written_count = 0;
+    sim->init_ptr = 0;
+    sim->fifo_length = 0;
+    sim->fifo_frame_size = 0;
+    sim->fifo_skipped = 0;
+    sim->spi_active = false;
+    sim->init_pending = false;
+    sim->running = false;
+    sim->stats.config_bytes = 0;
+}
+
+static void sim_default_source(void *ctx, uint64_t sample_index, int16_t acc[3], int16_t gyr[3]) {
+    (void)ctx;
+    // Slow coning motion with 1 g on Z (±4 g range) and a small
+    // deterministic dither so consecutive samples are never identical
+    double phase = (double)sample_index * (2.0 * M_PI / 400.0);
+    int16_t dither = (int16_t)((sample_index * 2654435761ULL >> 28) & 0x7) - 4;
+
+    acc[0] = (int16_t)(600.0 * sin(phase)) + dither;
+    acc[1] = (int16_t)(600.0 * cos(phase)) - dither;
+    acc[2] = (int16_t)8192 + dither;
+    gyr[0] = (int16_t)(300.0 * cos(phase)) + dither;
+    gyr[1] = (int16_t)(-300.0 * sin(phase)) - dither;
+    gyr[2] = (int16_t)(50.0 * sin(0.5 * phase)) + dither;
+}
+
+static uint64_t sim_odr_period_ns(uint8_t conf) {
+    uint8_t odr = conf & 0x0F;
+    if (odr == 0) {
+        odr = 1;
+    }
+    // ODR code 0x08 = 100 Hz; every step doubles the rate
+    return 2560000000ULL >> odr;
+}
+
+static bool sim_acc_on(const bmi270_sim_t *sim) {
+    return (sim->regs[BMI270_REG_PWR_CTRL] & BMI270_PWR_CTRL_ACC_EN) != 0;
+}
+
+static bool sim_gyr_on(const bmi270_sim_t *sim) {
+    return (sim->regs[BMI270_REG_PWR_CTRL] & BMI270_PWR_CTRL_GYR_EN) != 0;
+}
+
+static uint32_t sim_sensortime(void) {
+    // 39.0625 µs per LSB
+    return (uint32_t)((host_clock_now_ns() * 2ULL / 78125ULL) & SIM_SENSORTIME_MASK);
+}
+
+static uint16_t sim_watermark(const bmi270_sim_t *sim) {
+    return (uint16_t)(sim->regs[BMI270_REG_FIFO_WTM_0] |
+                      ((sim->regs[BMI270_REG_FIFO_WTM_1] & BMI270_FIFO_WTM_MSB_MASK) << 8));
+}
+
+static bool sim_header_mode(const bmi270_sim_t *sim) {
+    return (sim->regs[BMI270_REG_FIFO_CONFIG_1] & BMI270_FIFO_HEADER_EN) != 0;
+}
+
+static uint16_t sim_regular_frame_size(uint8_t header) {
+    uint16_t size = 1;
+    if (header & BMI270_FIFO_HEAD_AUX_BIT) {
+        size += BMI270_FIFO_AUX_PAYLOAD;
+    }
+    if (header & BMI270_FIFO_HEAD_GYR_BIT) {
+        size += 6;
+    }
+    if (header & BMI270_FIFO_HEAD_ACC_BIT) {
+        size += 6;
+    }
+    return size;
+}
+
+static uint16_t sim_fifo_frame_size_at(const bmi270_sim_t *sim, uint16_t offset) {
+    if (sim_header_mode(sim)) {
+        return sim_regular_frame_size(sim->fifo[offset]);
+    }
+    return sim->fifo_frame_size;
+}
+
+/**
+ * @brief Bytes of whole frames within the first 'read' bytes
+ *
+ * A frame that was only partially read stays in the FIFO and is returned
+ * again in full by the next read, as on the sensor.
+ */
+static uint16_t sim_fifo_complete_bytes(const bmi270_sim_t *sim, uint16_t read) {
+    if (read >= sim->fifo_length) {
+        return sim->fifo_length;
+    }
+    uint16_t offset = 0;
+    while (offset < read) {
+        uint16_t size = sim_fifo_frame_size_at(sim, offset);
+        if (size == 0 || offset + size > read) {
+            break;
+        }
+        offset += size;
+    }
+    return offset;
+}
+
+static void sim_fifo_drop_front(bmi270_sim_t *sim) {
+    uint16_t size = sim_fifo_frame_size_at(sim, 0);
+    if (size == 0 || size > sim->fifo_length) {
+        size = sim->fifo_length;
+    }
+    memmove(sim->fifo, &sim->fifo[size], sim->fifo_length - size);
+    sim->fifo_length -= size;
+}
+
+/* ====== Sample generation ====== */
+
+static void sim_fifo_push(bmi270_sim_t *sim, const int16_t acc[3], const int16_t gyr[3]) {
+    uint8_t config_1 = sim->regs[BMI270_REG_FIFO_CONFIG_1];
+    bool fifo_acc = (config_1 & BMI270_FIFO_ACC_EN) && sim_acc_on(sim);
+    bool fifo_gyr = (config_1 & BMI270_FIFO_GYR_EN) && sim_gyr_on(sim);
+    bool fifo_aux = (config_1 & BMI270_FIFO_AUX_EN) != 0;
+
+    if (!fifo_acc && !fifo_gyr && !fifo_aux) {
+        return;
+    }
+
+    uint8_t frame[BMI270_FIFO_FRAME_ACC_GYR_AUX_SIZE];
+    uint16_t size = 0;
+
+    if (sim_header_mode(sim)) {
+        frame[size++] = BMI270_FIFO_HEAD_MODE_REGULAR |
+                        (fifo_aux ? BMI270_FIFO_HEAD_AUX_BIT : 0) |
+                        (fifo_gyr ? BMI270_FIFO_HEAD_GYR_BIT : 0) |
+                        (fifo_acc ? BMI270_FIFO_HEAD_ACC_BIT : 0);
+    }
+    if (fifo_aux) {
+        memcpy(&frame[size], &sim->regs[BMI270_REG_AUX_DATA_0], BMI270_FIFO_AUX_PAYLOAD);
+        size += BMI270_FIFO_AUX_PAYLOAD;
+    }
+    if (fifo_gyr) {
+        for (int i = 0; i < 3; i++) {
+            frame[size++] = (uint8_t)(gyr[i] & 0xFF);
+            frame[size++] = (uint8_t)((uint16_t)gyr[i] >> 8);
+        }
+    }
+    if (fifo_acc) {
+        for (int i = 0; i < 3; i++) {
+            frame[size++] = (uint8_t)(acc[i] & 0xFF);
+            frame[size++] = (uint8_t)((uint16_t)acc[i] >> 8);
+        }
+    }
+
+    if (sim->fifo_length + size > BMI270_SIM_FIFO_SIZE) {
+        if (sim->regs[BMI270_REG_FIFO_CONFIG_0] & BMI270_FIFO_STOP_ON_FULL) {
+            sim->stats.fifo_dropped_frames++;
+            sim->regs[BMI270_REG_INT_STATUS_1] |= BMI270_INT_STATUS_FFULL;
+            return;
+        }
+        while (sim->fifo_length > 0 && sim->fifo_length + size > BMI270_SIM_FIFO_SIZE) {
+            sim_fifo_drop_front(sim);
+            sim->stats.fifo_dropped_frames++;
+            sim->fifo_skipped++;
+        }
+    }
+
+    memcpy(&sim->fifo[sim->fifo_length], frame, size);
+    sim->fifo_length += size;
+    sim->fifo_frame_size = size;
+    sim->stats.fifo_frames++;
+
+    if (sim->fifo_length + size > BMI270_SIM_FIFO_SIZE) {
+        sim->regs[BMI270_REG_INT_STATUS_1] |= BMI270_INT_STATUS_FFULL;
+    }
+    uint16_t watermark = sim_watermark(sim);
+    if (watermark > 0 && sim->fifo_length >= watermark) {
+        sim->regs[BMI270_REG_INT_STATUS_1] |= BMI270_INT_STATUS_FWM;
+    }
+}
+
+static void sim_produce_sample(bmi270_sim_t *sim) {
+    int16_t acc[3];
+    int16_t gyr[3];
+
+    sim->config.source(sim->config.source_ctx, sim->sample_index, acc, gyr);
+
+    if (sim_acc_on(sim)) {
+        for (int i = 0; i < 3; i++) {
+            sim->regs[BMI270_REG_ACC_X_LSB + 2 * i] = (uint8_t)(acc[i] & 0xFF);
+            sim->regs[BMI270_REG_ACC_X_MSB + 2 * i] = (uint8_t)((uint16_t)acc[i] >> 8);
+        }
+        sim->regs[BMI270_REG_STATUS] |= SIM_STATUS_DRDY_ACC;
+        sim->regs[BMI270_REG_INT_STATUS_1] |= BMI270_INT_STATUS_ACC_DRDY;
+    }
+    if (sim_gyr_on(sim)) {
+        for (int i = 0; i < 3; i++) {
+            sim->regs[BMI270_REG_GYR_X_LSB + 2 * i] = (uint8_t)(gyr[i] & 0xFF);
+            sim->regs[BMI270_REG_GYR_X_MSB + 2 * i] = (uint8_t)((uint16_t)gyr[i] >> 8);
+        }
+        sim->regs[BMI270_REG_STATUS] |= SIM_STATUS_DRDY_GYR;
+        sim->regs[BMI270_REG_INT_STATUS_1] |= BMI270_INT_STATUS_GYR_DRDY;
+    }
+
+    sim_fifo_push(sim, acc, gyr);
+    sim->sample_index++;
+    sim->stats.samples++;
+}
+
+/* ====== Public state handling ====== */
+
+void bmi270_sim_init(bmi270_sim_t *sim, const bmi270_sim_config_t *config) {
+    memset(sim, 0, sizeof(*sim));
+    if (config != NULL) {
+        sim->config = *config;
+    }
+    if (sim->config.source == NULL) {
+        sim->config.source = sim_default_source;
+    }
+    if (sim->config.init_latency_us == 0) {
+        sim->config.init_latency_us = SIM_DEFAULT_INIT_LATENCY_US;
+    }
+    sim_apply_reset_values(sim);
+}
+
+void bmi270_sim_attach(bmi270_sim_t *sim) {
+    host_bus_attach(bmi270_sim_transfer, sim);
+}
+
+uint64_t bmi270_sim_sample_period_ns(const bmi270_sim_t *sim) {
+    uint64_t period = 0;
+    if (sim_acc_on(sim)) {
+        period = sim_odr_period_ns(sim->regs[BMI270_REG_ACC_CONF]);
+    }
+    if (sim_gyr_on(sim)) {
+        uint64_t gyr_period = sim_odr_period_ns(sim->regs[BMI270_REG_GYR_CONF]);
+        if (period == 0 || gyr_period < period) {
+            period = gyr_period;
+        }
+    }
+    return period;
+}
+
+bool bmi270_sim_watermark_reached(const bmi270_sim_t *sim) {
+    uint16_t watermark = sim_watermark(sim);
+    return watermark > 0 && sim->fifo_length >= watermark;
+}
+
+void bmi270_sim_update(bmi270_sim_t *sim) {
+    uint64_t now = host_clock_now_ns();
+
+    if (sim->init_pending && now >= sim->init_ready_ns) {
+        sim->init_pending = false;
+        bool ok = (sim->config_written_count == BMI270_SIM_CONFIG_SIZE);
+        sim->regs[BMI270_REG_INTERNAL_STATUS] =
+            ok ? BMI270_INTERNAL_STATUS_MSG_INIT_OK : BMI270_INTERNAL_STATUS_MSG_INIT_ERR;
+    }
+
+    uint64_t period = bmi270_sim_sample_period_ns(sim);
+    if (period == 0) {
+        sim->running = false;
+        return;
+    }
+    if (!sim->running) {
+        sim->running = true;
+        sim->next_sample_ns = now + period;
+        return;
+    }
+    if (now < sim->next_sample_ns) {
+        return;
+    }
+
+    uint64_t due = (now - sim->next_sample_ns) / period + 1;
+    if (due > SIM_CATCHUP_MAX_SAMPLES) {
+        // Far behind (e.g. the host advanced the clock by seconds): only the
+        // most recent samples can still be in the FIFO
+        uint64_t skipped = due - SIM_CATCHUP_MAX_SAMPLES;
+        sim->sample_index += skipped;
+        sim->stats.samples += skipped;
+        sim->next_sample_ns += skipped * period;
+        due = SIM_CATCHUP_MAX_SAMPLES;
+    }
+    while (due-- > 0) {
+        sim_produce_sample(sim);
+        sim->next_sample_ns += period;
+    }
+}
+
+/* ====== Register access ====== */
+
+typedef struct {
+    uint8_t extra[4];       // Control frame injected into the FIFO read stream
+    uint8_t extra_len;
+    uint8_t extra_pos;
+    bool time_done;
+    uint16_t consumed;      // FIFO bytes popped by this frame
+} sim_fifo_read_t;
+
+static uint8_t sim_read_fifo_byte(bmi270_sim_t *sim, sim_fifo_read_t *rd) {
+    if (rd->extra_pos < rd->extra_len) {
+        return rd->extra[rd->extra_pos++];
+    }
+    if (rd->consumed < sim->fifo_length) {
+        return sim->fifo[rd->consumed++];
+    }
+    if (sim_header_mode(sim) && !rd->time_done &&
+        (sim->regs[BMI270_REG_FIFO_CONFIG_0] & SIM_FIFO_TIME_EN)) {
+        uint32_t time = sim_sensortime();
+        rd->extra[0] = BMI270_FIFO_HEAD_SENSOR_TIME;
+        rd->extra[1] = (uint8_t)(time & 0xFF);
+        rd->extra[2] = (uint8_t)((time >> 8) & 0xFF);
+        rd->extra[3] = (uint8_t)((time >> 16) & 0xFF);
+        rd->extra_len = 4;
+        rd->extra_pos = 1;
+        rd->time_done = true;
+        return rd->extra[0];
+    }
+    sim->stats.over_read_bytes++;
+    return BMI270_FIFO_HEAD_OVER_READ;
+}
+
+static uint8_t sim_read_register(bmi270_sim_t *sim, uint8_t addr, sim_fifo_read_t *rd) {
+    uint8_t value;
+
+    switch (addr) {
+    case BMI270_REG_SENSORTIME_0:
+        return (uint8_t)(sim_sensortime() & 0xFF);
+    case BMI270_REG_SENSORTIME_1:
+        return (uint8_t)((sim_sensortime() >> 8) & 0xFF);
+    case BMI270_REG_SENSORTIME_2:
+        return (uint8_t)((sim_sensortime() >> 16) & 0xFF);
+    case BMI270_REG_INT_STATUS_0:
+    case BMI270_REG_INT_STATUS_1:
+        value = sim->regs[addr];
+        sim->regs[addr] = 0;
+        return value;
+    case BMI270_REG_FIFO_LENGTH_0:
+        return (uint8_t)(sim->fifo_length & 0xFF);
+    case BMI270_REG_FIFO_LENGTH_1:
+        return (uint8_t)((sim->fifo_length >> 8) & 0x3F);
+    case BMI270_REG_FIFO_DATA:
+        return sim_read_fifo_byte(sim, rd);
+    default:
+        break;
+    }
+
+    if (addr >= BMI270_REG_FEATURES && addr < BMI270_REG_FEATURES + BMI270_SIM_FEAT_PAGE_SIZE) {
+        uint8_t page = sim->regs[BMI270_REG_FEAT_PAGE] % BMI270_SIM_FEAT_PAGES;
+        return sim->features[page][addr - BMI270_REG_FEATURES];
+    }
+    if (addr >= BMI270_REG_ACC_X_LSB && addr <= BMI270_REG_ACC_Z_MSB) {
+        sim->regs[BMI270_REG_STATUS] &= (uint8_t)~SIM_STATUS_DRDY_ACC;
+    } else if (addr >= BMI270_REG_GYR_X_LSB && addr <= BMI270_REG_GYR_Z_MSB) {
+        sim->regs[BMI270_REG_STATUS] &= (uint8_t)~SIM_STATUS_DRDY_GYR;
+    }
+    return sim->regs[addr & 0x7F];
+}
+
+static void sim_write_register(bmi270_sim_t *sim, uint8_t addr, uint8_t value) {
+    switch (addr) {
+    case BMI270_REG_CMD:
+        if (value == BMI270_CMD_SOFT_RESET) {
+            sim->stats.soft_resets++;
+            sim_apply_reset_values(sim);
+        } else if (value == BMI270_CMD_FIFO_FLUSH) {
+            sim->fifo_length = 0;
+            sim->fifo_skipped = 0;
+            sim->regs[BMI270_REG_INT_STATUS_1] &=
+                (uint8_t)~(BMI270_INT_STATUS_FWM | BMI270_INT_STATUS_FFULL);
+        }
+        return;
+    case BMI270_REG_INIT_ADDR_0:
+    case BMI270_REG_INIT_ADDR_1:
+        sim->regs[addr] = value;
+        sim->init_ptr = (uint16_t)((((sim->regs[BMI270_REG_INIT_ADDR_1] << 4) |
+                                     (sim->regs[BMI270_REG_INIT_ADDR_0] & 0x0F)) * 2) %
+                                   BMI270_SIM_CONFIG_SIZE);
+        return;
+    case BMI270_REG_INIT_DATA: {
+        uint16_t index = sim->init_ptr;
+        sim->config_mem[index] = value;
+        if (!(sim->config_written[index / 8] & (1 << (index % 8)))) {
+            sim->config_written[index / 8] |= (uint8_t)(1 << (index % 8));
+            sim->config_written_count++;
+            sim->stats.config_bytes++;
+        }
+        sim->init_ptr = (uint16_t)((index + 1) % BMI270_SIM_CONFIG_SIZE);
+        return;
+    }
+    case BMI270_REG_INIT_CTRL:
+        sim->regs[addr] = value;
+        if (value & 0x01) {
+            sim->regs[BMI270_REG_INTERNAL_STATUS] = BMI270_INTERNAL_STATUS_MSG_NOT_INIT;
+            if (sim->regs[BMI270_REG_PWR_CONF] & SIM_PWR_CONF_ADV_POWER_SAVE) {
+                // Config load is ignored while advanced power save is on
+                sim->regs[BMI270_REG_INTERNAL_STATUS] = BMI270_INTERNAL_STATUS_MSG_INIT_ERR;
+                return;
+            }
+            sim->init_pending = true;
+            sim->init_ready_ns = host_clock_now_ns() + sim->config.init_latency_us * 1000ULL;
+        }
+        return;
+    default:
+        break;
+    }
+
+    if (addr >= BMI270_REG_FEATURES && addr < BMI270_REG_FEATURES + BMI270_SIM_FEAT_PAGE_SIZE) {
+        uint8_t page = sim->regs[BMI270_REG_FEAT_PAGE] % BMI270_SIM_FEAT_PAGES;
+        sim->features[page][addr - BMI270_REG_FEATURES] = value;
+        return;
+    }
+    if (addr < BMI270_REG_FEAT_PAGE) {
+        // Read-only data and status registers
+        return;
+    }
+    sim->regs[addr] = value;
+}
+
+/* ====== Bus backend ====== */
+
+esp_err_t bmi270_sim_transfer(void *ctx, const uint8_t *tx, uint8_t *rx, size_t len) {
+    bmi270_sim_t *sim = (bmi270_sim_t *)ctx;
+    if (sim == NULL || tx == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint64_t now = host_clock_now_ns();
+    if ((sim->regs[BMI270_REG_PWR_CONF] & SIM_PWR_CONF_ADV_POWER_SAVE) && sim->stats.frames > 0 &&
+        now - sim->last_frame_ns < BMI270_SIM_LOWPOWER_GAP_US * 1000ULL) {
+        sim->stats.lowpower_violations++;
+    }
+    sim->last_frame_ns = now;
+    sim->stats.frames++;
+
+    bmi270_sim_update(sim);
+
+    bool read = (tx[0] & BMI270_SPI_READ_BIT) != 0;
+    uint8_t addr = tx[0] & 0x7F;
+
+    if (!sim->spi_active) {
+        // The first CSB edge after power-on/reset switches the interface to
+        // SPI; that frame itself is not decoded
+        sim->spi_active = true;
+        if (rx != NULL) {
+            memset(rx, 0, len);
+        }
+        return ESP_OK;
+    }
+
+    if (read) {
+        sim_fifo_read_t rd = {0};
+        if (addr == BMI270_REG_FIFO_DATA && sim_header_mode(sim) && sim->fifo_skipped > 0) {
+            rd.extra[0] = BMI270_FIFO_HEAD_SKIP;
+            rd.extra[1] = (uint8_t)(sim->fifo_skipped > 0xFF ? 0xFF : sim->fifo_skipped);
+            rd.extra_len = 2;
+            sim->fifo_skipped = 0;
+        }
+        if (rx != NULL) {
+            rx[0] = 0x00;
+            if (len > 1) {
+                rx[1] = 0xFF;   // Dummy byte
+            }
+        }
+        for (size_t i = 2; i < len; i++) {
+            uint8_t value = sim_read_register(sim, addr, &rd);
+            if (rx != NULL) {
+                rx[i] = value;
+            }
+            if (addr != BMI270_REG_FIFO_DATA) {
+                addr = (addr + 1) & 0x7F;
+            }
+        }
+        uint16_t consumed = sim_fifo_complete_bytes(sim, rd.consumed);
+        if (consumed > 0) {
+            memmove(sim->fifo, &sim->fifo[consumed], sim->fifo_length - consumed);
+            sim->fifo_length -= consumed;
+        }
+    } else {
+        for (size_t i = 1; i < len; i++) {
+            sim_write_register(sim, addr, tx[i]);
+            if (addr != BMI270_REG_INIT_DATA) {
+                addr = (addr + 1) & 0x7F;
+            }
+        }
+        if (rx != NULL) {
+            memset(rx, 0, len);
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,167 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file bmi270_sim.h
+ * @brief Register-level BMI270 simulator for the host port
+ *
+ * The simulator is attached as a host bus backend and answers SPI frames
+ * the way the sensor does, so that any driver (this one or the Bosch
+ * SensorAPI) can be exercised against it unmodified:
+ * - SPI interface activation: the first frame after power-on or soft
+ *   reset returns zeros (drivers must issue a dummy read)
+ * - Soft reset, FIFO flush, PWR_CONF / PWR_CTRL
+ * - Config file upload via INIT_ADDR / INIT_DATA; INTERNAL_STATUS reports
+ *   INIT_OK init_latency_us after INIT_CTRL = 1 if all 8192 bytes were
+ *   written with advanced power save disabled, INIT_ERR otherwise
+ * - Data registers, SENSORTIME, DRDY/FWM/FFULL status (clear-on-read)
+ * - FIFO in header and headerless mode, stream (overwrite) and
+ *   stop-on-full, skip frames after overflow, sensor time frame and 0x80
+ *   over-read pattern; a partially read frame stays in the FIFO
+ * - Feature configuration pages (0x2F / 0x30..0x3F)
+ *
+ * Simplifications: accelerometer and gyroscope share the faster of the
+ * two ODRs; the AUX interface and feature engine are not modelled.
+ */
+
+#ifndef BMI270_SIM_H
+#define BMI270_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BMI270_SIM_FIFO_SIZE        2048    ///< FIFO capacity (bytes)
+#define BMI270_SIM_CONFIG_SIZE      8192    ///< Config file memory (bytes)
+#define BMI270_SIM_FEAT_PAGES       8       ///< Feature configuration pages
+#define BMI270_SIM_FEAT_PAGE_SIZE   16      ///< Bytes per feature page
+#define BMI270_SIM_LOWPOWER_GAP_US  450     ///< Required access gap with advanced power save
+
+/**
+ * @brief Sample source callback
+ *
+ * Provides the raw sample produced at ODR tick sample_index.
+ *
+ * @param ctx User context
+ * @param sample_index Index of the sample since sensors were enabled
+ * @param acc Raw accelerometer output [LSB] (x, y, z)
+ * @param gyr Raw gyroscope output [LSB] (x, y, z)
+ */
+typedef void (*bmi270_sim_source_fn_t)(void *ctx, uint64_t sample_index, int16_t acc[3], int16_t gyr[3]);
+
+/**
+ * @brief Simulator configuration
+ */
+typedef struct {
+    bmi270_sim_source_fn_t source;      ///< Sample source (NULL = built-in synthetic motion)
+    void *source_ctx;                   ///< Context for source
+    uint32_t init_latency_us;           ///< INIT_CTRL to INTERNAL_STATUS = INIT_OK (0 = 20000)
+} bmi270_sim_config_t;
+
+/**
+ * @brief Simulator counters
+ */
+typedef struct {
+    uint64_t frames;                    ///< SPI frames received
+    uint64_t samples;                   ///< ODR ticks simulated
+    uint64_t fifo_frames;               ///< Frames written into the FIFO
+    uint64_t fifo_dropped_frames;       ///< Frames lost to overflow (stream) or full FIFO (stop-on-full)
+    uint64_t over_read_bytes;           ///< FIFO bytes read beyond the fill level
+    uint32_t soft_resets;               ///< Soft reset commands
+    uint32_t config_bytes;              ///< Config bytes written since last reset
+    uint32_t lowpower_violations;       ///< Frames closer than 450 µs while advanced power save was on
+} bmi270_sim_stats_t;
+
+/**
+ * @brief Simulator state
+ */
+typedef struct {
+    bmi270_sim_config_t config;
+    uint8_t regs[128];                                          ///< Register file
+    uint8_t config_mem[BMI270_SIM_CONFIG_SIZE];                 ///< Uploaded config file
+    uint8_t config_written[BMI270_SIM_CONFIG_SIZE / 8];         ///< Written-byte bitmap
+    uint16_t config_written_count;                              ///< Distinct bytes written
+    uint16_t init_ptr;                                          ///< Next INIT_DATA byte index
+    uint8_t features[BMI270_SIM_FEAT_PAGES][BMI270_SIM_FEAT_PAGE_SIZE];
+    uint8_t fifo[BMI270_SIM_FIFO_SIZE];
+    uint16_t fifo_length;
+    uint16_t fifo_frame_size;                                   ///< Size of the frames currently queued
+    uint32_t fifo_skipped;                                      ///< Frames dropped since last read
+    bool spi_active;                                            ///< SPI interface selected
+    bool init_pending;
+    uint64_t init_ready_ns;
+    bool running;                                               ///< Sensors producing samples
+    uint64_t next_sample_ns;
+    uint64_t sample_index;
+    uint64_t last_frame_ns;
+    bmi270_sim_stats_t stats;
+} bmi270_sim_t;
+
+/**
+ * @brief Initialize the simulator in power-on state
+ *
+ * @param sim Simulator state
+ * @param config Configuration (NULL = defaults)
+ */
+void bmi270_sim_init(bmi270_sim_t *sim, const bmi270_sim_config_t *config);
+
+/**
+ * @brief Attach the simulator as the bus backend of the calling thread
+ */
+void bmi270_sim_attach(bmi270_sim_t *sim);
+
+/**
+ * @brief Bus backend entry point (host_bus_transfer_fn_t)
+ */
+esp_err_t bmi270_sim_transfer(void *ctx, const uint8_t *tx, uint8_t *rx, size_t len);
+
+/**
+ * @brief Advance sensor state to the current virtual time
+ *
+ * Called automatically on every frame; exposed for callers that need
+ * sample timing without bus activity (e.g. interrupt emulation).
+ */
+void bmi270_sim_update(bmi270_sim_t *sim);
+
+/**
+ * @brief Current ODR tick period [ns] (0 if no sensor is running)
+ */
+uint64_t bmi270_sim_sample_period_ns(const bmi270_sim_t *sim);
+
+/**
+ * @brief Whether the FIFO watermark is currently reached
+ */
+bool bmi270_sim_watermark_reached(const bmi270_sim_t *sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BMI270_SIM_H
@@ -0,0 +1,464 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file sweep.c
+ * @brief Parameter sweep over a recorded FIFO stream
+ *
+ * Maps a recorded FIFO byte stream once, expands a grid of pipeline
+ * configurations (watermark x output rate x CIC order x compensation x
+ * spike filter x estimator gain) and runs every grid point through the
+ * real driver on its own simulated board, spread over all cores by a
+ * work-stealing scheduler. Results are ranked by latency, noise or
+ * estimator error; configurations that no other configuration beats on
+ * all three are marked as Pareto-optimal.
+ *
+ * Without a flight log at hand, --synth writes a synthetic recording in
+ * the same format.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bmi270_data.h"
+#include "sweep_sched.h"
+#include "sweep_recording.h"
+#include "sweep_pipeline.h"
+
+#define SWEEP_MAX_VALUES        16
+#define SWEEP_DEFAULT_TOP       20
+#define SWEEP_DEFAULT_REF_GAIN  0.5f
+#define SWEEP_DEFAULT_SECONDS   30
+
+/**
+ * @brief Ranking key
+ */
+typedef enum {
+    SORT_ERROR = 0,
+    SORT_LATENCY,
+    SORT_NOISE,
+} sweep_sort_t;
+
+/**
+ * @brief List of values of one grid axis
+ */
+typedef struct {
+    double values[SWEEP_MAX_VALUES];
+    size_t count;
+} sweep_axis_t;
+
+typedef struct {
+    const char *recording;
+    uint32_t odr_hz;
+    uint32_t acc_range_g;
+    uint32_t gyr_range_dps;
+    float ref_gain;
+    unsigned threads;
+    sweep_sort_t sort;
+    size_t top;
+    const char *csv_path;
+    sweep_axis_t watermark;
+    sweep_axis_t rate;
+    sweep_axis_t order;
+    sweep_axis_t comp;
+    sweep_axis_t spike;
+    sweep_axis_t gain;
+} sweep_options_t;
+
+/**
+ * @brief Shared state of the sweep (read-only for the workers except results[job])
+ */
+typedef struct {
+    const sweep_recording_t *rec;
+    sweep_config_t *configs;
+    sweep_result_t *results;
+    bool *pareto;
+} sweep_t;
+
+static const char *const s_spike_names[] = { "off", "delta", "median3" };
+
+/* ====== Options ====== */
+
+static bool sweep_parse_axis(const char *text, sweep_axis_t *axis, bool spike) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    axis->count = 0;
+
+    for (char *token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+        if (axis->count == SWEEP_MAX_VALUES) {
+            return false;
+        }
+        double value = -1.0;
+        if (spike) {
+            for (size_t m = 0; m < sizeof(s_spike_names) / sizeof(s_spike_names[0]); m++) {
+                if (strcmp(token, s_spike_names[m]) == 0) {
+                    value = (double)m;
+                }
+            }
+        } else {
+            char *end;
+            value = strtod(token, &end);
+            if (*end != '\0') {
+                value = -1.0;
+            }
+        }
+        if (value < 0.0) {
+            return false;
+        }
+        axis->values[axis->count++] = value;
+    }
+    return axis->count > 0;
+}
+
+static bool sweep_acc_range(uint32_t g, uint8_t *range) {
+    switch (g) {
+    case 2:  *range = BMI270_ACC_RANGE_2G;  return true;
+    case 4:  *range = BMI270_ACC_RANGE_4G;  return true;
+    case 8:  *range = BMI270_ACC_RANGE_8G;  return true;
+    case 16: *range = BMI270_ACC_RANGE_16G; return true;
+    default: return false;
+    }
+}
+
+static bool sweep_gyr_range(uint32_t dps, uint8_t *range) {
+    switch (dps) {
+    case 125:  *range = BMI270_GYR_RANGE_125DPS;  return true;
+    case 250:  *range = BMI270_GYR_RANGE_250DPS;  return true;
+    case 500:  *range = BMI270_GYR_RANGE_500DPS;  return true;
+    case 1000: *range = BMI270_GYR_RANGE_1000DPS; return true;
+    case 2000: *range = BMI270_GYR_RANGE_2000DPS; return true;
+    default: return false;
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s RECORDING [--odr HZ] [--acc-range G] [--gyr-range DPS] [--threads N]\n"
+            "          [--watermark LIST] [--rate LIST] [--order LIST] [--comp LIST]\n"
+            "          [--spike LIST] [--gain LIST] [--ref-gain G]\n"
+            "          [--sort error|latency|noise] [--top N] [--csv FILE]\n"
+            "       %s --synth FILE [--seconds S] [--seed N]\n"
+            "LIST is comma separated, e.g. --rate 50,100,200 --spike off,delta,median3\n",
+            prog, prog);
+}
+
+/* ====== Sweep ====== */
+
+static size_t sweep_build_grid(const sweep_options_t *options, sweep_config_t **configs) {
+    size_t count = options->watermark.count * options->rate.count * options->order.count *
+                   options->comp.count * options->spike.count * options->gain.count;
+    sweep_config_t *grid = calloc(count, sizeof(sweep_config_t));
+    if (grid == NULL) {
+        return 0;
+    }
+
+    size_t n = 0;
+    for (size_t w = 0; w < options->watermark.count; w++)
+    for (size_t r = 0; r < options->rate.count; r++)
+    for (size_t o = 0; o < options->order.count; o++)
+    for (size_t c = 0; c < options->comp.count; c++)
+    for (size_t s = 0; s < options->spike.count; s++)
+    for (size_t g = 0; g < options->gain.count; g++) {
+        grid[n++] = (sweep_config_t){
+            .watermark = (uint16_t)options->watermark.values[w],
+            .output_rate_hz = (uint32_t)options->rate.values[r],
+            .order = (uint8_t)options->order.values[o],
+            .compensate = options->comp.values[c] != 0.0,
+            .spike_mode = (bmi270_spike_mode_t)options->spike.values[s],
+            .gain = (float)options->gain.values[g],
+        };
+    }
+    *configs = grid;
+    return count;
+}
+
+static void sweep_job(void *ctx, size_t job, unsigned worker) {
+    (void)worker;
+    sweep_t *sweep = ctx;
+    sweep_pipeline_run(sweep->rec, &sweep->configs[job], &sweep->results[job]);
+}
+
+/**
+ * @brief a is at least as good as b on every metric and better on one
+ */
+static bool sweep_dominates(const sweep_result_t *a, const sweep_result_t *b) {
+    bool no_worse = a->latency_mean_us <= b->latency_mean_us && a->noise_mrad_s <= b->noise_mrad_s &&
+                    a->err_rms_deg <= b->err_rms_deg;
+    bool better = a->latency_mean_us < b->latency_mean_us || a->noise_mrad_s < b->noise_mrad_s ||
+                  a->err_rms_deg < b->err_rms_deg;
+    return no_worse && better;
+}
+
+static void sweep_mark_pareto(sweep_t *sweep, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        sweep->pareto[i] = sweep->results[i].valid;
+        for (size_t j = 0; j < count && sweep->pareto[i]; j++) {
+            if (j != i && sweep->results[j].valid && sweep_dominates(&sweep->results[j], &sweep->results[i])) {
+                sweep->pareto[i] = false;
+            }
+        }
+    }
+}
+
+static const sweep_t *s_sort_sweep;
+static sweep_sort_t s_sort_key;
+
+static float sweep_key(const sweep_result_t *result) {
+    switch (s_sort_key) {
+    case SORT_LATENCY: return result->latency_mean_us;
+    case SORT_NOISE:   return result->noise_mrad_s;
+    default:           return result->err_rms_deg;
+    }
+}
+
+static int sweep_compare(const void *a, const void *b) {
+    const sweep_result_t *ra = &s_sort_sweep->results[*(const size_t *)a];
+    const sweep_result_t *rb = &s_sort_sweep->results[*(const size_t *)b];
+    if (ra->valid != rb->valid) {
+        return ra->valid ? -1 : 1;
+    }
+    float ka = sweep_key(ra);
+    float kb = sweep_key(rb);
+    if (ka != kb) {
+        return ka < kb ? -1 : 1;
+    }
+    // Stable order between equal keys: grid index
+    return (*(const size_t *)a < *(const size_t *)b) ? -1 : 1;
+}
+
+static void sweep_print_row(const sweep_t *sweep, size_t index, size_t rank) {
+    const sweep_config_t *c = &sweep->configs[index];
+    const sweep_result_t *r = &sweep->results[index];
+    printf("%4zu %c %5u %5u %5u %4s %-7s %5.2f | %8.0f %8.0f %8.2f %7.3f %7.3f %6u\n", rank,
+           sweep->pareto[index] ? '*' : ' ', c->watermark, c->output_rate_hz, c->order,
+           c->compensate ? "yes" : "no", s_spike_names[c->spike_mode], c->gain, r->latency_mean_us,
+           r->latency_max_us, r->noise_mrad_s, r->err_rms_deg, r->err_max_deg, r->spike_rejected);
+}
+
+static void sweep_write_csv(const char *path, const sweep_t *sweep, size_t count) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        return;
+    }
+    fprintf(file, "watermark,rate_hz,order,compensate,spike,gain,valid,pareto,outputs,drains,"
+                  "latency_mean_us,latency_max_us,noise_mrad_s,err_rms_deg,err_max_deg,"
+                  "spike_rejected,lost_frames,cpu_ms\n");
+    for (size_t i = 0; i < count; i++) {
+        const sweep_config_t *c = &sweep->configs[i];
+        const sweep_result_t *r = &sweep->results[i];
+        fprintf(file, "%u,%u,%u,%d,%s,%g,%d,%d,%u,%u,%.1f,%.1f,%.3f,%.4f,%.4f,%u,%u,%.2f\n", c->watermark,
+                c->output_rate_hz, c->order, c->compensate, s_spike_names[c->spike_mode], c->gain, r->valid,
+                sweep->pareto[i], r->outputs, r->drains, r->latency_mean_us, r->latency_max_us,
+                r->noise_mrad_s, r->err_rms_deg, r->err_max_deg, r->spike_rejected, r->lost_frames,
+                r->cpu_ms);
+    }
+    fclose(file);
+}
+
+static double sweep_wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+/* ====== Main ====== */
+
+int main(int argc, char **argv) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    sweep_options_t options = {
+        .odr_hz = 1600,
+        .acc_range_g = 4,
+        .gyr_range_dps = 2000,
+        .ref_gain = SWEEP_DEFAULT_REF_GAIN,
+        .threads = cpus > 0 ? (unsigned)cpus : 1,
+        .sort = SORT_ERROR,
+        .top = SWEEP_DEFAULT_TOP,
+        .watermark = { { 208, 416, 832 }, 3 },
+        .rate = { { 50, 100, 200, 400 }, 4 },
+        .order = { { 1, 2, 3 }, 3 },
+        .comp = { { 0, 1 }, 2 },
+        .spike = { { BMI270_SPIKE_OFF, BMI270_SPIKE_DELTA, BMI270_SPIKE_MEDIAN3 }, 3 },
+        .gain = { { 0.2, 0.5, 1.0, 2.0 }, 4 },
+    };
+    const char *synth_path = NULL;
+    uint32_t synth_seconds = SWEEP_DEFAULT_SECONDS;
+    uint64_t synth_seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        bool ok = true;
+        if (i + 1 < argc && strcmp(argv[i], "--synth") == 0) {
+            synth_path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+            synth_seconds = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+            synth_seed = strtoull(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--odr") == 0) {
+            options.odr_hz = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--acc-range") == 0) {
+            options.acc_range_g = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--gyr-range") == 0) {
+            options.gyr_range_dps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+            options.threads = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--ref-gain") == 0) {
+            options.ref_gain = strtof(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "--top") == 0) {
+            options.top = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "--csv") == 0) {
+            options.csv_path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--sort") == 0) {
+            const char *key = argv[++i];
+            options.sort = strcmp(key, "latency") == 0 ? SORT_LATENCY :
+                           strcmp(key, "noise") == 0   ? SORT_NOISE : SORT_ERROR;
+            ok = strcmp(key, "latency") == 0 || strcmp(key, "noise") == 0 || strcmp(key, "error") == 0;
+        } else if (i + 1 < argc && strcmp(argv[i], "--watermark") == 0) {
+            ok = sweep_parse_axis(argv[++i], &options.watermark, false);
+        } else if (i + 1 < argc && strcmp(argv[i], "--rate") == 0) {
+            ok = sweep_parse_axis(argv[++i], &options.rate, false);
+        } else if (i + 1 < argc && strcmp(argv[i], "--order") == 0) {
+            ok = sweep_parse_axis(argv[++i], &options.order, false);
+        } else if (i + 1 < argc && strcmp(argv[i], "--comp") == 0) {
+            ok = sweep_parse_axis(argv[++i], &options.comp, false);
+        } else if (i + 1 < argc && strcmp(argv[i], "--spike") == 0) {
+            ok = sweep_parse_axis(argv[++i], &options.spike, true);
+        } else if (i + 1 < argc && strcmp(argv[i], "--gain") == 0) {
+            ok = sweep_parse_axis(argv[++i], &options.gain, false);
+        } else if (argv[i][0] != '-' && options.recording == NULL) {
+            options.recording = argv[i];
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (synth_path != NULL) {
+        if (sweep_pipeline_record_synthetic(synth_path, synth_seconds, synth_seed) != 0) {
+            return 1;
+        }
+        printf("wrote %s: %u s at 1600 Hz, ACC ±4 g, GYR ±2000 dps\n", synth_path, synth_seconds);
+        return 0;
+    }
+
+    uint8_t acc_range;
+    uint8_t gyr_range;
+    bool odr_ok = options.odr_hz >= 100 && options.odr_hz <= 1600 && (options.odr_hz / 100 & (options.odr_hz / 100 - 1)) == 0 &&
+                  options.odr_hz % 100 == 0;
+    if (options.recording == NULL || !odr_ok || !sweep_acc_range(options.acc_range_g, &acc_range) ||
+        !sweep_gyr_range(options.gyr_range_dps, &gyr_range) || options.threads == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    sweep_recording_t rec;
+    if (sweep_recording_open(&rec, options.recording, options.odr_hz, acc_range, gyr_range,
+                             options.ref_gain) != 0) {
+        return 1;
+    }
+
+    sweep_t sweep = { .rec = &rec };
+    size_t count = sweep_build_grid(&options, &sweep.configs);
+    sweep.results = calloc(count, sizeof(sweep_result_t));
+    sweep.pareto = calloc(count, sizeof(bool));
+    sweep_sched_worker_stats_t *worker_stats = calloc(options.threads, sizeof(*worker_stats));
+    size_t *order = calloc(count, sizeof(size_t));
+    if (count == 0 || sweep.results == NULL || sweep.pareto == NULL || worker_stats == NULL || order == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("recording: %s, %zu bytes, %u samples (%.1f s at %u Hz), %u skipped frames\n",
+           options.recording, rec.length, rec.sample_count, (double)rec.sample_count / rec.odr_hz,
+           rec.odr_hz, rec.skip_frames);
+    printf("grid: %zu configurations on %u threads\n", count, options.threads);
+
+    double start_ms = sweep_wall_ms();
+    if (sweep_sched_run(count, options.threads, sweep_job, &sweep, worker_stats) != 0) {
+        fprintf(stderr, "failed to start worker threads\n");
+        return 1;
+    }
+    double wall_ms = sweep_wall_ms() - start_ms;
+
+    double cpu_ms = 0.0;
+    size_t valid = 0;
+    uint64_t steals = 0;
+    for (size_t i = 0; i < count; i++) {
+        cpu_ms += sweep.results[i].cpu_ms;
+        valid += sweep.results[i].valid;
+    }
+    for (unsigned w = 0; w < options.threads; w++) {
+        steals += worker_stats[w].steals;
+    }
+    printf("done: %.2f s wall, %.2f s CPU (%.1fx), %llu steals, %zu/%zu configurations valid\n",
+           wall_ms / 1e3, cpu_ms / 1e3, cpu_ms / wall_ms, (unsigned long long)steals, valid, count);
+
+    // Rank
+    sweep_mark_pareto(&sweep, count);
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    s_sort_sweep = &sweep;
+    s_sort_key = options.sort;
+    qsort(order, count, sizeof(size_t), sweep_compare);
+
+    static const char *const sort_names[] = { "estimator error", "latency", "noise" };
+    printf("\nranked by %s (* = Pareto-optimal in latency, noise and error)\n", sort_names[options.sort]);
+    printf("%4s %c %5s %5s %5s %4s %-7s %5s | %8s %8s %8s %7s %7s %6s\n", "rank", ' ', "wm", "rate", "order",
+           "comp", "spike", "gain", "lat_us", "lat_max", "noise", "err_rms", "err_max", "spikes");
+    printf("%33s [1/s] | %8s %8s %8s %7s %7s\n", "", "", "", "[mrad/s]", "[deg]", "[deg]");
+    for (size_t i = 0; i < count && i < options.top && sweep.results[order[i]].valid; i++) {
+        sweep_print_row(&sweep, order[i], i + 1);
+    }
+
+    size_t pareto = 0;
+    for (size_t i = 0; i < count; i++) {
+        pareto += sweep.pareto[i];
+    }
+    printf("\nPareto-optimal configurations: %zu\n", pareto);
+    for (size_t i = 0, rank = 0; i < count; i++) {
+        rank++;
+        if (sweep.pareto[order[i]] && rank > options.top) {
+            sweep_print_row(&sweep, order[i], rank);
+        }
+    }
+
+    if (options.csv_path != NULL) {
+        sweep_write_csv(options.csv_path, &sweep, count);
+    }
+
+    free(order);
+    free(worker_stats);
+    free(sweep.pareto);
+    free(sweep.results);
+    free(sweep.configs);
+    sweep_recording_close(&rec);
+    return 0;
+}
@@ -0,0 +1,538 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file sweep_pipeline.c
+ * @brief One sweep job: replay a recording through the driver pipeline
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_port.h"
+#include "bmi270_sim.h"
+#include "bmi270_spi.h"
+#include "bmi270_init.h"
+#include "bmi270_data.h"
+#include "bmi270_fifo_stream.h"
+#include "bmi270_batch_pool.h"
+#include "bmi270_decimator.h"
+#include "sweep_pipeline.h"
+
+#define SWEEP_RING_SIZE         4096U       // Sample times kept (> FIFO + decimator history)
+#define SWEEP_WARMUP_OUTPUTS    8           // Outputs skipped while filter and estimator settle
+#define SWEEP_SPI_CLOCK_HZ      10000000
+
+// Spike filter limits (same as examples/hybrid_fifo)
+#define SWEEP_SPIKE_GYR_MAX_ACCEL   2000.0f
+#define SWEEP_SPIKE_GYR_MAX_JERK    1.0e6f
+#define SWEEP_SPIKE_ACC_MAX_SLEW    200.0f
+#define SWEEP_SPIKE_NOISE_MARGIN    24
+
+// Synthetic recording
+#define SYNTH_ODR_HZ            1600
+#define SYNTH_WATERMARK         (32U * BMI270_FIFO_FRAME_ACC_GYR_SIZE)
+#define SYNTH_ACC_LSB_PER_G     8192.0      // ±4 g
+#define SYNTH_GYR_LSB_PER_RAD_S (16.4 * 180.0 / M_PI)   // ±2000 °/s
+#define SYNTH_SPIKE_PERIOD      4000        // Mean samples between bus spikes
+#define SYNTH_POOL_BUFFERS      3           // Lendable batches (kept small so the pool runs dry)
+#define SYNTH_WRITE_BEHIND      3           // Batches held back before they are written
+
+static const bmi270_config_t s_bus_config = {
+    .gpio_mosi = 14,
+    .gpio_miso = 43,
+    .gpio_sclk = 44,
+    .gpio_cs = 46,
+    .spi_clock_hz = SWEEP_SPI_CLOCK_HZ,
+    .spi_host = SPI2_HOST,
+    .gpio_other_cs = 12,
+};
+
+/**
+ * @brief State of one job (about 30 KB, heap allocated)
+ */
+typedef struct {
+    const sweep_recording_t *rec;
+    const sweep_config_t *config;
+    sweep_result_t *result;
+    bmi270_sim_t sim;
+    sweep_cursor_t cursor;
+    bmi270_raw_data_t acc;          ///< Last replayed sample
+    bmi270_raw_data_t gyr;
+    bool ended;                     ///< Recording exhausted
+    uint64_t sample_ns[SWEEP_RING_SIZE];    ///< ODR tick time by sample index
+    bmi270_dev_t dev;
+    bmi270_fifo_stream_t stream;
+    bmi270_spike_filter_t spike;
+    bmi270_decimator_t decimator;
+    bmi270_decimator_output_t outputs[BMI270_FIFO_MAX_SAMPLES + 1];
+    uint64_t next_index;            ///< Sample index of the next FIFO sample
+    uint64_t prev_index;            ///< Sample index that completed the previous output
+    double group_delay;             ///< Decimator group delay [samples]
+    sweep_attitude_t att;
+    uint32_t skipped_outputs;
+    double latency_sum_us;
+    double noise_sum;
+    double err_sum;
+} sweep_job_t;
+
+static uint8_t sweep_odr_code(uint32_t odr_hz) {
+    // 100 Hz = 0x08, every doubling +1 (same code for ACC and GYR)
+    uint8_t code = 0x08;
+    while (odr_hz > 100 && code < 0x0C) {
+        odr_hz /= 2;
+        code++;
+    }
+    return code;
+}
+
+/* ====== Replay ====== */
+
+/**
+ * @brief Simulator sample source: recorded sample number sample_index
+ */
+static void sweep_replay_source(void *ctx, uint64_t sample_index, int16_t acc[3], int16_t gyr[3]) {
+    sweep_job_t *job = ctx;
+
+    while (!job->ended && job->cursor.index <= sample_index) {
+        if (!sweep_cursor_next(&job->cursor, &job->acc, &job->gyr)) {
+            job->ended = true;
+        }
+    }
+    // Called before next_sample_ns advances: this is the tick time
+    job->sample_ns[sample_index % SWEEP_RING_SIZE] = job->sim.next_sample_ns;
+
+    acc[0] = job->acc.x;
+    acc[1] = job->acc.y;
+    acc[2] = job->acc.z;
+    gyr[0] = job->gyr.x;
+    gyr[1] = job->gyr.y;
+    gyr[2] = job->gyr.z;
+}
+
+/**
+ * @brief Application side: decimate, estimate and score every output
+ */
+static void sweep_batch_cb(const bmi270_fifo_batch_t *batch, void *user_ctx) {
+    sweep_job_t *job = user_ctx;
+    const sweep_recording_t *rec = job->rec;
+    sweep_result_t *result = job->result;
+    uint16_t out_count = 0;
+
+    if (batch->sync_lost) {
+        bmi270_decimator_reset(&job->decimator);
+    }
+    job->next_index += batch->lost_frames;
+
+    bmi270_decimator_process(&job->decimator, batch->samples, batch->sample_count, job->outputs,
+                             sizeof(job->outputs) / sizeof(job->outputs[0]), &out_count);
+
+    uint64_t now_ns = host_clock_now_ns();
+    uint64_t newest = job->sim.sample_index - 1;    // Latest sample the sensor has produced
+    uint64_t period_ns = bmi270_sim_sample_period_ns(&job->sim);
+
+    for (uint16_t i = 0; i < out_count; i++) {
+        const bmi270_decimator_output_t *out = &job->outputs[i];
+        uint64_t index = job->next_index + out->sample_index;
+        float dt = (float)(index - job->prev_index) / (float)rec->odr_hz;
+        job->prev_index = index;
+
+        float gyr[3] = { out->gyr.x, out->gyr.y, out->gyr.z };
+        float acc[3] = { out->acc.x, out->acc.y, out->acc.z };
+        sweep_attitude_update(&job->att, gyr, acc, dt, job->config->gain);
+
+        if (job->skipped_outputs < SWEEP_WARMUP_OUTPUTS) {
+            job->skipped_outputs++;
+            continue;
+        }
+        if (newest >= rec->sample_count || index >= rec->sample_count) {
+            continue;   // Past the end of the recording (last sample repeated)
+        }
+
+        // Latency from the centre of the filter window
+        double centre = (double)index - job->group_delay;
+        double centre_ns = (double)job->sample_ns[index % SWEEP_RING_SIZE] - job->group_delay * (double)period_ns;
+        double latency_us = ((double)now_ns - centre_ns) / 1000.0;
+        job->latency_sum_us += latency_us;
+        if (latency_us > result->latency_max_us) {
+            result->latency_max_us = (float)latency_us;
+        }
+
+        // Noise against the zero-phase smoothed recording at the same instant
+        uint32_t c = centre > 0.0 ? (uint32_t)lround(centre) : 0;
+        for (int axis = 0; axis < 3; axis++) {
+            double d = gyr[axis] - rec->ref_gyr[3 * c + axis];
+            job->noise_sum += d * d;
+        }
+
+        // Estimator error at delivery time
+        double dr = job->att.roll - rec->ref_roll[newest];
+        double dp = job->att.pitch - rec->ref_pitch[newest];
+        double err_deg = sqrt(dr * dr + dp * dp) * (180.0 / M_PI);
+        job->err_sum += err_deg * err_deg;
+        if (err_deg > result->err_max_deg) {
+            result->err_max_deg = (float)err_deg;
+        }
+        result->outputs++;
+    }
+
+    job->next_index += batch->sample_count;
+}
+
+static esp_err_t sweep_bringup(sweep_job_t *job) {
+    const sweep_config_t *config = job->config;
+    uint8_t odr = sweep_odr_code(job->rec->odr_hz);
+
+    esp_err_t ret = bmi270_spi_init(&job->dev, &s_bus_config);
+    if (ret == ESP_OK) {
+        ret = bmi270_init(&job->dev);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_range(&job->dev, (bmi270_acc_range_t)job->rec->acc_range);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_range(&job->dev, (bmi270_gyr_range_t)job->rec->gyr_range);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_config(&job->dev, (bmi270_acc_odr_t)odr, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_config(&job->dev, (bmi270_gyr_odr_t)odr, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    bmi270_decimator_config_t decimator_config = {
+        .input_rate_hz = job->rec->odr_hz,
+        .output_rate_hz = config->output_rate_hz,
+        .order = config->order,
+        .compensate = config->compensate,
+    };
+    ret = bmi270_decimator_init(&job->decimator, &job->dev, &decimator_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    double ratio = (double)job->rec->odr_hz / (double)config->output_rate_hz;
+    job->group_delay = config->order * (ratio - 1.0) / 2.0 + (config->compensate ? ratio : 0.0);
+
+    bmi270_spike_filter_t *spike = NULL;
+    if (config->spike_mode != BMI270_SPIKE_OFF) {
+        bmi270_spike_config_t spike_config = {
+            .mode = config->spike_mode,
+            .sample_rate_hz = job->rec->odr_hz,
+            .gyr_max_accel = SWEEP_SPIKE_GYR_MAX_ACCEL,
+            .gyr_max_jerk = SWEEP_SPIKE_GYR_MAX_JERK,
+            .acc_max_slew = SWEEP_SPIKE_ACC_MAX_SLEW,
+            .noise_margin_lsb = SWEEP_SPIKE_NOISE_MARGIN,
+        };
+        ret = bmi270_spike_init(&job->spike, &job->dev, &spike_config);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        spike = &job->spike;
+    }
+
+    bmi270_fifo_stream_config_t stream_config = {
+        .watermark = config->watermark,
+        .int_pin = BMI270_INT_PIN_1,
+        .callback = sweep_batch_cb,
+        .user_ctx = job,
+        .spike_filter = spike,
+    };
+    ret = bmi270_fifo_stream_init(&job->stream, &job->dev, &stream_config);
+
+    // The FIFO was flushed: its first sample is the next one the sensor produces
+    job->next_index = job->sim.sample_index;
+    job->prev_index = job->next_index;
+    return ret;
+}
+
+void sweep_pipeline_run(const sweep_recording_t *rec, const sweep_config_t *config, sweep_result_t *result) {
+    struct timespec cpu_start;
+    struct timespec cpu_end;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+
+    memset(result, 0, sizeof(*result));
+    sweep_job_t *job = calloc(1, sizeof(*job));
+    if (job == NULL) {
+        return;
+    }
+    job->rec = rec;
+    job->config = config;
+    job->result = result;
+    sweep_cursor_init(&job->cursor, rec);
+
+    host_port_reset();
+    bmi270_sim_config_t sim_config = { .source = sweep_replay_source, .source_ctx = job };
+    bmi270_sim_init(&job->sim, &sim_config);
+    bmi270_sim_attach(&job->sim);
+
+    if (sweep_bringup(job) == ESP_OK) {
+        uint64_t period_ns = bmi270_sim_sample_period_ns(&job->sim);
+        while (!job->ended) {
+            host_clock_advance_ns(period_ns);
+            bmi270_sim_update(&job->sim);
+            if (bmi270_sim_watermark_reached(&job->sim)) {
+                bmi270_fifo_stream_notify_from_isr(&job->stream);
+                bmi270_fifo_stream_drain(&job->stream);
+            }
+        }
+
+        bmi270_fifo_stats_t stats;
+        bmi270_fifo_stream_get_stats(&job->stream, &stats);
+        result->drains = stats.drains;
+        result->spike_rejected = stats.spike_rejected;
+        result->lost_frames = stats.lost_frames;
+        if (result->outputs > 0) {
+            result->valid = true;
+            result->latency_mean_us = (float)(job->latency_sum_us / result->outputs);
+            result->noise_mrad_s = (float)(1000.0 * sqrt(job->noise_sum / (3.0 * result->outputs)));
+            result->err_rms_deg = (float)sqrt(job->err_sum / result->outputs);
+        }
+    }
+
+    host_bus_reset();
+    free(job);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+    result->cpu_ms = (double)(cpu_end.tv_sec - cpu_start.tv_sec) * 1e3 +
+                     (double)(cpu_end.tv_nsec - cpu_start.tv_nsec) / 1e6;
+}
+
+/* ====== Synthetic recording ====== */
+
+/**
+ * @brief Recorder state
+ */
+typedef struct {
+    bmi270_sim_t sim;
+    bmi270_dev_t dev;
+    bmi270_fifo_stream_t stream;
+    bmi270_batch_pool_t pool;
+    bmi270_batch_buf_t pool_buffers[SYNTH_POOL_BUFFERS];
+    const bmi270_fifo_batch_t *pending[SYNTH_WRITE_BEHIND]; // Retained, oldest first
+    uint8_t pending_count;
+    FILE *file;
+    uint64_t rand_state;
+    bool write_error;
+} sweep_synth_t;
+
+static uint64_t sweep_rand(uint64_t *state) {
+    // splitmix64
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double sweep_rand_uniform(uint64_t *state) {
+    return ((double)(sweep_rand(state) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static double sweep_rand_normal(uint64_t *state) {
+    // Box-Muller
+    double u1 = sweep_rand_uniform(state);
+    double u2 = sweep_rand_uniform(state);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int16_t sweep_saturate(double value) {
+    if (value > 32767.0) {
+        return 32767;
+    }
+    if (value < -32768.0) {
+        return -32768;
+    }
+    return (int16_t)lround(value);
+}
+
+/**
+ * @brief Flight-like motion with vibration, noise and rare bus spikes
+ */
+static void sweep_synth_source(void *ctx, uint64_t sample_index, int16_t acc[3], int16_t gyr[3]) {
+    sweep_synth_t *synth = ctx;
+    double t = (double)sample_index / SYNTH_ODR_HZ;
+    double w1 = 2.0 * M_PI * 0.7, w2 = 2.0 * M_PI * 2.3, w3 = 2.0 * M_PI * 0.5, w4 = 2.0 * M_PI * 3.1;
+    double wv = 2.0 * M_PI * 180.0;
+
+    double roll = 0.25 * sin(w1 * t) + 0.10 * sin(w2 * t + 1.0);
+    double pitch = 0.20 * sin(w3 * t + 0.5) + 0.08 * sin(w4 * t);
+    double rates[3] = {
+        0.25 * w1 * cos(w1 * t) + 0.10 * w2 * cos(w2 * t + 1.0),
+        0.20 * w3 * cos(w3 * t + 0.5) + 0.08 * w4 * cos(w4 * t),
+        0.3 * sin(2.0 * M_PI * 0.2 * t),
+    };
+    double force[3] = {
+        -sin(pitch),
+        sin(roll) * cos(pitch),
+        cos(roll) * cos(pitch),
+    };
+    double vibration = sin(wv * t);
+
+    for (int axis = 0; axis < 3; axis++) {
+        double a = force[axis] + 0.08 * vibration * (axis == 2 ? 1.0 : 0.5) + 0.01 * sweep_rand_normal(&synth->rand_state);
+        double g = rates[axis] + 0.05 * vibration + 0.005 * sweep_rand_normal(&synth->rand_state);
+        acc[axis] = sweep_saturate(a * SYNTH_ACC_LSB_PER_G);
+        gyr[axis] = sweep_saturate(g * SYNTH_GYR_LSB_PER_RAD_S);
+    }
+
+    // Single-sample bus glitch on one axis
+    if (sweep_rand(&synth->rand_state) % SYNTH_SPIKE_PERIOD == 0) {
+        uint64_t r = sweep_rand(&synth->rand_state);
+        int16_t *target = (r & 1) ? &gyr[(r >> 1) % 3] : &acc[(r >> 1) % 3];
+        *target = sweep_saturate(*target + (double)((r & 2) ? 12000 : -12000));
+    }
+}
+
+/**
+ * @brief Logger: append every FIFO burst unchanged
+ */
+static void sweep_synth_write(sweep_synth_t *synth, const bmi270_fifo_batch_t *batch) {
+    if (batch->fifo_length > 0 &&
+        fwrite(batch->raw, 1, batch->fifo_length, synth->file) != batch->fifo_length) {
+        synth->write_error = true;
+    }
+}
+
+static void sweep_synth_flush(sweep_synth_t *synth) {
+    for (uint8_t i = 0; i < synth->pending_count; i++) {
+        sweep_synth_write(synth, synth->pending[i]);
+        bmi270_batch_release(synth->pending[i]);
+    }
+    synth->pending_count = 0;
+}
+
+/*
+ * Writes lag the drains like a logger task would: lent batches are retained
+ * and written SYNTH_WRITE_BEHIND drains later. When the pool runs dry the
+ * batch is the stream's internal one and cannot be held, so everything
+ * pending is written first and the batch straight after, keeping file order.
+ */
+static void sweep_synth_batch_cb(const bmi270_fifo_batch_t *batch, void *user_ctx) {
+    sweep_synth_t *synth = user_ctx;
+    const bmi270_fifo_batch_t *held = bmi270_batch_retain(batch);
+    if (held == NULL) {
+        sweep_synth_flush(synth);
+        sweep_synth_write(synth, batch);
+        return;
+    }
+    if (synth->pending_count == SYNTH_WRITE_BEHIND) {
+        sweep_synth_write(synth, synth->pending[0]);
+        bmi270_batch_release(synth->pending[0]);
+        memmove(&synth->pending[0], &synth->pending[1],
+                (SYNTH_WRITE_BEHIND - 1) * sizeof(synth->pending[0]));
+        synth->pending_count--;
+    }
+    synth->pending[synth->pending_count++] = held;
+}
+
+int sweep_pipeline_record_synthetic(const char *path, uint32_t seconds, uint64_t seed) {
+    sweep_synth_t *synth = calloc(1, sizeof(*synth));
+    if (synth == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return -1;
+    }
+    synth->rand_state = seed;
+    synth->file = fopen(path, "wb");
+    if (synth->file == NULL) {
+        perror(path);
+        free(synth);
+        return -1;
+    }
+
+    host_port_reset();
+    bmi270_sim_config_t sim_config = { .source = sweep_synth_source, .source_ctx = synth };
+    bmi270_sim_init(&synth->sim, &sim_config);
+    bmi270_sim_attach(&synth->sim);
+
+    esp_err_t ret = bmi270_batch_pool_init(&synth->pool, synth->pool_buffers, SYNTH_POOL_BUFFERS);
+    if (ret == ESP_OK) {
+        ret = bmi270_spi_init(&synth->dev, &s_bus_config);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_init(&synth->dev);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_range(&synth->dev, BMI270_ACC_RANGE_4G);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_range(&synth->dev, BMI270_GYR_RANGE_2000DPS);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_accel_config(&synth->dev, BMI270_ACC_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK) {
+        ret = bmi270_set_gyro_config(&synth->dev, BMI270_GYR_ODR_1600HZ, BMI270_FILTER_PERFORMANCE);
+    }
+    if (ret == ESP_OK) {
+        bmi270_fifo_stream_config_t stream_config = {
+            .watermark = SYNTH_WATERMARK,
+            .int_pin = BMI270_INT_PIN_1,
+            .callback = sweep_synth_batch_cb,
+            .user_ctx = synth,
+            .pool = &synth->pool,
+        };
+        ret = bmi270_fifo_stream_init(&synth->stream, &synth->dev, &stream_config);
+    }
+
+    if (ret == ESP_OK) {
+        uint64_t period_ns = bmi270_sim_sample_period_ns(&synth->sim);
+        uint64_t end_ns = host_clock_now_ns() + (uint64_t)seconds * 1000000000ULL;
+        while (host_clock_now_ns() < end_ns && !synth->write_error) {
+            host_clock_advance_ns(period_ns);
+            bmi270_sim_update(&synth->sim);
+            if (bmi270_sim_watermark_reached(&synth->sim)) {
+                bmi270_fifo_stream_notify_from_isr(&synth->stream);
+                bmi270_fifo_stream_drain(&synth->stream);
+            }
+        }
+    } else {
+        fprintf(stderr, "recorder bring-up failed (%s)\n", esp_err_to_name(ret));
+    }
+    sweep_synth_flush(synth);
+
+    host_bus_reset();
+    int result = (ret == ESP_OK && !synth->write_error) ? 0 : -1;
+    if (ret == ESP_OK) {
+        bmi270_batch_pool_stats_t pool_stats;
+        bmi270_batch_pool_get_stats(&synth->pool, &pool_stats);
+        printf("pool: %u lent, %u exhausted, peak %u/%u in use\n",
+               (unsigned)pool_stats.lent, (unsigned)pool_stats.exhausted,
+               (unsigned)pool_stats.peak_in_use, (unsigned)SYNTH_POOL_BUFFERS);
+        if (pool_stats.in_use != 0) {
+            fprintf(stderr, "pool: %u buffers still referenced after the last write\n",
+                    (unsigned)pool_stats.in_use);
+            result = -1;
+        }
+    }
+    if (fclose(synth->file) != 0 || synth->write_error) {
+        fprintf(stderr, "%s: write failed\n", path);
+        result = -1;
+    }
+    free(synth);
+    return result;
+}
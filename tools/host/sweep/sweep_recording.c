@@ -0,0 +1,228 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file sweep_recording.c
+ * @brief Recorded FIFO stream (memory-mapped) and reference attitude
+ */
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bmi270_data.h"
+#include "sweep_recording.h"
+
+#define SWEEP_PARSER_WINDOW     0xFFFFU     // bmi270_fifo_parser_t length is 16 bit
+#define SWEEP_SMOOTH_HZ         50          // Boxcar width of the noise reference (20 ms)
+
+/* ====== Cursor ====== */
+
+static void sweep_cursor_window(sweep_cursor_t *cursor) {
+    size_t remaining = cursor->rec->length - cursor->base;
+    uint16_t window = remaining > SWEEP_PARSER_WINDOW ? SWEEP_PARSER_WINDOW : (uint16_t)remaining;
+    bmi270_fifo_parser_init(&cursor->parser, cursor->rec->data + cursor->base, window);
+}
+
+void sweep_cursor_init(sweep_cursor_t *cursor, const sweep_recording_t *rec) {
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->rec = rec;
+    sweep_cursor_window(cursor);
+}
+
+/**
+ * @brief Next frame of any type; moves the window when a frame crosses its end
+ */
+static bool sweep_cursor_frame(sweep_cursor_t *cursor, bmi270_fifo_frame_t *frame) {
+    while (!cursor->end) {
+        esp_err_t ret = bmi270_fifo_parser_next(&cursor->parser, frame);
+        if (ret == ESP_OK) {
+            return true;
+        }
+        size_t consumed = cursor->parser.offset;
+        bool window_end = (cursor->base + cursor->parser.length < cursor->rec->length);
+        if (ret == ESP_ERR_NOT_FOUND && window_end && consumed > 0) {
+            // Frame crosses the window end
+            cursor->base += consumed;
+            sweep_cursor_window(cursor);
+        } else if (cursor->base + consumed + 1 < cursor->rec->length) {
+            // Unknown header, over-read marker or padding between drains: resynchronize one byte later
+            cursor->base += consumed + 1;
+            sweep_cursor_window(cursor);
+        } else {
+            cursor->end = true;
+        }
+    }
+    return false;
+}
+
+bool sweep_cursor_next(sweep_cursor_t *cursor, bmi270_raw_data_t *acc, bmi270_raw_data_t *gyr) {
+    bmi270_fifo_frame_t frame;
+
+    while (sweep_cursor_frame(cursor, &frame)) {
+        if (frame.type == BMI270_FIFO_FRAME_SENSOR && frame.has_acc && frame.has_gyr) {
+            *acc = frame.acc;
+            *gyr = frame.gyr;
+            cursor->index++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ====== Estimator ====== */
+
+void sweep_attitude_update(sweep_attitude_t *att, const float gyr[3], const float acc[3], float dt,
+                           float gain) {
+    float acc_roll = atan2f(acc[1], acc[2]);
+    float acc_pitch = atan2f(-acc[0], sqrtf(acc[1] * acc[1] + acc[2] * acc[2]));
+
+    if (!att->valid) {
+        att->roll = acc_roll;
+        att->pitch = acc_pitch;
+        att->valid = true;
+        return;
+    }
+
+    // Small-angle Euler rates; good enough for a relative comparison
+    att->roll += gyr[0] * dt;
+    att->pitch += gyr[1] * dt;
+
+    float k = gain * dt;
+    if (k > 1.0f) {
+        k = 1.0f;
+    }
+    att->roll += k * (acc_roll - att->roll);
+    att->pitch += k * (acc_pitch - att->pitch);
+}
+
+/* ====== Recording ====== */
+
+int sweep_recording_open(sweep_recording_t *rec, const char *path, uint32_t odr_hz,
+                         uint8_t acc_range, uint8_t gyr_range, float ref_gain) {
+    memset(rec, 0, sizeof(*rec));
+    rec->odr_hz = odr_hz;
+    rec->acc_range = acc_range;
+    rec->gyr_range = gyr_range;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "%s: empty or unreadable\n", path);
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    rec->data = map;
+    rec->length = (size_t)st.st_size;
+
+    // First pass: count samples and skip frames
+    sweep_cursor_t cursor;
+    bmi270_fifo_frame_t frame;
+    sweep_cursor_init(&cursor, rec);
+    while (sweep_cursor_frame(&cursor, &frame)) {
+        if (frame.type == BMI270_FIFO_FRAME_SENSOR && frame.has_acc && frame.has_gyr) {
+            rec->sample_count++;
+        } else if (frame.type == BMI270_FIFO_FRAME_SKIP) {
+            rec->skip_frames += frame.value;
+        }
+    }
+    if (rec->sample_count == 0) {
+        fprintf(stderr, "%s: no ACC+GYR frames (header mode FIFO stream expected)\n", path);
+        sweep_recording_close(rec);
+        return -1;
+    }
+
+    // Second pass: reference attitude and smoothed gyro, converted with the driver
+    uint32_t n = rec->sample_count;
+    rec->ref_roll = malloc(n * sizeof(float));
+    rec->ref_pitch = malloc(n * sizeof(float));
+    rec->ref_gyr = malloc(3 * (size_t)n * sizeof(float));
+    double *prefix = malloc(3 * ((size_t)n + 1) * sizeof(double));
+    if (rec->ref_roll == NULL || rec->ref_pitch == NULL || rec->ref_gyr == NULL || prefix == NULL) {
+        fprintf(stderr, "out of memory\n");
+        free(prefix);
+        sweep_recording_close(rec);
+        return -1;
+    }
+    bmi270_dev_t dev = { .acc_range = acc_range, .gyr_range = gyr_range };
+    sweep_attitude_t att = {0};
+    bmi270_raw_data_t acc_raw;
+    bmi270_raw_data_t gyr_raw;
+    float dt = 1.0f / (float)odr_hz;
+
+    prefix[0] = prefix[1] = prefix[2] = 0.0;
+    sweep_cursor_init(&cursor, rec);
+    for (uint32_t i = 0; i < n; i++) {
+        sweep_cursor_next(&cursor, &acc_raw, &gyr_raw);
+        bmi270_accel_t acc;
+        bmi270_gyro_t gyr;
+        bmi270_convert_accel_raw(&dev, &acc_raw, &acc);
+        bmi270_convert_gyro_raw(&dev, &gyr_raw, &gyr);
+        float a[3] = { acc.x, acc.y, acc.z };
+        float g[3] = { gyr.x, gyr.y, gyr.z };
+        sweep_attitude_update(&att, g, a, dt, ref_gain);
+        rec->ref_roll[i] = att.roll;
+        rec->ref_pitch[i] = att.pitch;
+        for (int axis = 0; axis < 3; axis++) {
+            prefix[3 * (i + 1) + axis] = prefix[3 * i + axis] + g[axis];
+        }
+    }
+
+    // Centred boxcar (shortened at both ends)
+    uint32_t half = odr_hz / SWEEP_SMOOTH_HZ / 2;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t lo = i > half ? i - half : 0;
+        uint32_t hi = i + half + 1 < n ? i + half + 1 : n;
+        for (int axis = 0; axis < 3; axis++) {
+            rec->ref_gyr[3 * i + axis] = (float)((prefix[3 * hi + axis] - prefix[3 * lo + axis]) / (hi - lo));
+        }
+    }
+    free(prefix);
+    return 0;
+}
+
+void sweep_recording_close(sweep_recording_t *rec) {
+    if (rec->data != NULL) {
+        munmap((void *)rec->data, rec->length);
+    }
+    free(rec->ref_roll);
+    free(rec->ref_pitch);
+    free(rec->ref_gyr);
+    memset(rec, 0, sizeof(*rec));
+}
@@ -0,0 +1,139 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file sweep_recording.h
+ * @brief Recorded FIFO stream (memory-mapped) and reference attitude
+ *
+ * A recording is the raw FIFO_DATA byte stream of a flight, i.e. the
+ * concatenation of every bmi270_fifo_read() in header mode with
+ * ACC+GYR frames at a constant ODR. It is mapped read-only once and
+ * shared by all sweep workers; each worker walks it with its own cursor
+ * using the driver's frame parser.
+ *
+ * Recorded logs have no ground truth, so estimator error is measured
+ * against a reference attitude: the complementary filter run on every
+ * recorded sample (full rate, no decimation, no delivery latency).
+ */
+
+#ifndef SWEEP_RECORDING_H
+#define SWEEP_RECORDING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bmi270_fifo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Mapped recording
+ */
+typedef struct {
+    const uint8_t *data;        ///< FIFO byte stream (read-only mapping)
+    size_t length;              ///< Length [bytes]
+    uint32_t odr_hz;            ///< Sample rate of the recording [Hz]
+    uint8_t acc_range;          ///< bmi270_acc_range_t used while recording
+    uint8_t gyr_range;          ///< bmi270_gyr_range_t used while recording
+    uint32_t sample_count;      ///< ACC+GYR frames
+    uint32_t skip_frames;       ///< Skip frames (frames the recorder lost)
+    float *ref_roll;            ///< Reference roll per sample [rad]
+    float *ref_pitch;           ///< Reference pitch per sample [rad]
+    float *ref_gyr;             ///< Gyro smoothed by a centred 20 ms boxcar, x/y/z per sample [rad/s]
+} sweep_recording_t;
+
+/**
+ * @brief Sequential reader over a recording
+ */
+typedef struct {
+    const sweep_recording_t *rec;
+    size_t base;                ///< Offset of the parser window
+    bmi270_fifo_parser_t parser;    ///< Parser over [base, base + 65535)
+    uint64_t index;             ///< Index of the next sample
+    bool end;                   ///< No sample left
+} sweep_cursor_t;
+
+/**
+ * @brief Complementary attitude filter (roll/pitch)
+ *
+ * Integrates the gyro and pulls towards the accelerometer tilt with
+ * gain [1/s]: the estimator whose gain is swept.
+ */
+typedef struct {
+    float roll;                 ///< [rad]
+    float pitch;                ///< [rad]
+    bool valid;                 ///< Initialized from the first accelerometer sample
+} sweep_attitude_t;
+
+/**
+ * @brief Map a recording, count its samples and compute the references
+ *
+ * @param rec Recording to fill
+ * @param path File path
+ * @param odr_hz Sample rate of the recording [Hz]
+ * @param acc_range Accelerometer range of the recording
+ * @param gyr_range Gyroscope range of the recording
+ * @param ref_gain Complementary filter gain of the reference [1/s]
+ * @return 0 on success, -1 on error (message printed)
+ */
+int sweep_recording_open(sweep_recording_t *rec, const char *path, uint32_t odr_hz,
+                         uint8_t acc_range, uint8_t gyr_range, float ref_gain);
+
+/**
+ * @brief Unmap and free
+ */
+void sweep_recording_close(sweep_recording_t *rec);
+
+/**
+ * @brief Start reading at the first sample
+ */
+void sweep_cursor_init(sweep_cursor_t *cursor, const sweep_recording_t *rec);
+
+/**
+ * @brief Next ACC+GYR sample (repeats the last one after the end)
+ *
+ * @return true if a new sample was read
+ */
+bool sweep_cursor_next(sweep_cursor_t *cursor, bmi270_raw_data_t *acc, bmi270_raw_data_t *gyr);
+
+/**
+ * @brief One estimator step
+ *
+ * @param att Attitude state
+ * @param gyr Angular rate [rad/s]
+ * @param acc Specific force [g]
+ * @param dt Time step [s]
+ * @param gain Accelerometer correction gain [1/s]
+ */
+void sweep_attitude_update(sweep_attitude_t *att, const float gyr[3], const float acc[3], float dt,
+                           float gain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SWEEP_RECORDING_H
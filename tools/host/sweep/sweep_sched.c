@@ -0,0 +1,185 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file sweep_sched.c
+ * @brief Work-stealing job scheduler for the parameter sweep
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sweep_sched.h"
+
+/**
+ * @brief Job deque of one worker: [head, tail) of jobs
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    size_t *jobs;
+    size_t head;                ///< Next job for thieves
+    size_t tail;                ///< One past the next job for the owner
+} sweep_deque_t;
+
+typedef struct sweep_sched sweep_sched_t;
+
+typedef struct {
+    sweep_sched_t *sched;
+    unsigned index;
+    pthread_t thread;
+    uint64_t rand_state;
+    sweep_sched_worker_stats_t stats;
+} sweep_worker_t;
+
+struct sweep_sched {
+    sweep_deque_t *deques;
+    sweep_worker_t *workers;
+    unsigned worker_count;
+    sweep_job_fn_t fn;
+    void *ctx;
+};
+
+static int sweep_deque_pop_back(sweep_deque_t *deque, size_t *job) {
+    int found = 0;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        *job = deque->jobs[--deque->tail];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static int sweep_deque_pop_front(sweep_deque_t *deque, size_t *job) {
+    int found = 0;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        *job = deque->jobs[deque->head++];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+/**
+ * @brief Steal one job, starting at a random victim and trying every other worker once
+ */
+static int sweep_steal(sweep_worker_t *worker, size_t *job) {
+    sweep_sched_t *sched = worker->sched;
+
+    // xorshift64: victim order only needs to differ between workers
+    worker->rand_state ^= worker->rand_state << 13;
+    worker->rand_state ^= worker->rand_state >> 7;
+    worker->rand_state ^= worker->rand_state << 17;
+    unsigned start = (unsigned)(worker->rand_state % sched->worker_count);
+
+    for (unsigned i = 0; i < sched->worker_count; i++) {
+        unsigned victim = (start + i) % sched->worker_count;
+        if (victim != worker->index && sweep_deque_pop_front(&sched->deques[victim], job)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *sweep_worker_main(void *arg) {
+    sweep_worker_t *worker = arg;
+    sweep_sched_t *sched = worker->sched;
+    size_t job;
+
+    for (;;) {
+        if (sweep_deque_pop_back(&sched->deques[worker->index], &job)) {
+            // Own work
+        } else if (sweep_steal(worker, &job)) {
+            worker->stats.steals++;
+        } else {
+            break;  // No job is ever added, so every deque is drained
+        }
+        sched->fn(sched->ctx, job, worker->index);
+        worker->stats.jobs++;
+    }
+    return NULL;
+}
+
+int sweep_sched_run(size_t count, unsigned workers, sweep_job_fn_t fn, void *ctx,
+                    sweep_sched_worker_stats_t *stats) {
+    sweep_sched_t sched = {
+        .worker_count = workers > 0 ? workers : 1,
+        .fn = fn,
+        .ctx = ctx,
+    };
+    int result = 0;
+
+    sched.deques = calloc(sched.worker_count, sizeof(sweep_deque_t));
+    sched.workers = calloc(sched.worker_count, sizeof(sweep_worker_t));
+    if (sched.deques == NULL || sched.workers == NULL) {
+        free(sched.deques);
+        free(sched.workers);
+        return -1;
+    }
+
+    // Deal jobs round-robin so neighbouring grid points (similar cost) are spread out
+    for (unsigned w = 0; w < sched.worker_count; w++) {
+        sweep_deque_t *deque = &sched.deques[w];
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->jobs = malloc((count / sched.worker_count + 1) * sizeof(size_t));
+        if (deque->jobs == NULL) {
+            result = -1;
+        }
+    }
+    for (size_t job = 0; result == 0 && job < count; job++) {
+        sweep_deque_t *deque = &sched.deques[job % sched.worker_count];
+        deque->jobs[deque->tail++] = job;
+    }
+
+    unsigned started = 0;
+    for (unsigned w = 0; result == 0 && w < sched.worker_count; w++) {
+        sweep_worker_t *worker = &sched.workers[w];
+        worker->sched = &sched;
+        worker->index = w;
+        worker->rand_state = 0x9E3779B97F4A7C15ULL * (w + 1);
+        if (pthread_create(&worker->thread, NULL, sweep_worker_main, worker) != 0) {
+            break;  // Started workers steal the remaining deques
+        }
+        started++;
+    }
+    if (started == 0) {
+        result = -1;
+    }
+    for (unsigned w = 0; w < started; w++) {
+        pthread_join(sched.workers[w].thread, NULL);
+        if (stats != NULL) {
+            stats[w] = sched.workers[w].stats;
+        }
+    }
+
+    for (unsigned w = 0; w < sched.worker_count; w++) {
+        pthread_mutex_destroy(&sched.deques[w].lock);
+        free(sched.deques[w].jobs);
+    }
+    free(sched.deques);
+    free(sched.workers);
+    return result;
+}
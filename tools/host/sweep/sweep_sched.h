@@ -0,0 +1,83 @@
+/*
+ * SPDX-License-Identifier: MIT
+ *
+ * Copyright (c) 2025 Kouhei Ito
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file sweep_sched.h
+ * @brief Work-stealing job scheduler for the parameter sweep
+ *
+ * Jobs are indices 0..count-1. They are dealt round-robin into one deque
+ * per worker; a worker pops its own deque from the back and, when it is
+ * empty, steals from the front of another worker's deque. Jobs do not
+ * spawn jobs, so a worker stops once every deque is empty.
+ *
+ * Each deque has its own mutex: a job replays a whole recording
+ * (milliseconds to seconds), so contention on the deques is negligible.
+ */
+
+#ifndef SWEEP_SCHED_H
+#define SWEEP_SCHED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Job function, called on a worker thread
+ *
+ * @param ctx User context passed to sweep_sched_run()
+ * @param job Job index
+ * @param worker Index of the worker thread running the job
+ */
+typedef void (*sweep_job_fn_t)(void *ctx, size_t job, unsigned worker);
+
+/**
+ * @brief Per-worker counters
+ */
+typedef struct {
+    uint64_t jobs;              ///< Jobs executed
+    uint64_t steals;            ///< Jobs taken from another worker
+} sweep_sched_worker_stats_t;
+
+/**
+ * @brief Run count jobs on workers threads and wait for completion
+ *
+ * @param count Number of jobs
+ * @param workers Number of worker threads (>= 1)
+ * @param fn Job function
+ * @param ctx User context
+ * @param stats Per-worker counters (array of workers entries, may be NULL)
+ * @return 0 on success, -1 if no thread could be created
+ */
+int sweep_sched_run(size_t count, unsigned workers, sweep_job_fn_t fn, void *ctx,
+                    sweep_sched_worker_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SWEEP_SCHED_H